@@ -0,0 +1,462 @@
+// Engine benchmark: synthetic workloads of N processes over T ticks, run
+// with each algorithm and RAM size. Every repetition runs in a child process
+// of its own, so its peak RSS and allocations are its alone. Results go out
+// as JSON, one configuration per line, to diff between builds.
+#include <limits.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include <sys/resource.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "../include/globals.h"
+#include "../include/metrics_utils.h"
+#include "../include/process_table.h"
+#include "../include/scheduler.h"
+#include "../include/sim_context.h"
+
+#define MAX_LIST 16
+#define MAX_REPS 30
+#define BENCH_PAGES 64           // most pages a process has
+#define BENCH_LOAD 0.9           // share of the CPU time the bursts ask for
+
+// ---------------------------------------------------------------------------
+// Allocation counting: the bench is linked with -Wl,--wrap=malloc (and
+// calloc, realloc), so every allocation of the simulator comes through here
+// ---------------------------------------------------------------------------
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+
+static long long allocations;
+static long long allocated_bytes;
+
+void *__wrap_malloc(size_t size) {
+    allocations++;
+    allocated_bytes += (long long)size;
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t count, size_t size) {
+    allocations++;
+    allocated_bytes += (long long)(count * size);
+    return __real_calloc(count, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size) {
+    allocations++;
+    allocated_bytes += (long long)size;
+    return __real_realloc(ptr, size);
+}
+
+// ---------------------------------------------------------------------------
+// Options
+// ---------------------------------------------------------------------------
+
+typedef struct {
+    long long values[MAX_LIST];
+    int count;
+} ValueList;
+
+typedef struct {
+    ValueList processes;
+    ValueList ticks;
+    ValueList frames;         // 0 = paging off
+    bool algorithms[NUM_ALGORITHMS];
+    int policy;
+    int cpus;
+    int reps;
+    unsigned int seed;
+    const char *out_path;     // NULL writes to stdout
+} BenchOptions;
+
+static void print_usage(FILE *out, const char *prog) {
+    fprintf(out,
+        "Usage: %s [options]\n"
+        "\n"
+        "Runs synthetic workloads with every algorithm and RAM size and writes\n"
+        "ns per simulated tick, ns per scheduling decision, peak RSS and\n"
+        "allocations as JSON, with the mean and 95%% confidence interval of the\n"
+        "repetitions.\n"
+        "\n"
+        "Options (LIST is comma separated):\n"
+        "  --processes LIST  process counts, 1-%d (default: 10,1000,100000)\n"
+        "  --ticks LIST      simulation horizons, 1-%d (default: 100,10000,1000000)\n"
+        "  --frames LIST     RAM frames, 0 runs without paging (default: 0,256,16384)\n"
+        "  --full            processes 10 to 10^6 and ticks 10^2 to 10^8\n"
+        "  --algo LIST       algorithms (default: fifo,sjf,edf,rr,cfs)\n"
+        "  --memory POLICY   replacement policy when paging (default: lru)\n"
+        "  --cpus N          CPUs for RR and CFS, 1-%d (default: 1)\n"
+        "  --reps N          repetitions of each configuration, 2-%d (default: 5)\n"
+        "  --seed N          workload seed (default: 1)\n"
+        "  --out FILE        write the JSON to FILE instead of stdout\n"
+        "  --help            show this message\n",
+        prog, INT_MAX, INT_MAX, MAX_CPUS, MAX_REPS);
+}
+
+static bool parse_long_arg(const char *text, long long min_val, long long max_val, long long *out) {
+    char *endptr;
+    long long value = strtoll(text, &endptr, 10);
+    if (endptr == text || *endptr != '\0' || value < min_val || value > max_val) {
+        return false;
+    }
+    *out = value;
+    return true;
+}
+
+static bool parse_list(const char *text, long long min_val, long long max_val, ValueList *list) {
+    char buffer[256];
+    if (strlen(text) >= sizeof(buffer)) return false;
+    strcpy(buffer, text);
+
+    list->count = 0;
+    for (char *item = strtok(buffer, ","); item != NULL; item = strtok(NULL, ",")) {
+        if (list->count == MAX_LIST) return false;
+        if (!parse_long_arg(item, min_val, max_val, &list->values[list->count])) return false;
+        list->count++;
+    }
+    return list->count > 0;
+}
+
+static bool parse_algorithms(const char *text, bool algorithms[NUM_ALGORITHMS]) {
+    char buffer[128];
+    if (strlen(text) >= sizeof(buffer)) return false;
+    strcpy(buffer, text);
+
+    for (int a = 0; a < NUM_ALGORITHMS; a++) algorithms[a] = false;
+    int found = 0;
+    for (char *item = strtok(buffer, ","); item != NULL; item = strtok(NULL, ",")) {
+        int a = 0;
+        while (a < NUM_ALGORITHMS && strcasecmp(item, algorithm_keys[a]) != 0) a++;
+        if (a == NUM_ALGORITHMS) return false;
+        algorithms[a] = true;
+        found++;
+    }
+    return found > 0;
+}
+
+// Returns the exit status when the bench should stop, -1 to go on
+static int parse_options(int argc, char **argv, BenchOptions *opts) {
+    parse_list("10,1000,100000", 1, INT_MAX, &opts->processes);
+    parse_list("100,10000,1000000", 1, INT_MAX, &opts->ticks);
+    parse_list("0,256,16384", 0, MAX_RAM_FRAMES, &opts->frames);
+    for (int a = 0; a < NUM_ALGORITHMS; a++) opts->algorithms[a] = true;
+    opts->policy = POLICY_LRU;
+    opts->cpus = 1;
+    opts->reps = 5;
+    opts->seed = 1;
+    opts->out_path = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        if (strcmp(arg, "--help") == 0) {
+            print_usage(stdout, argv[0]);
+            return 0;
+        }
+        if (strcmp(arg, "--full") == 0) {
+            parse_list("10,100,1000,10000,100000,1000000", 1, INT_MAX, &opts->processes);
+            parse_list("100,10000,1000000,100000000", 1, INT_MAX, &opts->ticks);
+            continue;
+        }
+        if (i + 1 >= argc) {
+            fprintf(stderr, "%s: %s needs a value\n", argv[0], arg);
+            return 2;
+        }
+
+        const char *value = argv[i + 1];
+        long long number = 0;
+        bool ok = true;
+        if (strcmp(arg, "--processes") == 0) {
+            ok = parse_list(value, 1, INT_MAX, &opts->processes);
+        } else if (strcmp(arg, "--ticks") == 0) {
+            ok = parse_list(value, 1, INT_MAX, &opts->ticks);
+        } else if (strcmp(arg, "--frames") == 0) {
+            ok = parse_list(value, 0, MAX_RAM_FRAMES, &opts->frames);
+        } else if (strcmp(arg, "--algo") == 0) {
+            ok = parse_algorithms(value, opts->algorithms);
+        } else if (strcmp(arg, "--memory") == 0) {
+            opts->policy = -1;
+            for (int m = 0; m < NUM_REPLACEMENT_POLICIES; m++) {
+                if (strcasecmp(value, replacement_policy_keys[m]) == 0) opts->policy = m;
+            }
+            ok = opts->policy >= 0;
+        } else if (strcmp(arg, "--cpus") == 0) {
+            ok = parse_long_arg(value, 1, MAX_CPUS, &number);
+            opts->cpus = (int)number;
+        } else if (strcmp(arg, "--reps") == 0) {
+            ok = parse_long_arg(value, 2, MAX_REPS, &number);
+            opts->reps = (int)number;
+        } else if (strcmp(arg, "--seed") == 0) {
+            ok = parse_long_arg(value, 1, UINT_MAX, &number);
+            opts->seed = (unsigned int)number;
+        } else if (strcmp(arg, "--out") == 0) {
+            opts->out_path = value;
+        } else {
+            fprintf(stderr, "%s: unknown option %s\n", argv[0], arg);
+            print_usage(stderr, argv[0]);
+            return 2;
+        }
+
+        if (!ok) {
+            fprintf(stderr, "%s: invalid value '%s' for %s\n", argv[0], value, arg);
+            return 2;
+        }
+        i++;
+    }
+    return -1;
+}
+
+// ---------------------------------------------------------------------------
+// Workloads
+// ---------------------------------------------------------------------------
+
+// xorshift32
+static unsigned int next_random(unsigned int *state) {
+    unsigned int x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+static int random_between(unsigned int *state, int low, int high) {
+    return low + (int)(next_random(state) % (unsigned int)(high - low + 1));
+}
+
+// n processes arriving over the whole horizon, whose bursts add up to
+// BENCH_LOAD of the CPU time, so every algorithm stays busy to the end
+static void generate_workload(SimContext *ctx, int n, int ticks, unsigned int seed) {
+    unsigned int state = seed;
+    long long work = (long long)(ticks * BENCH_LOAD) * ctx->num_cpus;
+    long long mean = work / n;
+    if (mean < 1) mean = 1;
+    if (mean > ticks) mean = ticks;
+
+    process_table_clear(ctx);
+    for (int i = 0; i < n; i++) {
+        Process *p = process_table_add(ctx);
+        p->id = i + 1;
+        p->arrival_time = random_between(&state, 0, ticks - 1);
+        p->execution_time = random_between(&state, 1, (int)(2 * mean - 1));
+        long long deadline = (long long)p->execution_time * random_between(&state, 2, 6);
+        p->deadline = deadline > INT_MAX ? INT_MAX : (int)deadline;
+        p->priority = random_between(&state, 1, 10);
+        p->num_pages = random_between(&state, 1, BENCH_PAGES);
+        p->access_pattern = random_between(&state, 0, NUM_ACCESS_PATTERNS - 1);
+        p->remaining_time = p->execution_time;
+    }
+    ctx->max_pages_per_process = BENCH_PAGES;
+    ctx->total_time = ticks;
+    process_table_alloc_timelines(ctx);
+}
+
+// ---------------------------------------------------------------------------
+// Measurements
+// ---------------------------------------------------------------------------
+
+typedef struct {
+    double run_ns;            // run_current_algorithm
+    double metrics_ns;        // compute_metrics_for_all and compute_summary_stats
+    long long decisions;      // CPU bursts dispatched
+    long long allocations;
+    long long allocated_bytes;
+    long peak_rss_kb;
+} Repetition;
+
+static long long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static Repetition run_repetition(SimContext *ctx) {
+    Repetition r;
+    allocations = 0;
+    allocated_bytes = 0;
+
+    long long start = now_ns();
+    reset_simulation(ctx);
+    run_current_algorithm(ctx);
+    long long ran = now_ns();
+    r.allocations = allocations;
+    r.allocated_bytes = allocated_bytes;
+
+    // The run computed them already; time them on their own
+    compute_metrics_for_all(ctx);
+    compute_summary_stats(ctx);
+    long long done = now_ns();
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    r.run_ns = (double)(ran - start);
+    r.metrics_ns = (double)(done - ran);
+    r.decisions = ctx->dispatches;
+    r.peak_rss_kb = usage.ru_maxrss;
+    return r;
+}
+
+// One repetition in a child process, which hands its numbers back through
+// a pipe. Returns false if the child failed (e.g. ran out of memory).
+static bool measure(SimContext *ctx, Repetition *r) {
+    int fds[2];
+    if (pipe(fds) != 0) return false;
+    fflush(NULL);
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        return false;
+    }
+    if (pid == 0) {
+        close(fds[0]);
+        Repetition result = run_repetition(ctx);
+        ssize_t written = write(fds[1], &result, sizeof(result));
+        _exit(written == (ssize_t)sizeof(result) ? 0 : 1);
+    }
+
+    close(fds[1]);
+    ssize_t got = read(fds[0], r, sizeof(*r));
+    close(fds[0]);
+    int status = 0;
+    waitpid(pid, &status, 0);
+    return got == (ssize_t)sizeof(*r) && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+typedef struct {
+    double mean;
+    double ci95;              // half-width of the 95% confidence interval
+    double min;
+    double max;
+} Stat;
+
+// Two-sided 95% critical values of Student's t, by degrees of freedom
+static const double t_critical[MAX_REPS] = {
+    0, 12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262,
+    2.228, 2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093,
+    2.086, 2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045
+};
+
+static Stat summarize(const double *x, int n) {
+    Stat s = {0, 0, x[0], x[0]};
+    for (int k = 0; k < n; k++) {
+        s.mean += x[k];
+        if (x[k] < s.min) s.min = x[k];
+        if (x[k] > s.max) s.max = x[k];
+    }
+    s.mean /= n;
+    double squares = 0;
+    for (int k = 0; k < n; k++) squares += (x[k] - s.mean) * (x[k] - s.mean);
+    if (n > 1) s.ci95 = t_critical[n - 1] * sqrt(squares / (n - 1)) / sqrt(n);
+    return s;
+}
+
+static void write_stat(FILE *out, const char *name, const double *x, int n) {
+    Stat s = summarize(x, n);
+    fprintf(out, ",\"%s\":{\"mean\":%.6g,\"ci95\":%.6g,\"min\":%.6g,\"max\":%.6g}", name, s.mean, s.ci95, s.min, s.max);
+}
+
+// ---------------------------------------------------------------------------
+// Driver
+// ---------------------------------------------------------------------------
+
+// Runs the repetitions of the configuration in ctx and writes its result
+static void bench_configuration(SimContext *ctx, const BenchOptions *opts, FILE *out, bool first) {
+    double ns_per_tick[MAX_REPS], ns_per_decision[MAX_REPS], run_ms[MAX_REPS], metrics_ms[MAX_REPS];
+    double rss[MAX_REPS], allocs[MAX_REPS], bytes[MAX_REPS];
+    long long decisions = 0;
+    int done = 0;
+
+    for (int k = 0; k < opts->reps; k++) {
+        Repetition r;
+        if (!measure(ctx, &r)) break;
+        ns_per_tick[done] = r.run_ns / ctx->total_time;
+        ns_per_decision[done] = r.decisions > 0 ? r.run_ns / r.decisions : 0;
+        run_ms[done] = r.run_ns / 1e6;
+        metrics_ms[done] = r.metrics_ns / 1e6;
+        rss[done] = (double)r.peak_rss_kb;
+        allocs[done] = (double)r.allocations;
+        bytes[done] = (double)r.allocated_bytes;
+        decisions = r.decisions;
+        done++;
+    }
+
+    const char *memory = ctx->memory_enabled ? replacement_policy_keys[ctx->replacement_policy] : "off";
+    int cpus = ctx->algorithm >= 3 ? ctx->num_cpus : 1;
+    fprintf(out, "%s\n{\"algorithm\":\"%s\",\"processes\":%d,\"ticks\":%d,\"memory\":\"%s\",\"frames\":%d,\"cpus\":%d",
+            first ? "" : ",", algorithm_keys[ctx->algorithm], ctx->num_processes, ctx->total_time,
+            memory, ctx->memory_enabled ? ctx->num_frames : 0, cpus);
+    if (done < opts->reps) {
+        fprintf(out, ",\"error\":\"repetition %d failed\"}", done + 1);
+        fprintf(stderr, "%s N=%d T=%d %s: repetition %d failed\n", algorithm_keys[ctx->algorithm],
+                ctx->num_processes, ctx->total_time, memory, done + 1);
+        return;
+    }
+    fprintf(out, ",\"reps\":%d,\"decisions\":%lld", done, decisions);
+    write_stat(out, "ns_per_tick", ns_per_tick, done);
+    write_stat(out, "ns_per_decision", ns_per_decision, done);
+    write_stat(out, "run_ms", run_ms, done);
+    write_stat(out, "metrics_ms", metrics_ms, done);
+    write_stat(out, "peak_rss_kb", rss, done);
+    write_stat(out, "allocations", allocs, done);
+    write_stat(out, "allocated_bytes", bytes, done);
+    fputc('}', out);
+
+    Stat tick = summarize(ns_per_tick, done);
+    fprintf(stderr, "%-4s N=%-8d T=%-10d %-5s %8d frames: %10.2f +- %.2f ns/tick\n",
+            algorithm_keys[ctx->algorithm], ctx->num_processes, ctx->total_time, memory,
+            ctx->memory_enabled ? ctx->num_frames : 0, tick.mean, tick.ci95);
+}
+
+int main(int argc, char **argv) {
+    BenchOptions opts;
+    int status = parse_options(argc, argv, &opts);
+    if (status >= 0) return status;
+
+    FILE *out = stdout;
+    if (opts.out_path != NULL) {
+        out = fopen(opts.out_path, "w");
+        if (out == NULL) {
+            fprintf(stderr, "%s: cannot write %s\n", argv[0], opts.out_path);
+            return 1;
+        }
+    }
+
+    SimContext *ctx = sim_context_create();
+    ctx->num_cpus = opts.cpus;
+    ctx->replacement_policy = opts.policy;
+    // Only the run itself: no log of page events for the OPT replay, and
+    // no timelines, as in batch mode
+    ctx->keep_page_events = false;
+    ctx->keep_timelines = false;
+
+    fprintf(out, "{\"benchmark\":\"engine\",\"reps\":%d,\"confidence\":0.95,\"seed\":%u,\"load\":%.2f,"
+                 "\"max_pages\":%d,\n\"results\":[", opts.reps, opts.seed, BENCH_LOAD, BENCH_PAGES);
+    bool first = true;
+    for (int a = 0; a < opts.processes.count; a++) {
+        for (int b = 0; b < opts.ticks.count; b++) {
+            generate_workload(ctx, (int)opts.processes.values[a], (int)opts.ticks.values[b], opts.seed);
+            for (int c = 0; c < opts.frames.count; c++) {
+                ctx->memory_enabled = opts.frames.values[c] > 0;
+                if (ctx->memory_enabled) ctx->num_frames = (int)opts.frames.values[c];
+                for (int algorithm = 0; algorithm < NUM_ALGORITHMS; algorithm++) {
+                    if (!opts.algorithms[algorithm]) continue;
+                    ctx->algorithm = algorithm;
+                    bench_configuration(ctx, &opts, out, first);
+                    first = false;
+                }
+            }
+        }
+    }
+    fprintf(out, "\n]}\n");
+
+    sim_context_destroy(ctx);
+    if (out != stdout) fclose(out);
+    return 0;
+}
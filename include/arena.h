@@ -0,0 +1,25 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+// Bump allocator made of a chain of blocks. Individual allocations are never
+// freed; the whole arena is reset or released at once.
+typedef struct ArenaBlock {
+    struct ArenaBlock *next;
+    size_t used;
+    size_t capacity;
+    // data follows the header
+} ArenaBlock;
+
+typedef struct Arena {
+    ArenaBlock *head;      // block currently being filled
+    size_t total_used;     // bytes handed out since the last reset
+} Arena;
+
+void arena_init(Arena *arena);
+void *arena_alloc(Arena *arena, size_t size);
+void arena_reset(Arena *arena);
+void arena_release(Arena *arena);
+
+#endif
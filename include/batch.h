@@ -0,0 +1,8 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+// Headless mode: run one workload with the selected algorithm and print
+// metrics to stdout without initializing ncurses. Returns the exit status.
+int run_batch(int argc, char **argv);
+
+#endif
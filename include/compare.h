@@ -0,0 +1,11 @@
+#ifndef COMPARE_H
+#define COMPARE_H
+
+#include "globals.h"
+
+// Run every algorithm on its own copy of the workload in base, in parallel,
+// and store the summary of algorithm i in results[i].
+// Returns the number of worker threads used.
+int compare_algorithms(const SimContext *base, SummaryStats results[NUM_ALGORITHMS]);
+
+#endif
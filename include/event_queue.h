@@ -0,0 +1,40 @@
+#ifndef EVENT_QUEUE_H
+#define EVENT_QUEUE_H
+
+#include <stdbool.h>
+
+// Simulation events handled by the discrete-event engine
+typedef enum {
+    EV_ARRIVAL = 0,         // process enters the system
+    EV_BURST_END = 1,       // running process completes or its quantum expires
+    EV_OVERHEAD_END = 2,    // context switch finished, CPU can be dispatched again
+    EV_DEADLINE = 3,        // absolute deadline reached (EDF state change)
+    EV_VRUNTIME_CROSS = 4,  // running process stops having the lowest vruntime (CFS)
+    EV_PAGE_FAULT = 5,      // running process blocked on a page fault the tick before
+    EV_PAGE_READ = 6        // swap device finished reading the page of a blocked process
+} EventType;
+
+typedef struct {
+    int time;          // simulated tick the event fires at
+    EventType type;
+    int process;       // process index
+    int generation;    // burst generation, used to discard stale events
+    unsigned seq;      // insertion order, breaks ties between events on the same tick
+} Event;
+
+// Binary min-heap of events ordered by (time, seq)
+typedef struct {
+    Event *heap;
+    int size;
+    int capacity;
+    unsigned next_seq;
+} EventQueue;
+
+void event_queue_init(EventQueue *queue, int capacity);
+void event_queue_free(EventQueue *queue);
+void event_queue_push(EventQueue *queue, int time, EventType type, int process, int generation);
+bool event_queue_empty(const EventQueue *queue);
+int event_queue_next_time(const EventQueue *queue);
+bool event_queue_pop_at(EventQueue *queue, int time, Event *out);
+
+#endif
@@ -3,13 +3,31 @@
 
 #include <ncurses.h>
 #include <stdbool.h>
+#include "arena.h"
+#include "vruntime_tree.h"
 
-#define MAX_PROCESSES 6
 #define CELL_WIDTH 3
-#define MAX_PAGES_PER_PROCESS 10
-#define TOTAL_RAM_FRAMES 50
-#define FRAME_SIZE_KB 4
-#define TOTAL_RAM_KB 200
+#define DEFAULT_MAX_PAGES_PER_PROCESS 10
+#define MAX_PAGES_LIMIT (1 << 20)      // largest max_pages_per_process
+#define DEFAULT_RAM_FRAMES 50
+#define DEFAULT_FRAME_SIZE_KB 4
+#define MAX_RAM_FRAMES (1 << 26)       // 256 GB of 4 KB frames
+#define MAX_FRAME_SIZE_KB (1 << 20)
+#define NUM_ALGORITHMS 5
+#define NUM_REPLACEMENT_POLICIES 8
+#define MAX_CPUS 256
+#define MAX_FAULT_TIME 1000000
+#define SWAP_TRACK_PAGES 64            // page slots per swap track
+#define MAX_READAHEAD_PAGES 4096
+#define MAX_TLB_ENTRIES 4096           // per CPU
+#define DEFAULT_TLB_WAYS 4
+#define TLB_MISS_CYCLES 30             // page walk stall of a TLB miss
+#define DEFAULT_WS_WINDOW 20           // references a working set looks back
+#define MAX_WS_WINDOW 1000000
+#define DEFAULT_PFF_LOW 5              // references between faults, see FrameAllocation
+#define DEFAULT_PFF_HIGH 25
+#define DEFAULT_TRACE_EVENTS (1 << 18) // events a trace ring keeps
+#define MAX_TRACE_EVENTS (1 << 26)
 
 // Colors
 #define GRAY 1
@@ -27,29 +45,200 @@ typedef enum {
     WAITING = 3,
     COMPLETED = 4,
     DEADLINE_MISSED = 5,
-    PAGE_FAULT = 6
+    PAGE_FAULT = 6,
+    SUSPENDED = 7        // swapped out by the load controller
 } ProcessState;
 
-// Memory replacement policies
+// Memory replacement policies, see replacement.h
 typedef enum {
     POLICY_FIFO = 0,
-    POLICY_LRU = 1
+    POLICY_LRU = 1,
+    POLICY_CLOCK = 2,
+    POLICY_WSCLOCK = 3,
+    POLICY_AGING = 4,
+    POLICY_LFU = 5,
+    POLICY_ARC = 6,
+    POLICY_OPT = 7
 } ReplacementPolicy;
 
+// Page a process references on each executed tick, see memory.h
+typedef enum {
+    ACCESS_SEQUENTIAL = 0,
+    ACCESS_STRIDED = 1,
+    ACCESS_RANDOM = 2,
+    ACCESS_ZIPF = 3,
+    ACCESS_PHASES = 4
+} AccessPattern;
+
+#define NUM_ACCESS_PATTERNS 5
+
+// Order in which the swap device serves pending page reads, see swap_device.h
+typedef enum {
+    DISK_FCFS = 0,
+    DISK_SSTF = 1,
+    DISK_SCAN = 2,
+    DISK_CLOOK = 3
+} DiskSchedule;
+
+#define NUM_DISK_SCHEDULES 4
+
+// How the RAM is shared out, see memory.h. Global lets any process take any
+// frame; the others bound each resident set, by the pages referenced in the
+// last ws_window references of the process, or by an allocation that grows
+// when its faults come less than pff_low references apart and shrinks when
+// they come more than pff_high apart (page fault frequency).
+typedef enum {
+    ALLOCATION_GLOBAL = 0,
+    ALLOCATION_WORKING_SET = 1,
+    ALLOCATION_PFF = 2
+} FrameAllocation;
+
+#define NUM_FRAME_ALLOCATIONS 3
+
+// Doubly-linked list of frames threaded through the frames themselves
+typedef struct {
+    int prev;            // -1 at the head
+    int next;            // -1 at the tail
+} FrameLink;
+
+typedef struct {
+    int head;            // oldest frame, -1 if empty
+    int tail;
+    int size;
+} FrameList;
+
 // Frame structure (RAM)
 typedef struct {
-    int process_id;      // -1 if free
+    int process_index;   // owner in processes[], -1 if free
     int page_number;     // which page of the process
     int load_time;       // for FIFO
     int last_access;     // for LRU
+    int next_free;       // next frame on the free stack
+    FrameLink link;      // position in the replacement policy's list
+    bool referenced;     // CLOCK and WSClock reference bit
+    bool frequent;       // ARC: in T2 (used again since loaded) rather than T1
+    unsigned int age;    // Aging shift register, as of age_time
+    int age_time;
+    int frequency;       // LFU: references to the page since it was loaded
+    long long last_use;  // LFU tie break, in policy accesses
+    int heap_pos;        // Aging, LFU and OPT: position in the victim heap
+    int next_use;        // OPT: position of the page's next reference, INT_MAX if none
+    bool prefetched;     // read ahead and not referenced since
+    FrameLink owner_link;  // position in the owner's resident list
 } Frame;
 
 // Page structure
 typedef struct {
     bool in_ram;         // true if in RAM, false if in disk
     int frame_index;     // -1 if not in RAM
+    int ghost;           // ARC ghost entry remembering the page, -1 if none
+    int last_reference;  // owner's references when it was last referenced or read ahead
+    bool in_working_set;
+    int ws_prev;         // working set list of the owner, -1 at the ends
+    int ws_next;
 } Page;
 
+// ARC ghost entry: a recently evicted page, kept by identity only
+typedef struct {
+    int process_index;
+    int page_number;
+    bool frequent;       // evicted from T2, so it sits in B2 rather than B1
+    FrameLink link;
+    int next_free;
+} GhostPage;
+
+// Metadata of the replacement policies. Only the policy in use keeps its
+// part up to date.
+typedef struct {
+    FrameList list;      // FIFO load order, LRU access order, ARC T1
+    FrameList frequent;  // ARC T2
+    int clock_hand;      // CLOCK and WSClock: next frame to look at
+    int clock;           // latest tick seen, so ages never run backwards
+    int *heap;           // Aging, LFU and OPT: heap of frames, victim on top
+    int heap_size;
+    int heap_capacity;
+    long long uses;      // LFU: accesses so far
+    // ARC ghost lists B1 and B2, at most num_frames entries between them
+    GhostPage *ghosts;
+    int ghosts_capacity;
+    int ghost_free;
+    FrameList recent_ghosts;
+    FrameList frequent_ghosts;
+    int target;          // ARC: target size of T1 (p)
+    bool ghost_hit;      // ARC: the page about to be loaded hit a ghost, goes to T2
+    int pinned;          // frame no victim may come from, -1 if none
+    long long reference; // position of the current reference in the run
+    // OPT: for each position, the next position of the same page (INT_MAX if
+    // none), planned from the page events of an earlier run
+    int *next_use;
+    int num_planned;
+} ReplacementState;
+
+// Swap device reading the pages of blocked processes, one read at a time.
+// Page slot s (its index in the page table) sits on track
+// s / SWAP_TRACK_PAGES and the head crosses one track per tick.
+typedef struct {
+    DiskSchedule schedule;
+    int read_time;       // ticks to transfer a page once the head is on its track
+    int num_tracks;      // SCAN turns around at tracks 0 and num_tracks - 1
+    int capacity;        // processes, each with at most one pending read
+    int *slot;           // slot each pending process asked for
+    int *fifo;           // FCFS: ring of pending processes, oldest first
+    int fifo_head;
+    VruntimeTree by_slot;  // SSTF, SCAN and C-LOOK: pending processes by slot
+    int pending;
+    int busy;            // process whose page is being read, -1 when idle
+    int head;            // slot of the last read
+    int direction;       // SCAN: 1 toward higher tracks, -1 toward lower
+} SwapDevice;
+
+// TLB entry caching the translation of a resident page
+typedef struct {
+    int page;            // index in the context's page table, -1 if empty
+    long long last_use;  // LRU order within the set
+} TlbEntry;
+
+// Set-associative TLB of every CPU, LRU within each set. Entries are tagged
+// with the page table index, so processes never hit on each other's pages
+// (as with address space IDs), and the set comes from the page number.
+typedef struct {
+    int entries;         // per CPU, 0 when the TLB isn't modelled
+    int ways;            // entries per set
+    int sets;
+    int num_cpus;
+    TlbEntry *slots;     // CPU c, set s at slots[(c * sets + s) * ways]
+    // The same TLBs never flushed, to tell the misses flushes cause; NULL
+    // when flushes are off
+    TlbEntry *shadow;
+    long long clock;
+    long long flushes;
+    long long misses;
+    long long shadow_misses;
+} Tlb;
+
+// A process referenced one of its pages on an executed tick
+typedef struct {
+    int process_index;
+    int page_number;
+    int time;
+} PageEvent;
+
+// Run-length encoded timeline: one run per stretch of ticks in the same state
+typedef struct {
+    int start;           // first tick of the run
+    int length;          // number of ticks
+    ProcessState state;
+    bool page_fault;     // page fault on the first tick of the run
+    short cpu;           // CPU whose runqueue the process was on
+} TimelineRun;
+
+typedef struct {
+    TimelineRun *runs;   // sorted by start, non-overlapping
+    int count;
+    int capacity;
+    struct Arena *arena; // where runs are allocated from
+} Timeline;
+
 // Final status of a process (result after simulation)
 typedef enum {
     PS_PENDING = 0,
@@ -69,7 +258,12 @@ typedef enum {
     MI_TURNAROUND = 7,
     MI_DEADLINE_OK = 8,
     MI_PAGE_FAULTS = 9,
-    MI_COUNT = 10
+    MI_PREFETCH_HITS = 10,    // pages read ahead and then referenced
+    MI_PREFETCH_WASTED = 11,  // pages read ahead and never referenced
+    MI_FAULTS_SAVED = 12,     // faults of the same references without readahead, minus the run's
+    MI_TLB_HIT_RATE = 13,     // % of page references that hit the TLB
+    MI_TLB_STALL = 14,        // cycles stalled on TLB misses
+    MI_COUNT = 15
 } MetricsIndex;
 
 // Summary statistics structure
@@ -81,6 +275,16 @@ typedef struct {
     double throughput;        // processes completed per unit time
     double idle_percentage;   // % of time CPU was idle
     int context_switches;     // total number of context switches
+    int migrations;           // processes moved between CPUs by load balancing
+    int num_cpus;
+    double cpu_utilization[MAX_CPUS];  // % of time each CPU was executing
+    int page_faults;          // all processes, 0 when memory is off
+    int opt_page_faults;      // the same run under OPT (Belady)
+    double avg_fault_wait;    // ticks blocked on page reads, per process
+    double tlb_hit_rate;      // % of page references that hit the TLB
+    long long tlb_stall_cycles;
+    double switch_stall_cycles;  // TLB stall each flush on a context switch adds
+    int swap_outs;            // processes the load controller swapped out
 } SummaryStats;
 
 // Process structure
@@ -92,52 +296,299 @@ typedef struct {
     int priority;
     int deadline;
     int num_pages;  // Number of pages (size) - user configurable
+    AccessPattern access_pattern;
     bool overhead;
-    double vruntime;  // Virtual runtime for CFS algorithm
-    ProcessState *timeline;
-    bool *page_fault_occurred;  // tracks if page fault happened at each time unit (for visual overlay)
+    long long vruntime;  // Virtual runtime for CFS algorithm, fixed point (CFS_VRUNTIME_SCALE per tick)
+    Timeline timeline;   // states over time, including page fault marks (for visual overlay)
     // Metrics array (9 positions): arrival, execution, deadline, priority,
     // start, end, wait, turnaround, deadline_ok?
     int metrics[MI_COUNT];
     // Final status after simulation (completed on time, missed, etc.)
     ProcessStatus final_status;
 
+    // Event engine bookkeeping
+    ProcessState state;   // state entered at state_since, not yet written to timeline
+    int state_since;
+    bool state_fault;     // page fault on the first tick of the pending state
+    int burst_start;      // tick the current CPU burst started (-1 if not running)
+    int cpu;              // CPU whose runqueue the process is on
+    int burst_generation; // tags the burst end event, bumped when a fault cuts the burst short
+    // Run statistics, accumulated as each state run ends (no timeline needed)
+    int first_exec;       // first executed tick, -1 if none
+    int last_exec_end;    // tick after the last executed one, -1 if none
+    int wait_ticks;       // ready or swapped out
+    int fault_wait_ticks; // blocked on page reads
+
     // Memory management
-    Page pages[MAX_PAGES_PER_PROCESS];
+    Page *pages;               // num_pages entries of the context's page table
+    int first_page;            // index of pages[0] in that table
     int page_faults;
-    int page_fault_remaining;  // time remaining blocked by page fault
-    int next_page_to_access;   // for sequential page access
-    int exec_units_since_page_access;  // counter for page access frequency
+    bool resume_reference;     // next executed tick completes the reference that blocked
+    int next_page_to_access;   // sequential and strided cursor, phase window start
+    int exec_units_since_page_access;  // ticks into the current phase
+    unsigned int access_seed;  // random and Zipf patterns
+    // Readahead, see memory.h
+    int last_page;             // page referenced last, -1 before the first
+    int readahead_next;        // first page past the last window read ahead
+    int readahead_size;        // size of that window, 0 while references aren't sequential
+    int readahead_marker;      // page whose reference reads the next window, -1 if none
+    int pages_prefetched;
+    int prefetch_hits;
+    int tlb_hits;
+    int tlb_misses;
+    // Frame allocation, see memory.h
+    FrameList resident;        // its frames, least recently referenced first
+    int references;            // pages referenced so far, the process's virtual time
+    int ws_head;               // working set pages, least recently referenced first
+    int ws_tail;
+    int ws_size;
+    int frame_limit;           // PFF allocation
+    int last_fault_reference;  // references at the last fault (PFF)
+    int demand;                // frames counted for it in memory_demand
+    int reserved;              // demand held since it was swapped back in
 } Process;
 
-// Global variables
-// Processes and algorithms
-extern int TOTAL_TIME;
-extern Process processes[MAX_PROCESSES];
-extern int num_processes;
-extern int current_time;
-extern int current_algorithm;
-extern const char *algorithm_names[];
+// Contents of a frame as seen by the memory animation
+typedef struct {
+    int process_id;      // -1 if free
+    int page_number;
+} FrameSnapshot;
 
-// Scheduler configuration
-extern int quantum;
-extern int overhead_time;
+// A frame got new contents from tick `time` on
+typedef struct {
+    int time;
+    int frame;
+    FrameSnapshot value;
+} FrameChange;
 
-// Memory configuration
-extern bool memory_enabled;
-extern ReplacementPolicy replacement_policy;
-extern Frame ram_frames[TOTAL_RAM_FRAMES];
-extern int current_time_global;
+// Full RAM contents from tick `time` on, folding in every change before
+// first_change
+typedef struct {
+    int time;
+    size_t first_change;
+    FrameSnapshot *frames;
+} MemoryKeyframe;
 
-// Memory history for animation (stores state at each time unit)
-#define MAX_HISTORY_SIZE 500
+// Memory history for animation: a log of frame changes plus a full keyframe
+// whenever the log since the last one grows as large as the RAM, so memory
+// grows with page events and any tick is rebuilt from at most one interval
 typedef struct {
-    int process_id;
-    int page_number;
-} FrameSnapshot;
+    int num_frames;
+    FrameChange *changes;
+    size_t num_changes;
+    size_t changes_capacity;
+    MemoryKeyframe *keyframes;   // keyframes[0] is the empty RAM at tick 0
+    int num_keyframes;
+    int keyframes_capacity;
+    int time;                    // tick the next recorded changes belong to
+    int end_time;                // ticks [0, end_time) can be replayed
+    // Last replayed tick, so stepping forward only applies the new changes
+    FrameSnapshot *cursor;
+    int cursor_time;             // -1 when the cursor holds nothing
+    size_t cursor_next;
+} MemoryHistory;
 
-extern FrameSnapshot ram_history[MAX_HISTORY_SIZE][TOTAL_RAM_FRAMES];
-extern bool history_initialized;
+// Order-statistic treap node: one per tracked page, keyed on the time of its
+// last reference
+typedef struct {
+    long long key;
+    int left;            // -1 if none
+    int right;
+    int parent;
+    int size;            // nodes in the subtree
+    unsigned int priority;
+} StackNode;
+
+// LRU stack distances of a page reference stream (Mattson et al.): a page's
+// distance is the number of distinct pages referenced since its previous
+// reference, itself included, and it hits in every LRU RAM at least that
+// large. Pages are sampled by hash (SHARDS) to bound time and memory.
+typedef struct {
+    double sample_rate;          // fraction of pages tracked, 1 = every page
+    unsigned long long sample_threshold;  // tracked iff hash < threshold
+    int *page_node;              // node of each page, -1 until referenced
+    int num_pages;
+    StackNode *nodes;
+    int num_nodes;
+    int nodes_capacity;
+    int root;                    // -1 when empty
+    long long time;              // tracked references so far
+    long long references;        // every reference, tracked or not
+    long long cold_misses;       // first references of tracked pages
+    long long *histogram;        // [d]: tracked references at distance d
+    int histogram_capacity;
+    int max_distance;
+} MissRatioCurve;
+
+// Hot-path events a run can trace
+typedef enum {
+    TRACE_PICK = 0,         // a process gets a CPU
+    TRACE_PREEMPT,          // it leaves its CPU with work left
+    TRACE_COMPLETE,
+    TRACE_OVERHEAD_START,   // context switch or migration
+    TRACE_OVERHEAD_END,
+    TRACE_FAULT,            // arg: page
+    TRACE_EVICT,            // arg: page of the process evicted
+    TRACE_SWAP_OUT,
+    TRACE_SWAP_IN,
+    TRACE_PHASE_BEGIN,      // arg: TracePhase
+    TRACE_PHASE_END
+} TraceEventType;
+
+// Steps of run_current_algorithm, timed on the wall clock
+typedef enum {
+    TRACE_PHASE_PLAN_OPT = 0,
+    TRACE_PHASE_SCHEDULE,
+    TRACE_PHASE_METRICS,
+    TRACE_PHASE_REPLAY,     // OPT and readahead replays of the page events
+    NUM_TRACE_PHASES
+} TracePhase;
+
+typedef struct {
+    long long wall_ns;      // since the run started, monotonic clock
+    int sim_time;           // tick
+    int process;            // -1 if none
+    int arg;
+    short cpu;              // -1 if none
+    unsigned char type;     // TraceEventType
+    unsigned char phase;    // TracePhase it happened in
+} TraceEvent;
+
+// Ring of the latest events of a run. Each context has its own, so each
+// simulation thread records without locks; events is NULL when off.
+typedef struct {
+    TraceEvent *events;
+    int capacity;           // a power of two
+    long long count;        // events recorded, the last capacity are kept
+    long long start_ns;
+    TracePhase phase;       // of the events recorded now
+} TraceBuffer;
+
+// Run statistics of a CPU, accumulated like those of the processes
+typedef struct {
+    long long busy;         // executed ticks
+    int exec_end;           // end of its latest executed run, 0 if none
+    int switch_until;       // end of its latest context switch period, -1 if none
+} CpuStats;
+
+// Everything a simulation run reads and writes. Contexts are independent,
+// so several simulations can run at the same time (one per thread).
+typedef struct SimContext {
+    // Processes
+    Process *processes;    // growable table, see process_table.h
+    int num_processes;
+    int process_capacity;
+    Arena timeline_arena;  // backs every process timeline
+
+    // Scheduler configuration
+    int total_time;
+    int algorithm;         // index into algorithm_names[]
+    int quantum;
+    int overhead_time;
+    int num_cpus;          // RR and CFS schedule on all of them, 1..MAX_CPUS
+    int migration_cost;    // ticks a stolen process spends moving to its new CPU
+    int migrations;        // set by the last run
+    long long dispatches;  // CPU bursts started by the last run
+
+    // Statistics of the last run, kept by the engine as states change so
+    // that metrics need no pass over the timelines. Context switch periods
+    // starting at or after the last executed tick don't count; until the
+    // run is over, those that still may are kept aside.
+    bool keep_timelines;   // false runs without them, when only metrics are read
+    CpuStats cpu_stats[MAX_CPUS];
+    int exec_end;          // end of the latest executed run, 0 if none
+    int switch_periods;    // context switch periods starting before exec_end - 1
+    int *late_switches;    // starts of the others
+    int num_late_switches;
+    int late_switches_capacity;
+
+    // Memory configuration and state
+    bool memory_enabled;
+    ReplacementPolicy replacement_policy;
+    Frame *ram_frames;     // num_frames frames, sized by reset_ram_frames()
+    int frames_capacity;
+    int num_frames;        // RAM size in frames, 1..MAX_RAM_FRAMES
+    int frame_size_kb;
+    int free_frame_top;    // free frames form a stack, -1 when RAM is full
+    int free_frame_count;
+    ReplacementState replacement;
+    int current_time_global;
+    int max_pages_per_process;       // 1..MAX_PAGES_LIMIT
+    AccessPattern access_pattern;    // given to new processes
+    Page *pages;           // pages of every process, sized by init_memory_system()
+    int num_pages;
+    int pages_capacity;
+    // Processes on a CPU reference one page per executed tick; every tick
+    // before referenced_until has been referenced
+    int *running;
+    int num_running;
+    int referenced_until;
+    // A fault blocks the process for fault_time ticks plus the seek, queued
+    // on the swap device; 0 keeps faults non-blocking
+    int fault_time;
+    DiskSchedule disk_schedule;
+    SwapDevice swap;
+    // Largest window of pages read ahead of a sequential run, 0 for demand
+    // paging only
+    int readahead_pages;
+    // TLB of tlb_entries entries (0 = no TLB) per CPU in sets of tlb_ways,
+    // flushed on every context switch with tlb_flush
+    int tlb_entries;
+    int tlb_ways;
+    bool tlb_flush;
+    Tlb tlb;
+    // Resident sets under frame_allocation, and the load controller: while
+    // the processes in memory need more than num_frames frames between them
+    // (memory_demand), a process whose page read completes is swapped out
+    // instead of becoming ready. Swapped-out processes come back in order
+    // once their demand fits again.
+    FrameAllocation frame_allocation;
+    int ws_window;
+    int pff_low;
+    int pff_high;
+    int memory_demand;
+    int *swapped_out;      // ring of num_processes entries, oldest first
+    int swapped_head;
+    int num_swapped_out;
+    int swap_outs;         // set by the last run
+
+    // Memory history for animation, only recorded for the interface
+    bool keep_memory_history;
+    MemoryHistory memory_history;
+
+    // Page events of the last run, in order, so that other policies can be
+    // replayed on it (OPT and the fault gap to it)
+    bool keep_page_events;
+    PageEvent *page_events;
+    int num_page_events;
+    int page_events_capacity;
+
+    // LRU miss-ratio curve of the page references, only kept when asked for
+    bool keep_miss_ratio_curve;
+    MissRatioCurve miss_ratio_curve;
+
+    // Hot-path event trace of the last run, only kept when asked for
+    TraceBuffer trace;
+
+    // Results
+    bool metrics_computed;
+    SummaryStats summary_stats;
+} SimContext;
+
+// Global variables
+// Simulation shown by the interface
+extern SimContext sim;
+extern int current_time;
+extern const char *algorithm_names[];
+extern const char *algorithm_keys[];    // command line names, same order
+extern const char *replacement_policy_names[];
+extern const char *replacement_policy_keys[];
+extern const char *access_pattern_names[];
+extern const char *access_pattern_keys[];
+extern const char *disk_schedule_names[];
+extern const char *disk_schedule_keys[];
+extern const char *frame_allocation_names[];
+extern const char *frame_allocation_keys[];
 
 // Memory visualization
 extern int memory_animation_frame;  // current frame being displayed
@@ -154,10 +605,6 @@ extern int visible_columns;
 // Controls and state
 extern bool simulation_running;
 extern int animation_speed;
-// Metrics ready flag
-extern bool metrics_computed;
-// Summary statistics
-extern SummaryStats summary_stats;
 
 // Global functions
 void update_screen_size();
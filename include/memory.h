@@ -4,23 +4,52 @@
 #include "globals.h"
 
 // Initialize memory system
-void init_memory_system();
+void init_memory_system(SimContext *ctx);
+void reset_ram_frames(SimContext *ctx);  // every frame free, nothing resident
+void free_memory_system(SimContext *ctx);
 
-// Find free or victim frame
-int find_free_frame();
-int find_victim_frame_fifo();
-int find_victim_frame_lru();
+// Find a free frame (victims come from the policy, see replacement.h)
+int find_free_frame(SimContext *ctx);
 
 // Page management
-void evict_page(int frame_index);
-void load_page_to_ram(int process_index, int page_number);
-bool check_page_fault(int process_index);
+void evict_page(SimContext *ctx, int frame_index);
+void load_page_to_ram(SimContext *ctx, int process_index, int page_number);
+
+// Page the process references on its next executed tick, drawn from its
+// access pattern. Advances the pattern, so call it once per tick.
+int next_page_reference(SimContext *ctx, int process_index);
+
+// The process references one of its pages at current_time_global. Returns
+// true on a page fault, which loads that page. With readahead_pages set, a
+// fault on the next page of a sequential run also loads a window of the pages
+// after it; the window grows while the run goes on and shrinks when its pages
+// are evicted unused. Under a frame allocation other than global, the
+// resident set of the process stays within its working set or its PFF
+// allocation, replacing its own least recently referenced page once full.
+bool reference_page(SimContext *ctx, int process_index, int page_number);
+
+// Load control, for frame allocations other than global (a no-op under
+// global). The process exited or is swapped out at tick time: its frames go
+// back to the RAM and its demand to 0.
+void release_process_memory(SimContext *ctx, int process_index, int time);
+// Whether the processes in memory need more frames than the RAM holds, and
+// some process besides this one holds any
+bool memory_overcommitted(const SimContext *ctx, int process_index);
+// Release the memory of the process and queue it until its demand fits again
+void swap_out_process(SimContext *ctx, int process_index, int time);
+// Oldest swapped-out process, taken off the queue with its old demand
+// reserved, once that demand fits beside the others' or nobody holds any
+// memory; -1 if none
+int swap_in_process(SimContext *ctx);
 
 // Statistics
-int count_pages_in_ram(int process_index);
-int count_pages_in_disk(int process_index);
+int count_pages_in_ram(SimContext *ctx, int process_index);
+int count_pages_in_disk(SimContext *ctx, int process_index);
 
-// Memory history for animation
-void save_memory_state(int time_unit);
+// Page faults of the logged page events of ctx under another policy, with
+// the same RAM and frame allocation and no readahead. Exits and swap-outs
+// aren't replayed. process_faults, if not NULL, gets the faults
+// of each process.
+int replay_page_faults(const SimContext *ctx, ReplacementPolicy replacement_policy, int *process_faults);
 
 #endif
@@ -0,0 +1,24 @@
+#ifndef MEMORY_HISTORY_H
+#define MEMORY_HISTORY_H
+
+#include "globals.h"
+
+void memory_history_init(MemoryHistory *history);
+void memory_history_free(MemoryHistory *history);
+
+// Start recording a new run on an empty RAM of num_frames frames
+void memory_history_reset(MemoryHistory *history, int num_frames);
+
+// Changes recorded from now on take effect at this tick (never decreasing)
+void memory_history_advance(MemoryHistory *history, int time_unit);
+void memory_history_record(MemoryHistory *history, int frame, int process_id, int page_number);
+
+// Recording is over: ticks [0, end_time) can be replayed
+void memory_history_finish(MemoryHistory *history, int end_time);
+
+// RAM contents at a tick (num_frames entries, valid until the next call),
+// NULL outside the recorded range. O(keyframe interval), O(changes since the
+// previous call) when stepping forward.
+const FrameSnapshot *memory_history_at(MemoryHistory *history, int time_unit);
+
+#endif
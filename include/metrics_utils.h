@@ -1,7 +1,9 @@
 #ifndef METRICS_UTILS_H
 #define METRICS_UTILS_H
 
-void compute_metrics_for_all();
-void compute_summary_stats();
+#include "globals.h"
+
+void compute_metrics_for_all(SimContext *ctx);
+void compute_summary_stats(SimContext *ctx);
 
 #endif
@@ -0,0 +1,24 @@
+#ifndef MISS_RATIO_H
+#define MISS_RATIO_H
+
+#include <stdio.h>
+#include "globals.h"
+
+// sample_rate in (0, 1]: the fraction of pages whose references are tracked
+void miss_ratio_init(MissRatioCurve *mrc, double sample_rate);
+void miss_ratio_free(MissRatioCurve *mrc);
+
+// Start a new stream over pages 0..num_pages-1, all never referenced
+void miss_ratio_reset(MissRatioCurve *mrc, int num_pages);
+
+// O(log n) expected in the pages tracked
+void miss_ratio_reference(MissRatioCurve *mrc, int page);
+
+// Estimated LRU faults of the stream with a RAM of the given frames
+long long miss_ratio_misses(const MissRatioCurve *mrc, int frames);
+
+// frames,misses,miss_ratio for every RAM size from 1 frame up to the largest
+// distance seen, past which only the first references miss
+void miss_ratio_write_csv(const MissRatioCurve *mrc, FILE *out);
+
+#endif
@@ -0,0 +1,15 @@
+#ifndef PROCESS_TABLE_H
+#define PROCESS_TABLE_H
+
+#include "globals.h"
+
+// Growable process table. Per-run buffers (timeline runs) come from a single
+// arena so they are released in one call.
+Process *process_table_add(SimContext *ctx);
+void process_table_remove(SimContext *ctx, int index);
+void process_table_clear(SimContext *ctx);
+void process_table_alloc_timelines(SimContext *ctx);
+void process_table_free(SimContext *ctx);
+int process_index_by_id(const SimContext *ctx, int id);
+
+#endif
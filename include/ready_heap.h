@@ -0,0 +1,32 @@
+#ifndef READY_HEAP_H
+#define READY_HEAP_H
+
+#include <stdbool.h>
+
+// Ordering between two process indices: true if a must run before b.
+// context is the pointer given to ready_heap_init (the simulation the
+// indices refer to).
+typedef bool (*ReadyHeapBefore)(const void *context, int a, int b);
+
+// Indexed binary min-heap of process indices. The position map makes
+// membership tests, removal and key updates (decrease/increase-key) O(log N).
+typedef struct {
+    int *heap;        // process indices in heap order
+    int *position;    // position[process] in heap, -1 if not queued
+    int size;
+    int capacity;
+    ReadyHeapBefore before;
+    const void *context;
+} ReadyHeap;
+
+void ready_heap_init(ReadyHeap *rh, int capacity, ReadyHeapBefore before, const void *context);
+void ready_heap_free(ReadyHeap *rh);
+void ready_heap_push(ReadyHeap *rh, int process);
+int ready_heap_peek(const ReadyHeap *rh);
+int ready_heap_pop(ReadyHeap *rh);
+void ready_heap_remove(ReadyHeap *rh, int process);
+void ready_heap_update(ReadyHeap *rh, int process);
+bool ready_heap_contains(const ReadyHeap *rh, int process);
+int ready_heap_runner_up(const ReadyHeap *rh);
+
+#endif
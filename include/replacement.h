@@ -0,0 +1,31 @@
+#ifndef REPLACEMENT_H
+#define REPLACEMENT_H
+
+#include "globals.h"
+
+// Hooks of a page replacement policy. Every frame passed in is resident
+// (process_index and page_number set).
+typedef struct {
+    // A page was just placed in the frame
+    void (*on_load)(SimContext *ctx, int frame_index);
+    // The owner referenced the page again
+    void (*on_access)(SimContext *ctx, int frame_index);
+    // Frame to evict to make room for a page of a process, -1 if RAM is empty
+    int (*pick_victim)(SimContext *ctx, int process_index, int page_number);
+    // The frame is about to be emptied
+    void (*on_evict)(SimContext *ctx, int frame_index);
+} ReplacementOps;
+
+// Indexed by ReplacementPolicy
+extern const ReplacementOps replacement_ops[NUM_REPLACEMENT_POLICIES];
+
+// Forget every page, for an empty RAM of num_frames frames. The OPT plan is
+// kept.
+void replacement_reset(SimContext *ctx);
+void replacement_free(SimContext *ctx);
+
+// Plan OPT from the page events of a run of the same schedule, once the
+// page table is laid out (init_memory_system)
+void replacement_plan_opt(SimContext *ctx, const PageEvent *events, int num_events);
+
+#endif
@@ -4,13 +4,13 @@
 #include "globals.h"
 #include <math.h>
 
-void initialize_default_processes();
-void execute_fifo();
-void execute_sjf();
-void execute_edf();
-void execute_rr();
-void execute_cfs();
-void run_current_algorithm();
-void reset_simulation();
+void initialize_default_processes(SimContext *ctx);
+void execute_fifo(SimContext *ctx);
+void execute_sjf(SimContext *ctx);
+void execute_edf(SimContext *ctx);
+void execute_rr(SimContext *ctx);
+void execute_cfs(SimContext *ctx);
+void run_current_algorithm(SimContext *ctx);
+void reset_simulation(SimContext *ctx);
 
 #endif
@@ -0,0 +1,19 @@
+#ifndef SIM_CONTEXT_H
+#define SIM_CONTEXT_H
+
+#include "globals.h"
+
+// Set up an empty simulation with the default configuration
+void sim_context_init(SimContext *ctx);
+// Release the process table and every buffer owned by the context
+void sim_context_free(SimContext *ctx);
+
+// Copy the configuration and the process table of src into dst (a context
+// set up with sim_context_init). Results and timelines start empty.
+void sim_context_copy_workload(SimContext *dst, const SimContext *src);
+
+// Heap-allocated contexts, for callers that run several simulations at once
+SimContext *sim_context_create();
+void sim_context_destroy(SimContext *ctx);
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef SWAP_DEVICE_H
+#define SWAP_DEVICE_H
+
+#include "globals.h"
+
+// Tracks holding num_pages page slots, at least one
+int swap_device_tracks(long long num_pages);
+
+// Idle device with no pending reads, for the processes and the page table of
+// ctx (laid out by init_memory_system)
+void swap_device_init(SwapDevice *dev, const SimContext *ctx);
+void swap_device_free(SwapDevice *dev);
+
+// Queue the read of a page slot for a blocked process
+void swap_device_request(SwapDevice *dev, int process, int slot);
+
+// If the device is idle, start the next pending read in its order and
+// return the process it serves, with *ticks set to the seek plus the
+// transfer. -1 if busy or nothing is pending.
+int swap_device_start(SwapDevice *dev, int *ticks);
+
+// The read in progress is done
+void swap_device_finish(SwapDevice *dev);
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include <stdio.h>
+#include "globals.h"
+
+// Memory settings a sweep can try: MEMORY_OFF disables paging, any other
+// value m pages with replacement policy m - 1
+typedef enum {
+    SWEEP_MEMORY_OFF = 0,
+    SWEEP_MEMORY_COUNT = NUM_REPLACEMENT_POLICIES + 1
+} SweepMemory;
+
+// Inclusive range from..to in increments of step
+typedef struct {
+    int from;
+    int to;
+    int step;
+} SweepRange;
+
+typedef struct {
+    bool algorithms[NUM_ALGORITHMS];
+    SweepRange quantum;
+    SweepRange overhead;
+    SweepRange frames;
+    SweepRange cpus;
+    bool memory[SWEEP_MEMORY_COUNT];
+    int threads;              // worker threads, 0 = one per CPU
+} SweepSpec;
+
+// Every axis a single value taken from base (its algorithm, quantum, ...)
+void sweep_spec_from_context(SweepSpec *spec, const SimContext *base);
+
+// Parse "A", "A:B" or "A:B:STEP" into range
+bool sweep_parse_range(const char *text, int min_val, int max_val, SweepRange *range);
+
+// Command line name of a memory setting: "off" or a policy key
+const char *sweep_memory_key(int memory);
+
+// Number of configurations in the grid
+long long sweep_size(const SweepSpec *spec);
+
+// Run the workload of base once per grid point on a work-stealing pool and
+// write one CSV row per configuration to out, in grid order, as soon as it
+// (and every row before it) is done. Returns the number of rows written.
+long long run_sweep(const SimContext *base, const SweepSpec *spec, FILE *out);
+
+#endif
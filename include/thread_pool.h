@@ -0,0 +1,48 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <pthread.h>
+#include <stdbool.h>
+
+typedef void (*ThreadPoolTask)(void *arg);
+
+typedef struct {
+    ThreadPoolTask task;
+    void *arg;
+} ThreadPoolJob;
+
+// Per-worker deque: the owner takes from the tail, thieves from the head
+typedef struct {
+    ThreadPoolJob *jobs;      // circular buffer
+    int head;
+    int count;
+    int capacity;
+    pthread_mutex_t lock;
+} WorkerQueue;
+
+// Work-stealing pool. Submitted jobs are spread over the workers' queues;
+// a worker whose queue runs dry steals from the others, so uneven job
+// lengths do not leave threads idle.
+typedef struct {
+    pthread_t *threads;
+    WorkerQueue *queues;      // one per worker
+    int num_threads;
+    int next_queue;           // round-robin target for submissions
+
+    int queued;               // jobs sitting in some queue (upper bound)
+    int pending;              // queued + running jobs
+    bool shutting_down;
+    pthread_mutex_t lock;     // guards the counters above
+    pthread_cond_t work_available;
+    pthread_cond_t all_done;
+} ThreadPool;
+
+ThreadPool *thread_pool_create(int num_threads);
+void thread_pool_submit(ThreadPool *pool, ThreadPoolTask task, void *arg);
+void thread_pool_wait(ThreadPool *pool);
+void thread_pool_destroy(ThreadPool *pool);
+
+// Number of online CPUs (at least 1)
+int thread_pool_default_size();
+
+#endif
@@ -0,0 +1,16 @@
+#ifndef TIMELINE_H
+#define TIMELINE_H
+
+#include "globals.h"
+#include "arena.h"
+
+void timeline_init(Timeline *tl, Arena *arena);
+void timeline_reset(Timeline *tl);
+void timeline_append(Timeline *tl, int start, int length, ProcessState state, int cpu, bool page_fault);
+
+// Random access, O(log runs). Ticks not covered by any run are NOT_ARRIVED.
+int timeline_find_run(const Timeline *tl, int t);
+ProcessState timeline_state_at(const Timeline *tl, int t);
+bool timeline_fault_at(const Timeline *tl, int t);
+
+#endif
@@ -0,0 +1,22 @@
+#ifndef TLB_H
+#define TLB_H
+
+#include "globals.h"
+
+// Empty TLBs for the CPUs of ctx, tlb_entries each in sets of tlb_ways (the
+// largest divisor of tlb_entries up to it). No TLB if tlb_entries is 0.
+void tlb_init(Tlb *tlb, const SimContext *ctx);
+void tlb_free(Tlb *tlb);
+
+// Translate page page_number, at index page of the page table, on a CPU.
+// Returns true on a hit; a miss loads the entry in place of the least
+// recently used one of its set.
+bool tlb_lookup(Tlb *tlb, int cpu, int page_number, int page);
+
+// Empty the TLB of a CPU
+void tlb_flush(Tlb *tlb, int cpu);
+
+// The page left RAM: drop its entry on every CPU
+void tlb_invalidate(Tlb *tlb, int page_number, int page);
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdio.h>
+#include "globals.h"
+
+// Off until trace_enable
+void trace_init(TraceBuffer *trace);
+// Keep the last capacity events of each run, rounded up to a power of two
+void trace_enable(TraceBuffer *trace, int capacity);
+void trace_free(TraceBuffer *trace);
+
+// Forget the events recorded; the wall clock starts over
+void trace_reset(TraceBuffer *trace);
+
+void trace_record(TraceBuffer *trace, TraceEventType type, int sim_time, int process, int cpu, int arg);
+
+// Event of process (-1 for none) at tick sim_time, on the process's CPU.
+// Costs one test when tracing is off.
+static inline void trace_event(SimContext *ctx, TraceEventType type, int sim_time, int process, int arg) {
+    if (ctx->trace.events == NULL) return;
+    trace_record(&ctx->trace, type, sim_time, process, process >= 0 ? ctx->processes[process].cpu : -1, arg);
+}
+
+// Events recorded but no longer in the ring
+long long trace_dropped(const TraceBuffer *trace);
+
+// Chrome trace-event JSON (chrome://tracing, Perfetto) of the events kept:
+// the schedule on simulated time, one tick per microsecond, and the same
+// events with the phases of the run on the wall clock
+void trace_write_chrome(const TraceBuffer *trace, const SimContext *ctx, FILE *out);
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef TRACE_IMPORT_H
+#define TRACE_IMPORT_H
+
+#include <stdio.h>
+#include "globals.h"
+
+typedef struct {
+    long long tick_ns;     // trace time that makes up one simulator tick
+    int max_processes;     // stop after this many bursts, 0 = no limit
+} TraceImportOptions;
+
+// 1 ms ticks, no limit
+void trace_import_defaults(TraceImportOptions *options);
+
+// Load a `trace-cmd report` or `perf sched script` text trace into the
+// process table. Every CPU burst of a task (from the moment it becomes
+// runnable until it blocks) becomes one process:
+//   arrival   - tick the task was woken up
+//   execution - time it spent on a CPU, rounded to ticks (at least 1)
+//   deadline  - turnaround it had on the traced host
+//   priority  - nice level, nice 0 at priority 5 (clamped to 1-10)
+// The file is read through a sliding memory map, so memory use depends on
+// the number of tasks and imported bursts, not on the size of the trace.
+// Returns the number of processes read, or -1 with a message in err.
+int load_sched_trace(SimContext *ctx, FILE *in, const TraceImportOptions *options, char *err, size_t err_size);
+int load_sched_trace_file(SimContext *ctx, const char *path, const TraceImportOptions *options,
+                          char *err, size_t err_size);
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef VRUNTIME_TREE_H
+#define VRUNTIME_TREE_H
+
+#include <stdbool.h>
+
+// Red-black tree of process indices ordered by an integer key (the CFS
+// virtual runtime), lowest key first and the highest index on ties.
+// Nodes are intrusive: the node of process i lives in slot i, so nothing is
+// allocated after init. The leftmost node is cached, making the pick of the
+// next process O(1); insert and remove are O(log N).
+typedef struct {
+    long long key;       // valid while queued
+    int left;
+    int right;
+    int parent;
+    bool red;
+    bool queued;         // whether the process is in the tree
+} VruntimeNode;
+
+typedef struct {
+    VruntimeNode *node;  // node[process], plus the sentinel
+    int nil;             // sentinel slot, black, index capacity
+    int root;
+    int leftmost;        // -1 when empty
+    int size;
+    int capacity;
+} VruntimeTree;
+
+void vruntime_tree_init(VruntimeTree *tree, int capacity);
+void vruntime_tree_free(VruntimeTree *tree);
+void vruntime_tree_insert(VruntimeTree *tree, int process, long long key);
+void vruntime_tree_remove(VruntimeTree *tree, int process);
+bool vruntime_tree_contains(const VruntimeTree *tree, int process);
+int vruntime_tree_first(const VruntimeTree *tree);
+int vruntime_tree_next(const VruntimeTree *tree, int process);
+// Nearest processes by key, O(log N)
+int vruntime_tree_ceiling(const VruntimeTree *tree, long long key);
+int vruntime_tree_floor(const VruntimeTree *tree, long long key);
+
+#endif
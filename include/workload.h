@@ -0,0 +1,18 @@
+#ifndef WORKLOAD_H
+#define WORKLOAD_H
+
+#include <stdio.h>
+#include "globals.h"
+
+// Load processes from a text workload into the process table.
+// One process per line: arrival execution deadline priority [pages [pattern]]
+// with pattern one of access_pattern_keys[] (default: ctx->access_pattern).
+// Blank lines and lines starting with '#' are ignored.
+// Returns the number of processes read, or -1 with a message in err.
+int load_workload(SimContext *ctx, FILE *in, char *err, size_t err_size);
+int load_workload_file(SimContext *ctx, const char *path, char *err, size_t err_size);
+
+// Index of the access pattern with this key, -1 if there is none
+int parse_access_pattern(const char *name);
+
+#endif
@@ -0,0 +1,35 @@
+#include "../../include/compare.h"
+#include "../../include/scheduler.h"
+#include "../../include/sim_context.h"
+#include "../../include/thread_pool.h"
+
+static void run_algorithm_task(void *arg) {
+    SimContext *ctx = arg;
+    reset_simulation(ctx);
+    run_current_algorithm(ctx);
+}
+
+int compare_algorithms(const SimContext *base, SummaryStats results[NUM_ALGORITHMS]) {
+    SimContext *runs[NUM_ALGORITHMS];
+
+    int workers = thread_pool_default_size();
+    if (workers > NUM_ALGORITHMS) workers = NUM_ALGORITHMS;
+    ThreadPool *pool = thread_pool_create(workers);
+
+    // Each algorithm gets a private context: nothing is shared between workers
+    for (int a = 0; a < NUM_ALGORITHMS; a++) {
+        runs[a] = sim_context_create();
+        sim_context_copy_workload(runs[a], base);
+        runs[a]->algorithm = a;
+        runs[a]->keep_timelines = false;  // only the summary is read
+        thread_pool_submit(pool, run_algorithm_task, runs[a]);
+    }
+    thread_pool_wait(pool);
+    thread_pool_destroy(pool);
+
+    for (int a = 0; a < NUM_ALGORITHMS; a++) {
+        results[a] = runs[a]->summary_stats;
+        sim_context_destroy(runs[a]);
+    }
+    return workers;
+}
@@ -1,259 +1,721 @@
+#include <limits.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include "../../include/memory.h"
 #include "../../include/globals.h"
+#include "../../include/memory_history.h"
+#include "../../include/replacement.h"
+#include "../../include/miss_ratio.h"
+#include "../../include/sim_context.h"
+#include "../../include/tlb.h"
+#include "../../include/trace.h"
+
+// Strided pattern: pages skipped between references
+#define ACCESS_STRIDE 4
+// Zipf pattern: page k (from 0) is referenced with weight 1 / (k + 1)^s
+#define ZIPF_EXPONENT 1.0
+// Phases pattern: ticks spent on each working set, a quarter of the pages
+#define PHASE_LENGTH 50
+#define PHASE_WORKING_SET_DIVISOR 4
+// Readahead windows take at most this fraction of the RAM
+#define READAHEAD_RAM_DIVISOR 4
+
+// Hooks of the replacement policy in use
+static const ReplacementOps *policy(SimContext *ctx) {
+    return &replacement_ops[ctx->replacement_policy];
+}
 
-void init_memory_system() {
-    // Safety check
-    if (num_processes == 0) {
-        return;
+// Frame allocation in use. OPT is the optimum over the whole RAM, so it
+// always replaces globally.
+static FrameAllocation allocation(const SimContext *ctx) {
+    return ctx->replacement_policy == POLICY_OPT ? ALLOCATION_GLOBAL : ctx->frame_allocation;
+}
+
+// Append a frame to its owner's resident list, as the most recently referenced
+static void resident_push(SimContext *ctx, int frame_index) {
+    Frame *frame = &ctx->ram_frames[frame_index];
+    FrameList *list = &ctx->processes[frame->process_index].resident;
+    frame->owner_link = (FrameLink){list->tail, -1};
+    if (list->tail == -1) {
+        list->head = frame_index;
+    } else {
+        ctx->ram_frames[list->tail].owner_link.next = frame_index;
     }
+    list->tail = frame_index;
+    list->size++;
+}
 
-    // Initialize all frames as free
-    for (int i = 0; i < TOTAL_RAM_FRAMES; i++) {
-        ram_frames[i].process_id = -1;
-        ram_frames[i].page_number = -1;
-        ram_frames[i].load_time = 0;
-        ram_frames[i].last_access = 0;
+static void resident_unlink(SimContext *ctx, int frame_index) {
+    Frame *frame = &ctx->ram_frames[frame_index];
+    FrameList *list = &ctx->processes[frame->process_index].resident;
+    FrameLink link = frame->owner_link;
+    if (link.prev == -1) {
+        list->head = link.next;
+    } else {
+        ctx->ram_frames[link.prev].owner_link.next = link.next;
     }
+    if (link.next == -1) {
+        list->tail = link.prev;
+    } else {
+        ctx->ram_frames[link.next].owner_link.prev = link.prev;
+    }
+    frame->owner_link = (FrameLink){-1, -1};
+    list->size--;
+}
 
-    // Initialize all processes - start with all pages in DISK
-    for (int i = 0; i < num_processes; i++) {
-        // Use the num_pages configured by user (already set in process configuration)
-        // If not set, default to 3 pages
-        if (processes[i].num_pages <= 0) {
-            processes[i].num_pages = 3;
-        }
-        // Limit to max pages per process
-        if (processes[i].num_pages > MAX_PAGES_PER_PROCESS) {
-            processes[i].num_pages = MAX_PAGES_PER_PROCESS;
-        }
+// Working set list of a process, threaded through its pages
+static void working_set_push(Process *p, int page_number) {
+    Page *page = &p->pages[page_number];
+    page->in_working_set = true;
+    page->ws_prev = p->ws_tail;
+    page->ws_next = -1;
+    if (p->ws_tail == -1) {
+        p->ws_head = page_number;
+    } else {
+        p->pages[p->ws_tail].ws_next = page_number;
+    }
+    p->ws_tail = page_number;
+    p->ws_size++;
+}
 
-        processes[i].page_faults = 0;
-        processes[i].page_fault_remaining = 0;
-        processes[i].next_page_to_access = 0;
-        processes[i].exec_units_since_page_access = 0;
+static void working_set_unlink(Process *p, int page_number) {
+    Page *page = &p->pages[page_number];
+    if (page->ws_prev == -1) {
+        p->ws_head = page->ws_next;
+    } else {
+        p->pages[page->ws_prev].ws_next = page->ws_next;
+    }
+    if (page->ws_next == -1) {
+        p->ws_tail = page->ws_prev;
+    } else {
+        p->pages[page->ws_next].ws_prev = page->ws_prev;
+    }
+    page->in_working_set = false;
+    page->ws_prev = -1;
+    page->ws_next = -1;
+    p->ws_size--;
+}
 
-        // Initialize all pages as not in RAM (in DISK)
-        for (int p = 0; p < processes[i].num_pages; p++) {
-            processes[i].pages[p].in_ram = false;
-            processes[i].pages[p].frame_index = -1;
+static void push_page_event(SimContext *ctx, int process_index, int page_number) {
+    if (ctx->num_page_events == ctx->page_events_capacity) {
+        int new_capacity = ctx->page_events_capacity > 0 ? ctx->page_events_capacity * 2 : 256;
+        PageEvent *grown = realloc(ctx->page_events, (size_t)new_capacity * sizeof(PageEvent));
+        if (grown == NULL) {
+            fprintf(stderr, "Error: Failed to grow page event log to %d events\n", new_capacity);
+            exit(1);
         }
+        ctx->page_events = grown;
+        ctx->page_events_capacity = new_capacity;
     }
+    PageEvent *event = &ctx->page_events[ctx->num_page_events++];
+    event->process_index = process_index;
+    event->page_number = page_number;
+    event->time = ctx->current_time_global;
+}
 
-    current_time_global = 0;
+static void push_free_frame(SimContext *ctx, int frame_index) {
+    ctx->ram_frames[frame_index].next_free = ctx->free_frame_top;
+    ctx->free_frame_top = frame_index;
+    ctx->free_frame_count++;
 }
 
-int find_free_frame() {
-    for (int i = 0; i < TOTAL_RAM_FRAMES; i++) {
-        if (ram_frames[i].process_id == -1) {
-            return i;
-        }
+static int pop_free_frame(SimContext *ctx) {
+    int frame_index = ctx->free_frame_top;
+    if (frame_index != -1) {
+        ctx->free_frame_top = ctx->ram_frames[frame_index].next_free;
+        ctx->ram_frames[frame_index].next_free = -1;
+        ctx->free_frame_count--;
     }
-    return -1;  // No free frame
+    return frame_index;
 }
 
-int find_victim_frame_fifo() {
-    int oldest_time = current_time_global + 1;
-    int victim = 0;
+// Put a page into a frame just taken from the free stack
+static void place_page(SimContext *ctx, int frame_index, int process_index, int page_number) {
+    Frame *frame = &ctx->ram_frames[frame_index];
+    frame->process_index = process_index;
+    frame->page_number = page_number;
+    frame->load_time = ctx->current_time_global;
+    frame->last_access = ctx->current_time_global;
+    frame->prefetched = false;
+
+    ctx->processes[process_index].pages[page_number].in_ram = true;
+    ctx->processes[process_index].pages[page_number].frame_index = frame_index;
+    if (allocation(ctx) != ALLOCATION_GLOBAL) resident_push(ctx, frame_index);
+    policy(ctx)->on_load(ctx, frame_index);
+    if (ctx->keep_memory_history) {
+        memory_history_record(&ctx->memory_history, frame_index, ctx->processes[process_index].id, page_number);
+    }
+}
 
-    for (int i = 0; i < TOTAL_RAM_FRAMES; i++) {
-        if (ram_frames[i].process_id != -1 && ram_frames[i].load_time < oldest_time) {
-            oldest_time = ram_frames[i].load_time;
-            victim = i;
+void reset_ram_frames(SimContext *ctx) {
+    if (ctx->frames_capacity < ctx->num_frames) {
+        free(ctx->ram_frames);
+        ctx->ram_frames = malloc((size_t)ctx->num_frames * sizeof(Frame));
+        if (ctx->ram_frames == NULL) {
+            fprintf(stderr, "Error: Failed to allocate %d RAM frames\n", ctx->num_frames);
+            exit(1);
         }
+        ctx->frames_capacity = ctx->num_frames;
     }
 
-    return victim;
+    ctx->free_frame_top = -1;
+    ctx->free_frame_count = 0;
+    replacement_reset(ctx);
+
+    // Pushed from the top so that frames are handed out from index 0 up
+    for (int i = ctx->num_frames - 1; i >= 0; i--) {
+        ctx->ram_frames[i].process_index = -1;
+        ctx->ram_frames[i].page_number = -1;
+        ctx->ram_frames[i].load_time = 0;
+        ctx->ram_frames[i].last_access = 0;
+        ctx->ram_frames[i].next_free = -1;
+        ctx->ram_frames[i].link = (FrameLink){-1, -1};
+        ctx->ram_frames[i].referenced = false;
+        ctx->ram_frames[i].frequent = false;
+        ctx->ram_frames[i].age = 0;
+        ctx->ram_frames[i].age_time = 0;
+        ctx->ram_frames[i].frequency = 0;
+        ctx->ram_frames[i].last_use = 0;
+        ctx->ram_frames[i].heap_pos = -1;
+        ctx->ram_frames[i].next_use = 0;
+        ctx->ram_frames[i].prefetched = false;
+        ctx->ram_frames[i].owner_link = (FrameLink){-1, -1};
+        push_free_frame(ctx, i);
+    }
 }
 
-int find_victim_frame_lru() {
-    int oldest_access = current_time_global + 1;
-    int victim = 0;
+void free_memory_system(SimContext *ctx) {
+    free(ctx->ram_frames);
+    ctx->ram_frames = NULL;
+    ctx->frames_capacity = 0;
+    replacement_free(ctx);
+    free(ctx->pages);
+    ctx->pages = NULL;
+    ctx->num_pages = 0;
+    ctx->pages_capacity = 0;
+    free(ctx->page_events);
+    ctx->page_events = NULL;
+    ctx->num_page_events = 0;
+    ctx->page_events_capacity = 0;
+    memory_history_free(&ctx->memory_history);
+    miss_ratio_free(&ctx->miss_ratio_curve);
+    tlb_free(&ctx->tlb);
+    free(ctx->swapped_out);
+    ctx->swapped_out = NULL;
+    ctx->num_swapped_out = 0;
+}
 
-    for (int i = 0; i < TOTAL_RAM_FRAMES; i++) {
-        if (ram_frames[i].process_id != -1 && ram_frames[i].last_access < oldest_access) {
-            oldest_access = ram_frames[i].last_access;
-            victim = i;
+// Lay the pages of every process out in the context's page table
+static void alloc_pages(SimContext *ctx) {
+    long long total = 0;
+    for (int i = 0; i < ctx->num_processes; i++) {
+        ctx->processes[i].first_page = (int)total;
+        total += ctx->processes[i].num_pages;
+        if (total > INT_MAX) {
+            fprintf(stderr, "Error: %lld pages are too many for the page table\n", total);
+            exit(1);
         }
     }
-
-    return victim;
+    if (total > ctx->pages_capacity) {
+        free(ctx->pages);
+        ctx->pages = malloc((size_t)total * sizeof(Page));
+        if (ctx->pages == NULL) {
+            fprintf(stderr, "Error: Failed to allocate %lld pages\n", total);
+            exit(1);
+        }
+        ctx->pages_capacity = (int)total;
+    }
+    ctx->num_pages = (int)total;
+    for (int i = 0; i < ctx->num_processes; i++) {
+        ctx->processes[i].pages = ctx->pages + ctx->processes[i].first_page;
+    }
 }
 
-void evict_page(int frame_index) {
-    int proc_id = ram_frames[frame_index].process_id;
-    int page_num = ram_frames[frame_index].page_number;
+void init_memory_system(SimContext *ctx) {
+    // Safety check
+    if (ctx->num_processes == 0) {
+        return;
+    }
+
+    // Use the num_pages configured by user (already set in process
+    // configuration), 3 if not set, up to the maximum per process
+    for (int i = 0; i < ctx->num_processes; i++) {
+        if (ctx->processes[i].num_pages <= 0) {
+            ctx->processes[i].num_pages = 3;
+        }
+        if (ctx->processes[i].num_pages > ctx->max_pages_per_process) {
+            ctx->processes[i].num_pages = ctx->max_pages_per_process;
+        }
+    }
+    alloc_pages(ctx);
 
-    // Find process by id
-    for (int i = 0; i < num_processes; i++) {
-        if (processes[i].id == proc_id) {
-            processes[i].pages[page_num].in_ram = false;
-            processes[i].pages[page_num].frame_index = -1;
-            break;
+    // Initialize all frames as free
+    reset_ram_frames(ctx);
+    memory_history_reset(&ctx->memory_history, ctx->num_frames);
+    ctx->num_page_events = 0;
+    if (ctx->keep_miss_ratio_curve) {
+        miss_ratio_reset(&ctx->miss_ratio_curve, ctx->num_pages);
+    }
+    tlb_init(&ctx->tlb, ctx);
+    ctx->memory_demand = 0;
+    ctx->swapped_head = 0;
+    ctx->num_swapped_out = 0;
+    ctx->swap_outs = 0;
+    free(ctx->swapped_out);
+    ctx->swapped_out = NULL;
+    if (allocation(ctx) != ALLOCATION_GLOBAL) {
+        ctx->swapped_out = malloc((size_t)ctx->num_processes * sizeof(int));
+        if (ctx->swapped_out == NULL) {
+            fprintf(stderr, "Error: Failed to allocate swap-out queue for %d processes\n", ctx->num_processes);
+            exit(1);
+        }
+    }
+
+    // Initialize all processes - start with all pages in DISK
+    for (int i = 0; i < ctx->num_processes; i++) {
+        Process *p = &ctx->processes[i];
+        p->page_faults = 0;
+        p->next_page_to_access = 0;
+        p->exec_units_since_page_access = 0;
+        // Same stream on every run, whatever the policy or the RAM
+        p->access_seed = 2654435761u * (unsigned int)p->id ^ 0x9e3779b9u;
+        if (p->access_seed == 0) p->access_seed = 1;
+        p->last_page = -1;
+        p->readahead_next = 0;
+        p->readahead_size = 0;
+        p->readahead_marker = -1;
+        p->pages_prefetched = 0;
+        p->prefetch_hits = 0;
+        p->tlb_hits = 0;
+        p->tlb_misses = 0;
+        p->resident = (FrameList){-1, -1, 0};
+        p->references = 0;
+        p->ws_head = -1;
+        p->ws_tail = -1;
+        p->ws_size = 0;
+        p->frame_limit = 0;
+        p->last_fault_reference = 0;
+        p->demand = 0;
+        p->reserved = 0;
+
+        for (int pg = 0; pg < p->num_pages; pg++) {
+            p->pages[pg].in_ram = false;
+            p->pages[pg].frame_index = -1;
+            p->pages[pg].ghost = -1;
+            p->pages[pg].last_reference = 0;
+            p->pages[pg].in_working_set = false;
+            p->pages[pg].ws_prev = -1;
+            p->pages[pg].ws_next = -1;
         }
     }
 
-    ram_frames[frame_index].process_id = -1;
-    ram_frames[frame_index].page_number = -1;
+    ctx->current_time_global = 0;
 }
 
-void load_page_to_ram(int process_index, int page_number) {
-    int frame_index = find_free_frame();
+// Top of the free stack, -1 if RAM is full
+int find_free_frame(SimContext *ctx) {
+    return ctx->free_frame_top;
+}
+
+void evict_page(SimContext *ctx, int frame_index) {
+    Frame *frame = &ctx->ram_frames[frame_index];
+    int p = frame->process_index;
+    if (p == -1) return;
+
+    policy(ctx)->on_evict(ctx, frame_index);
+    trace_event(ctx, TRACE_EVICT, ctx->current_time_global, p, frame->page_number);
+    if (frame->prefetched) {
+        // Read ahead for nothing: the process gets a smaller window next time
+        frame->prefetched = false;
+        ctx->processes[p].readahead_size /= 2;
+    }
+    if (allocation(ctx) != ALLOCATION_GLOBAL) resident_unlink(ctx, frame_index);
+    if (frame->page_number >= 0 && frame->page_number < ctx->processes[p].num_pages) {
+        tlb_invalidate(&ctx->tlb, frame->page_number, ctx->processes[p].first_page + frame->page_number);
+        ctx->processes[p].pages[frame->page_number].in_ram = false;
+        ctx->processes[p].pages[frame->page_number].frame_index = -1;
+    }
+
+    frame->process_index = -1;
+    frame->page_number = -1;
+    push_free_frame(ctx, frame_index);
+    if (ctx->keep_memory_history) {
+        memory_history_record(&ctx->memory_history, frame_index, -1, -1);
+    }
+}
+
+void load_page_to_ram(SimContext *ctx, int process_index, int page_number) {
+    // A process at its PFF allocation replaces its own least recently
+    // referenced page
+    const FrameList *resident = &ctx->processes[process_index].resident;
+    if (allocation(ctx) == ALLOCATION_PFF && resident->size > 0 &&
+        resident->size >= ctx->processes[process_index].frame_limit) {
+        evict_page(ctx, resident->head);
+    }
+    int frame_index = pop_free_frame(ctx);
 
     // If no free frame, evict one
     if (frame_index == -1) {
-        if (replacement_policy == POLICY_FIFO) {
-            frame_index = find_victim_frame_fifo();
-        } else {
-            frame_index = find_victim_frame_lru();
-        }
-        evict_page(frame_index);
+        frame_index = policy(ctx)->pick_victim(ctx, process_index, page_number);
+        if (frame_index == -1) return;  // No frames at all
+        evict_page(ctx, frame_index);
+        frame_index = pop_free_frame(ctx);
     }
 
-    // Load page into frame
-    ram_frames[frame_index].process_id = processes[process_index].id;
-    ram_frames[frame_index].page_number = page_number;
-    ram_frames[frame_index].load_time = current_time_global;
-    ram_frames[frame_index].last_access = current_time_global;
+    place_page(ctx, frame_index, process_index, page_number);
+}
+
+// xorshift32 step of the process's access stream
+static unsigned int next_random(Process *p) {
+    unsigned int x = p->access_seed;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    p->access_seed = x;
+    return x;
+}
 
-    processes[process_index].pages[page_number].in_ram = true;
-    processes[process_index].pages[page_number].frame_index = frame_index;
+// Uniform in [0, 1)
+static double next_uniform(Process *p) {
+    return (next_random(p) >> 8) * (1.0 / 16777216.0);
 }
 
-// Check if process needs to be loaded into RAM (causes page fault if in disk)
-bool check_page_fault(int process_index) {
-    if (!memory_enabled) return false;
+// log1p(x) / x and expm1(x) / x, continued to 1 at x = 0
+static double log1p_over(double x) {
+    return fabs(x) > 1e-8 ? log1p(x) / x : 1.0 - x * (0.5 - x * (1.0 / 3.0 - 0.25 * x));
+}
 
-    // Safety check
-    if (processes[process_index].num_pages <= 0) return false;
-
-    // Check if ANY page of this process is already in RAM
-    bool process_in_ram = false;
-    for (int p = 0; p < processes[process_index].num_pages; p++) {
-        if (processes[process_index].pages[p].in_ram) {
-            process_in_ram = true;
-            break;
-        }
+static double expm1_over(double x) {
+    return fabs(x) > 1e-8 ? expm1(x) / x : 1.0 + x * 0.5 * (1.0 + x * (1.0 / 3.0) * (1.0 + 0.25 * x));
+}
+
+// Integral of x^-s and its inverse, the hat function of the Zipf sampler
+static double zipf_h_integral(double x) {
+    double log_x = log(x);
+    return expm1_over((1.0 - ZIPF_EXPONENT) * log_x) * log_x;
+}
+
+static double zipf_h_integral_inverse(double x) {
+    double t = x * (1.0 - ZIPF_EXPONENT);
+    if (t < -1.0) t = -1.0;
+    return exp(log1p_over(t) * x);
+}
+
+static double zipf_h(double x) {
+    return exp(-ZIPF_EXPONENT * log(x));
+}
+
+// Rank 1..n of a Zipf draw by rejection-inversion (Hormann and Derflinger),
+// O(1) expected with no table over the pages
+static int zipf_rank(Process *p, int n) {
+    double h_integral_x1 = zipf_h_integral(1.5) - 1.0;
+    double h_integral_n = zipf_h_integral(n + 0.5);
+    double s = 2.0 - zipf_h_integral_inverse(zipf_h_integral(2.5) - zipf_h(2.0));
+    for (;;) {
+        double u = h_integral_n + next_uniform(p) * (h_integral_x1 - h_integral_n);
+        double x = zipf_h_integral_inverse(u);
+        int k = (int)(x + 0.5);
+        if (k < 1) k = 1;
+        if (k > n) k = n;
+        if (k - x <= s || u >= zipf_h_integral(k + 0.5) - zipf_h(k)) return k;
     }
+}
 
-    // If process is already in RAM, no page fault - just update access time
-    if (process_in_ram) {
-        // Update LRU times for all pages of this process
-        for (int p = 0; p < processes[process_index].num_pages; p++) {
-            if (processes[process_index].pages[p].in_ram) {
-                int frame_idx = processes[process_index].pages[p].frame_index;
-                if (frame_idx >= 0 && frame_idx < TOTAL_RAM_FRAMES) {
-                    ram_frames[frame_idx].last_access = current_time_global;
-                }
+int next_page_reference(SimContext *ctx, int process_index) {
+    Process *p = &ctx->processes[process_index];
+    int n = p->num_pages;
+    if (n <= 1) return 0;
+
+    switch (p->access_pattern) {
+        case ACCESS_STRIDED: {
+            // Every ACCESS_STRIDE-th page, then the same from the next offset
+            int page = p->next_page_to_access;
+            int next = page + ACCESS_STRIDE;
+            if (next >= n) {
+                next = page % ACCESS_STRIDE + 1;
+                if (next >= ACCESS_STRIDE || next >= n) next = 0;
             }
+            p->next_page_to_access = next;
+            return page;
+        }
+        case ACCESS_RANDOM:
+            return (int)(next_random(p) % (unsigned int)n);
+        case ACCESS_ZIPF:
+            return zipf_rank(p, n) - 1;
+        case ACCESS_PHASES: {
+            // Uniform over a window of the pages that moves every phase
+            int window = n / PHASE_WORKING_SET_DIVISOR > 0 ? n / PHASE_WORKING_SET_DIVISOR : 1;
+            if (p->exec_units_since_page_access % PHASE_LENGTH == 0) {
+                p->next_page_to_access = (int)(next_random(p) % (unsigned int)(n - window + 1));
+            }
+            p->exec_units_since_page_access++;
+            return p->next_page_to_access + (int)(next_random(p) % (unsigned int)window);
+        }
+        case ACCESS_SEQUENTIAL:
+        default: {
+            int page = p->next_page_to_access;
+            p->next_page_to_access = (page + 1) % n;
+            return page;
         }
-        return false;
     }
+}
 
-    // Process is in DISK - need to load it (PAGE FAULT!)
-    processes[process_index].page_faults++;
+// Stamp a page the process just referenced or read ahead with its virtual
+// time, making it its most recently referenced. Under the working-set
+// allocation the page joins the working set, and the pages last referenced
+// ws_window references ago leave it and give their frames back.
+static void touch_page(SimContext *ctx, int process_index, int page_number) {
+    Process *p = &ctx->processes[process_index];
+    Page *page = &p->pages[page_number];
+    page->last_reference = p->references;
+    if (page->in_ram) {
+        resident_unlink(ctx, page->frame_index);
+        resident_push(ctx, page->frame_index);
+    }
+    if (allocation(ctx) != ALLOCATION_WORKING_SET) return;
+
+    if (page->in_working_set) working_set_unlink(p, page_number);
+    working_set_push(p, page_number);
+    while (p->pages[p->ws_head].last_reference <= p->references - ctx->ws_window) {
+        int old = p->ws_head;
+        working_set_unlink(p, old);
+        if (p->pages[old].in_ram) evict_page(ctx, p->pages[old].frame_index);
+    }
+}
 
-    // Check if we have enough free frames
-    int free_count = 0;
-    for (int i = 0; i < TOTAL_RAM_FRAMES; i++) {
-        if (ram_frames[i].process_id == -1) {
-            free_count++;
+// Page fault frequency: a fault less than pff_low references after the
+// previous one grants the process another frame, and one more than pff_high
+// references after it takes back the frames of the pages not referenced
+// since (Chu and Opderbeck)
+static void pff_fault(SimContext *ctx, int process_index) {
+    Process *p = &ctx->processes[process_index];
+    int previous = p->last_fault_reference;
+    int interval = p->references - previous;
+    p->last_fault_reference = p->references;
+
+    if (interval < ctx->pff_low) {
+        if (p->frame_limit < ctx->num_frames) p->frame_limit++;
+    } else if (interval > ctx->pff_high) {
+        while (p->resident.head != -1 &&
+               p->pages[ctx->ram_frames[p->resident.head].page_number].last_reference < previous) {
+            evict_page(ctx, p->resident.head);
         }
+        p->frame_limit = p->resident.size + 1;
     }
+    if (p->frame_limit < 1) p->frame_limit = 1;
+}
 
-    // If not enough space, evict another process
-    while (free_count < processes[process_index].num_pages) {
-        // Find process to evict using FIFO or LRU
-        int victim_process_id = -1;
-
-        if (replacement_policy == POLICY_FIFO) {
-            // Find oldest loaded process
-            int oldest_time = current_time_global + 1;
-            for (int i = 0; i < TOTAL_RAM_FRAMES; i++) {
-                if (ram_frames[i].process_id != -1 &&
-                    ram_frames[i].process_id != processes[process_index].id &&
-                    ram_frames[i].load_time < oldest_time) {
-                    oldest_time = ram_frames[i].load_time;
-                    victim_process_id = ram_frames[i].process_id;
-                }
-            }
-        } else {  // LRU
-            // Find least recently used process
-            int oldest_access = current_time_global + 1;
-            for (int i = 0; i < TOTAL_RAM_FRAMES; i++) {
-                if (ram_frames[i].process_id != -1 &&
-                    ram_frames[i].process_id != processes[process_index].id &&
-                    ram_frames[i].last_access < oldest_access) {
-                    oldest_access = ram_frames[i].last_access;
-                    victim_process_id = ram_frames[i].process_id;
-                }
-            }
-        }
+// Count the frames the process needs now in memory_demand: its working set
+// or its PFF allocation, and no less than its reservation
+static void update_demand(SimContext *ctx, int process_index) {
+    Process *p = &ctx->processes[process_index];
+    int demand = allocation(ctx) == ALLOCATION_WORKING_SET ? p->ws_size : p->frame_limit;
+    if (demand >= p->reserved) {
+        p->reserved = 0;
+    } else {
+        demand = p->reserved;
+    }
+    ctx->memory_demand += demand - p->demand;
+    p->demand = demand;
+}
 
-        if (victim_process_id == -1) break;  // No victim found
-
-        // Evict all pages of victim process
-        for (int i = 0; i < TOTAL_RAM_FRAMES; i++) {
-            if (ram_frames[i].process_id == victim_process_id) {
-                // Find the process index
-                for (int p = 0; p < num_processes; p++) {
-                    if (processes[p].id == victim_process_id) {
-                        int page_num = ram_frames[i].page_number;
-                        if (page_num >= 0 && page_num < processes[p].num_pages) {
-                            processes[p].pages[page_num].in_ram = false;
-                            processes[p].pages[page_num].frame_index = -1;
-                        }
-                        break;
-                    }
-                }
-                ram_frames[i].process_id = -1;
-                ram_frames[i].page_number = -1;
-                free_count++;
-            }
-        }
+// Largest readahead window. OPT is the optimum of demand paging, so it never
+// reads ahead.
+static int readahead_limit(const SimContext *ctx) {
+    if (ctx->replacement_policy == POLICY_OPT) return 0;
+    int limit = ctx->num_frames / READAHEAD_RAM_DIVISOR;
+    return ctx->readahead_pages < limit ? ctx->readahead_pages : limit;
+}
+
+// First window of a sequential run, and the next one: 4x while small, then
+// 2x up to the limit (Linux's get_init_ra_size and get_next_ra_size for
+// one-page requests)
+static int initial_window(int limit) {
+    if (limit >= 32) return 4;
+    if (limit >= 4) return 2;
+    return limit;
+}
+
+static int next_window(int size, int limit) {
+    if (size < limit / 16) return 4 * size;
+    if (size <= limit / 2) return 2 * size;
+    return limit;
+}
+
+// Load pages [start, start + size) of the process that are on disk, ahead of
+// their use. The reference of the first one reads the next window, so reads
+// stay a window ahead of a sequential run. The page just referenced is pinned
+// meanwhile: under LFU, Aging or ARC it is often the policy's next victim.
+static void read_ahead(SimContext *ctx, int process_index, int page_number, int start, int size) {
+    Process *p = &ctx->processes[process_index];
+    p->readahead_next = start + size;
+    p->readahead_size = size;
+    p->readahead_marker = size > 0 && start < p->num_pages ? start : -1;
+
+    const Page *referenced = &p->pages[page_number];
+    ctx->replacement.pinned = referenced->in_ram ? referenced->frame_index : -1;
+    int end = start + size < p->num_pages ? start + size : p->num_pages;
+    for (int pg = start; pg < end; pg++) {
+        if (p->pages[pg].in_ram) continue;
+        // Within the PFF allocation, so a window never replaces the process's own pages
+        if (allocation(ctx) == ALLOCATION_PFF && p->resident.size >= p->frame_limit) break;
+        load_page_to_ram(ctx, process_index, pg);
+        if (!p->pages[pg].in_ram) break;
+        ctx->ram_frames[p->pages[pg].frame_index].prefetched = true;
+        p->pages_prefetched++;
+        if (allocation(ctx) != ALLOCATION_GLOBAL) touch_page(ctx, process_index, pg);
     }
+    ctx->replacement.pinned = -1;
+}
+
+// Readahead after a reference, like Linux's ondemand readahead: a fault that
+// continues a sequential run (or starts at page 0) reads a window past it,
+// growing on every window, and any other fault turns readahead off until
+// the next sequential one
+static void update_readahead(SimContext *ctx, int process_index, int page_number, bool fault) {
+    Process *p = &ctx->processes[process_index];
+    int limit = readahead_limit(ctx);
+    bool sequential = page_number == p->last_page + 1 || page_number == 0;
+    p->last_page = page_number;
+    if (limit <= 0) return;
+
+    if (page_number == p->readahead_marker && sequential) {
+        int size = p->readahead_size > 0 ? next_window(p->readahead_size, limit) : initial_window(limit);
+        read_ahead(ctx, process_index, page_number, p->readahead_next, size);
+    } else if (fault && sequential) {
+        int size = p->readahead_size > 0 ? next_window(p->readahead_size, limit) : initial_window(limit);
+        read_ahead(ctx, process_index, page_number, page_number + 1, size);
+    } else if (fault) {
+        p->readahead_size = 0;
+        p->readahead_marker = -1;
+    }
+}
+
+bool reference_page(SimContext *ctx, int process_index, int page_number) {
+    Process *p = &ctx->processes[process_index];
+    if (page_number < 0 || page_number >= p->num_pages) return false;
 
-    // Load all pages of current process into RAM
-    int loaded = 0;
-    for (int i = 0; i < TOTAL_RAM_FRAMES && loaded < processes[process_index].num_pages; i++) {
-        if (ram_frames[i].process_id == -1) {
-            ram_frames[i].process_id = processes[process_index].id;
-            ram_frames[i].page_number = loaded;
-            ram_frames[i].load_time = current_time_global;
-            ram_frames[i].last_access = current_time_global;
+    if (ctx->keep_page_events) push_page_event(ctx, process_index, page_number);
+    if (ctx->keep_miss_ratio_curve) {
+        miss_ratio_reference(&ctx->miss_ratio_curve, p->first_page + page_number);
+    }
 
-            processes[process_index].pages[loaded].in_ram = true;
-            processes[process_index].pages[loaded].frame_index = i;
-            loaded++;
+    Page *page = &p->pages[page_number];
+    bool fault = !page->in_ram;
+    bool bounded = allocation(ctx) != ALLOCATION_GLOBAL;
+    p->references++;
+    if (bounded) touch_page(ctx, process_index, page_number);
+    if (fault) {
+        // Bring in the page, evicting the policy's victim if RAM is full
+        p->page_faults++;
+        trace_event(ctx, TRACE_FAULT, ctx->current_time_global, process_index, page_number);
+        if (allocation(ctx) == ALLOCATION_PFF) pff_fault(ctx, process_index);
+        load_page_to_ram(ctx, process_index, page_number);
+    } else {
+        Frame *frame = &ctx->ram_frames[page->frame_index];
+        frame->last_access = ctx->current_time_global;
+        if (frame->prefetched) {
+            frame->prefetched = false;
+            p->prefetch_hits++;
         }
+        policy(ctx)->on_access(ctx, page->frame_index);
     }
+    ctx->replacement.reference++;
+    if (ctx->tlb.entries > 0) {
+        // A fault misses too: the page had no translation to cache
+        if (tlb_lookup(&ctx->tlb, p->cpu, page_number, p->first_page + page_number)) {
+            p->tlb_hits++;
+        } else {
+            p->tlb_misses++;
+        }
+    }
+    update_readahead(ctx, process_index, page_number, fault);
+    if (bounded) update_demand(ctx, process_index);
+    return fault;
+}
 
-    return true;  // Page fault occurred
+void release_process_memory(SimContext *ctx, int process_index, int time) {
+    if (allocation(ctx) == ALLOCATION_GLOBAL) return;
+    ctx->current_time_global = time;
+    if (ctx->keep_memory_history) memory_history_advance(&ctx->memory_history, time);
+    Process *p = &ctx->processes[process_index];
+    while (p->resident.head != -1) evict_page(ctx, p->resident.head);
+    while (p->ws_head != -1) working_set_unlink(p, p->ws_head);
+    p->frame_limit = 0;
+    p->reserved = 0;
+    ctx->memory_demand -= p->demand;
+    p->demand = 0;
 }
 
-int count_pages_in_ram(int process_index) {
+bool memory_overcommitted(const SimContext *ctx, int process_index) {
+    if (allocation(ctx) == ALLOCATION_GLOBAL) return false;
+    int others = ctx->memory_demand - ctx->processes[process_index].demand;
+    return ctx->memory_demand > ctx->num_frames && others > 0;
+}
+
+void swap_out_process(SimContext *ctx, int process_index, int time) {
+    int demand = ctx->processes[process_index].demand;
+    release_process_memory(ctx, process_index, time);
+    ctx->processes[process_index].reserved = demand;
+
+    int slot = (ctx->swapped_head + ctx->num_swapped_out) % ctx->num_processes;
+    ctx->swapped_out[slot] = process_index;
+    ctx->num_swapped_out++;
+    ctx->swap_outs++;
+}
+
+int swap_in_process(SimContext *ctx) {
+    if (ctx->num_swapped_out == 0) return -1;
+    int i = ctx->swapped_out[ctx->swapped_head];
+    Process *p = &ctx->processes[i];
+    if (ctx->memory_demand > 0 && ctx->memory_demand + p->reserved > ctx->num_frames) return -1;
+
+    ctx->swapped_head = (ctx->swapped_head + 1) % ctx->num_processes;
+    ctx->num_swapped_out--;
+    ctx->memory_demand += p->reserved;
+    p->demand = p->reserved;
+    return i;
+}
+
+int count_pages_in_ram(SimContext *ctx, int process_index) {
     int count = 0;
-    for (int p = 0; p < processes[process_index].num_pages; p++) {
-        if (processes[process_index].pages[p].in_ram) {
+    for (int p = 0; p < ctx->processes[process_index].num_pages; p++) {
+        if (ctx->processes[process_index].pages[p].in_ram) {
             count++;
         }
     }
     return count;
 }
 
-int count_pages_in_disk(int process_index) {
-    return processes[process_index].num_pages - count_pages_in_ram(process_index);
+int count_pages_in_disk(SimContext *ctx, int process_index) {
+    return ctx->processes[process_index].num_pages - count_pages_in_ram(ctx, process_index);
 }
 
-void save_memory_state(int time_unit) {
-    if (!memory_enabled || time_unit < 0 || time_unit >= MAX_HISTORY_SIZE) {
-        return;
+int replay_page_faults(const SimContext *ctx, ReplacementPolicy replacement_policy, int *process_faults) {
+    SimContext *replay = sim_context_create();
+    sim_context_copy_workload(replay, ctx);
+    replay->memory_enabled = true;
+    replay->replacement_policy = replacement_policy;
+    replay->readahead_pages = 0;
+    replay->tlb_entries = 0;
+    replay->keep_page_events = false;
+    init_memory_system(replay);
+    if (replacement_policy == POLICY_OPT) {
+        replacement_plan_opt(replay, ctx->page_events, ctx->num_page_events);
     }
 
-    // Save current RAM state to history
-    for (int i = 0; i < TOTAL_RAM_FRAMES; i++) {
-        ram_history[time_unit][i].process_id = ram_frames[i].process_id;
-        ram_history[time_unit][i].page_number = ram_frames[i].page_number;
+    for (int e = 0; e < ctx->num_page_events; e++) {
+        const PageEvent *event = &ctx->page_events[e];
+        replay->current_time_global = event->time;
+        reference_page(replay, event->process_index, event->page_number);
     }
 
-    history_initialized = true;
+    int page_faults = 0;
+    for (int i = 0; i < replay->num_processes; i++) {
+        page_faults += replay->processes[i].page_faults;
+        if (process_faults != NULL) process_faults[i] = replay->processes[i].page_faults;
+    }
+    sim_context_destroy(replay);
+    return page_faults;
 }
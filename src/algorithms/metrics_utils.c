@@ -1,155 +1,193 @@
 #include "../../include/globals.h"
+#include "../../include/metrics_utils.h"
+#include <limits.h>
+#include <stdlib.h>
 
-// Compute metrics for every process based on its timeline
-void compute_metrics_for_all() {
+// Compute metrics for every process from the statistics the engine
+// accumulated during the run
+void compute_metrics_for_all(SimContext *ctx) {
     // Reset metrics flag
-    metrics_computed = false;
+    ctx->metrics_computed = false;
 
-    for (int i = 0; i < num_processes; i++) {
+    for (int i = 0; i < ctx->num_processes; i++) {
         // Basic copies
-        processes[i].metrics[MI_ARRIVAL] = processes[i].arrival_time;
-        processes[i].metrics[MI_EXECUTION] = processes[i].execution_time;
-        processes[i].metrics[MI_DEADLINE] = processes[i].deadline;
-        processes[i].metrics[MI_PRIORITY] = processes[i].priority;
-        processes[i].metrics[MI_PAGE_FAULTS] = processes[i].page_faults;
-
-        // Safety check: ensure timeline is allocated
-        if (!processes[i].timeline) {
-            processes[i].metrics[MI_START] = -1;
-            processes[i].metrics[MI_END] = -1;
-            processes[i].metrics[MI_WAIT] = 0;
-            processes[i].metrics[MI_TURNAROUND] = 0;
-            processes[i].metrics[MI_DEADLINE_OK] = 0;
-            processes[i].final_status = PS_PENDING;
-            continue;
-        }
-
-        int start = -1;
-        int last_exec = -1;
-        int wait_count = 0;
-        for (int t = 0; t < TOTAL_TIME; t++) {
-            ProcessState st = processes[i].timeline[t];
-            if ((st == EXECUTING) || (st == DEADLINE_MISSED)) {
-                if (start == -1) start = t;
-                last_exec = t;
-            }
-            if (st == WAITING) {
-                wait_count++;
-            }
-        }
+        ctx->processes[i].metrics[MI_ARRIVAL] = ctx->processes[i].arrival_time;
+        ctx->processes[i].metrics[MI_EXECUTION] = ctx->processes[i].execution_time;
+        ctx->processes[i].metrics[MI_DEADLINE] = ctx->processes[i].deadline;
+        ctx->processes[i].metrics[MI_PRIORITY] = ctx->processes[i].priority;
+        ctx->processes[i].metrics[MI_PAGE_FAULTS] = ctx->processes[i].page_faults;
+        ctx->processes[i].metrics[MI_PREFETCH_HITS] = ctx->processes[i].prefetch_hits;
+        ctx->processes[i].metrics[MI_PREFETCH_WASTED] =
+            ctx->processes[i].pages_prefetched - ctx->processes[i].prefetch_hits;
+        ctx->processes[i].metrics[MI_FAULTS_SAVED] = 0;  // set from a replay by run_current_algorithm
+        int tlb_hits = ctx->processes[i].tlb_hits;
+        long long tlb_lookups = (long long)tlb_hits + ctx->processes[i].tlb_misses;
+        long long tlb_stall = (long long)ctx->processes[i].tlb_misses * TLB_MISS_CYCLES;
+        ctx->processes[i].metrics[MI_TLB_HIT_RATE] = tlb_lookups > 0 ? (int)((tlb_hits * 100LL + tlb_lookups / 2) / tlb_lookups) : 0;
+        ctx->processes[i].metrics[MI_TLB_STALL] = tlb_stall > INT_MAX ? INT_MAX : (int)tlb_stall;
+
+        // Swapped out is waiting too, for memory rather than a CPU
+        int start = ctx->processes[i].first_exec;
+        int wait_count = ctx->processes[i].wait_ticks;
 
         int end_time = -1;
-        if (last_exec != -1) end_time = last_exec + 1; // End as exclusive time
+        if (ctx->processes[i].last_exec_end != -1) end_time = ctx->processes[i].last_exec_end; // End as exclusive time
 
         // Ajuste temporário: reduzir 1 (resultado pedagógico pedido: incrementar depois)
         if (end_time != -1) end_time = end_time - 1;
 
-        processes[i].metrics[MI_START] = (start == -1) ? -1 : start;
-        processes[i].metrics[MI_END] = end_time;
-        processes[i].metrics[MI_WAIT] = wait_count;
+        ctx->processes[i].metrics[MI_START] = (start == -1) ? -1 : start;
+        ctx->processes[i].metrics[MI_END] = end_time;
+        ctx->processes[i].metrics[MI_WAIT] = wait_count;
 
         int turnaround = 0;
         if (end_time != -1) {
-            turnaround = (end_time - processes[i].arrival_time) + 1; // Add +1 as requested
+            turnaround = (end_time - ctx->processes[i].arrival_time) + 1; // Add +1 as requested
             if (turnaround < 0) turnaround = 0; // Protect against negative values
         }
-        processes[i].metrics[MI_TURNAROUND] = turnaround;
+        ctx->processes[i].metrics[MI_TURNAROUND] = turnaround;
 
         int deadline_ok = 0;
         if (end_time != -1) {
             // Deadline is relative to arrival_time (as used in EDF)
-            if (turnaround <= processes[i].deadline) {
+            if (turnaround <= ctx->processes[i].deadline) {
                 deadline_ok = 1;
-                processes[i].final_status = PS_COMPLETED_ON_TIME;
+                ctx->processes[i].final_status = PS_COMPLETED_ON_TIME;
             } else {
                 deadline_ok = 0;
-                processes[i].final_status = PS_DEADLINE_MISSED;
+                ctx->processes[i].final_status = PS_DEADLINE_MISSED;
             }
         } else {
-            processes[i].final_status = PS_PENDING;
+            ctx->processes[i].final_status = PS_PENDING;
         }
-        processes[i].metrics[MI_DEADLINE_OK] = deadline_ok;
+        ctx->processes[i].metrics[MI_DEADLINE_OK] = deadline_ok;
     }
 
-    metrics_computed = true;
+    ctx->metrics_computed = true;
+}
+
+// Number of maximal stretches of ticks in [0, sim_end) during which some
+// process is in OVERHEAD on a CPU. Touching or overlapping runs on the same
+// CPU count once. Every period the engine counted starts before sim_end;
+// of the late ones, only those before a fallback sim_end do.
+static int count_overhead_periods(const SimContext *ctx, int sim_end) {
+    int periods = ctx->switch_periods;
+    for (int k = 0; k < ctx->num_late_switches; k++) {
+        if (ctx->late_switches[k] < sim_end) periods++;
+    }
+    return periods;
+}
+
+// Share of [0, sim_end) each CPU spent executing a process. Only the
+// latest executed run of a CPU can reach past sim_end, by its last tick.
+static void compute_cpu_utilization(SimContext *ctx, int sim_end) {
+    for (int c = 0; c < ctx->num_cpus; c++) {
+        const CpuStats *cpu = &ctx->cpu_stats[c];
+        long long busy = cpu->busy;
+        if (cpu->exec_end > sim_end) busy -= cpu->exec_end - sim_end;
+        ctx->summary_stats.cpu_utilization[c] = sim_end > 0 ? busy * 100.0 / sim_end : 0.0;
+    }
 }
 
 // Compute summary statistics for the entire simulation
-void compute_summary_stats() {
+void compute_summary_stats(SimContext *ctx) {
     // Initialize summary stats
-    summary_stats.avg_arrival = 0;
-    summary_stats.avg_execution = 0;
-    summary_stats.avg_wait = 0;
-    summary_stats.avg_turnaround = 0;
-    summary_stats.throughput = 0;
-    summary_stats.idle_percentage = 0;
-    summary_stats.context_switches = 0;
+    ctx->summary_stats.avg_arrival = 0;
+    ctx->summary_stats.avg_execution = 0;
+    ctx->summary_stats.avg_wait = 0;
+    ctx->summary_stats.avg_turnaround = 0;
+    ctx->summary_stats.throughput = 0;
+    ctx->summary_stats.idle_percentage = 0;
+    ctx->summary_stats.context_switches = 0;
+    ctx->summary_stats.migrations = ctx->migrations;
+    ctx->summary_stats.num_cpus = ctx->num_cpus;
+    for (int c = 0; c < MAX_CPUS; c++) {
+        ctx->summary_stats.cpu_utilization[c] = 0;
+    }
+    ctx->summary_stats.page_faults = 0;
+    for (int i = 0; i < ctx->num_processes && ctx->memory_enabled; i++) {
+        ctx->summary_stats.page_faults += ctx->processes[i].page_faults;
+    }
+    // Run under OPT itself until replayed
+    ctx->summary_stats.opt_page_faults = ctx->summary_stats.page_faults;
+    ctx->summary_stats.avg_fault_wait = 0;
+    ctx->summary_stats.swap_outs = ctx->memory_enabled ? ctx->swap_outs : 0;
+
+    // Translation cost, and how much of it the flushes on context switches add
+    long long tlb_hits = 0;
+    long long tlb_misses = 0;
+    for (int i = 0; i < ctx->num_processes && ctx->memory_enabled; i++) {
+        tlb_hits += ctx->processes[i].tlb_hits;
+        tlb_misses += ctx->processes[i].tlb_misses;
+    }
+    ctx->summary_stats.tlb_hit_rate = tlb_hits + tlb_misses > 0 ? tlb_hits * 100.0 / (tlb_hits + tlb_misses) : 0;
+    ctx->summary_stats.tlb_stall_cycles = tlb_misses * TLB_MISS_CYCLES;
+    const Tlb *tlb = &ctx->tlb;
+    ctx->summary_stats.switch_stall_cycles =
+        ctx->memory_enabled && tlb->flushes > 0 ? (tlb->misses - tlb->shadow_misses) * (double)TLB_MISS_CYCLES / tlb->flushes : 0;
 
-    if (num_processes == 0) return;
+    if (ctx->num_processes == 0) return;
 
     // Calculate averages
-    int total_execution = 0;
-    int total_wait = 0;
-    int total_turnaround = 0;
+    long long total_execution = 0;
+    long long total_wait = 0;
+    long long total_turnaround = 0;
     int completed_count = 0;
 
-    for (int i = 0; i < num_processes; i++) {
-        summary_stats.avg_arrival += processes[i].metrics[MI_ARRIVAL];
-        total_execution += processes[i].metrics[MI_EXECUTION];
-        total_wait += processes[i].metrics[MI_WAIT];
-        total_turnaround += processes[i].metrics[MI_TURNAROUND];
-        if (processes[i].metrics[MI_END] > 0) {
+    for (int i = 0; i < ctx->num_processes; i++) {
+        ctx->summary_stats.avg_arrival += ctx->processes[i].metrics[MI_ARRIVAL];
+        total_execution += ctx->processes[i].metrics[MI_EXECUTION];
+        total_wait += ctx->processes[i].metrics[MI_WAIT];
+        total_turnaround += ctx->processes[i].metrics[MI_TURNAROUND];
+        if (ctx->processes[i].metrics[MI_END] > 0) {
             completed_count++;
         }
     }
 
-    summary_stats.avg_arrival /= num_processes;
-    summary_stats.avg_execution = total_execution / (double)num_processes;
-    summary_stats.avg_wait = total_wait / (double)num_processes;
-    summary_stats.avg_turnaround = total_turnaround / (double)num_processes;
+    ctx->summary_stats.avg_arrival /= ctx->num_processes;
+    ctx->summary_stats.avg_execution = total_execution / (double)ctx->num_processes;
+    ctx->summary_stats.avg_wait = total_wait / (double)ctx->num_processes;
+    ctx->summary_stats.avg_turnaround = total_turnaround / (double)ctx->num_processes;
+
+    // Ticks spent blocked on page reads, including the trap tick of each fault
+    long long total_fault_wait = 0;
+    for (int i = 0; i < ctx->num_processes; i++) {
+        total_fault_wait += ctx->processes[i].fault_wait_ticks;
+    }
+    ctx->summary_stats.avg_fault_wait = total_fault_wait / (double)ctx->num_processes;
 
     // Determine simulation end time as the latest process end (fallback to TOTAL_TIME)
     int sim_end = 0;
-    for (int i = 0; i < num_processes; i++) {
-        int endt = processes[i].metrics[MI_END];
+    for (int i = 0; i < ctx->num_processes; i++) {
+        int endt = ctx->processes[i].metrics[MI_END];
         if (endt > sim_end) sim_end = endt;
     }
-    if (sim_end <= 0) sim_end = TOTAL_TIME;
+    if (sim_end <= 0) sim_end = ctx->total_time;
 
     // Throughput: number of processes divided by simulation total time
     if (sim_end > 0) {
-        summary_stats.throughput = num_processes / (double)sim_end;
+        ctx->summary_stats.throughput = ctx->num_processes / (double)sim_end;
     } else {
-        summary_stats.throughput = 0;
+        ctx->summary_stats.throughput = 0;
     }
 
     // Count context switch events: count the number of times an OVERHEAD period starts
-    summary_stats.context_switches = 0;
-    bool prev_overhead = false;
-    for (int t = 0; t < sim_end; t++) {
-        bool has_overhead = false;
-        for (int i = 0; i < num_processes; i++) {
-            if (processes[i].timeline && processes[i].timeline[t] == OVERHEAD) {
-                has_overhead = true;
-                break;
-            }
-        }
-        if (has_overhead && !prev_overhead) {
-            summary_stats.context_switches++;
-        }
-        prev_overhead = has_overhead;
-    }
+    ctx->summary_stats.context_switches = count_overhead_periods(ctx, sim_end);
 
     // Calculate idle percentage using total useful time + overhead time
     // Total useful execution time is sum of declared execution times (total_execution)
-    double time_sobrecarga = summary_stats.context_switches * (double)overhead_time;
+    // The capacity is sim_end ticks on each CPU
+    double time_sobrecarga = ctx->summary_stats.context_switches * (double)ctx->overhead_time;
     double total_non_idle = total_execution + time_sobrecarga;
+    double capacity = sim_end * (double)ctx->num_cpus;
 
     double idle_pct = 0.0;
     if (sim_end > 0) {
-        double idle_time = sim_end - total_non_idle;
+        double idle_time = capacity - total_non_idle;
         if (idle_time < 0) idle_time = 0;
-        idle_pct = (idle_time / (double)sim_end) * 100.0;
+        idle_pct = (idle_time / capacity) * 100.0;
     }
-    summary_stats.idle_percentage = idle_pct;
+    ctx->summary_stats.idle_percentage = idle_pct;
+
+    compute_cpu_utilization(ctx, sim_end);
 }
@@ -0,0 +1,585 @@
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "../../include/replacement.h"
+
+// Bits of the Aging shift register: a page unused for this many ticks has age 0
+#define AGING_BITS 8
+// WSClock working set window (tau), in ticks
+#define WSCLOCK_WINDOW 20
+
+// ---------------------------------------------------------------------------
+// Intrusive lists, over frames or ARC ghost entries
+
+typedef FrameLink *(*LinkOf)(SimContext *ctx, int index);
+
+static FrameLink *frame_link(SimContext *ctx, int index) {
+    return &ctx->ram_frames[index].link;
+}
+
+static FrameLink *ghost_link(SimContext *ctx, int index) {
+    return &ctx->replacement.ghosts[index].link;
+}
+
+static void list_append(SimContext *ctx, FrameList *list, int index, LinkOf link_of) {
+    FrameLink *link = link_of(ctx, index);
+    link->prev = list->tail;
+    link->next = -1;
+    if (list->tail != -1) {
+        link_of(ctx, list->tail)->next = index;
+    } else {
+        list->head = index;
+    }
+    list->tail = index;
+    list->size++;
+}
+
+static void list_unlink(SimContext *ctx, FrameList *list, int index, LinkOf link_of) {
+    FrameLink *link = link_of(ctx, index);
+    if (link->prev != -1) {
+        link_of(ctx, link->prev)->next = link->next;
+    } else {
+        list->head = link->next;
+    }
+    if (link->next != -1) {
+        link_of(ctx, link->next)->prev = link->prev;
+    } else {
+        list->tail = link->prev;
+    }
+    link->prev = link->next = -1;
+    list->size--;
+}
+
+// ---------------------------------------------------------------------------
+// Min-heap of frames for Aging and LFU, ordered by a policy comparison
+
+typedef bool (*FrameBefore)(SimContext *ctx, int a, int b);
+
+static void heap_place(ReplacementState *r, Frame *frames, int pos, int frame_index) {
+    r->heap[pos] = frame_index;
+    frames[frame_index].heap_pos = pos;
+}
+
+static void heap_sift_up(SimContext *ctx, int pos, FrameBefore before) {
+    ReplacementState *r = &ctx->replacement;
+    int frame_index = r->heap[pos];
+    while (pos > 0) {
+        int parent = (pos - 1) / 2;
+        if (!before(ctx, frame_index, r->heap[parent])) break;
+        heap_place(r, ctx->ram_frames, pos, r->heap[parent]);
+        pos = parent;
+    }
+    heap_place(r, ctx->ram_frames, pos, frame_index);
+}
+
+static void heap_sift_down(SimContext *ctx, int pos, FrameBefore before) {
+    ReplacementState *r = &ctx->replacement;
+    int frame_index = r->heap[pos];
+    for (;;) {
+        int child = 2 * pos + 1;
+        if (child >= r->heap_size) break;
+        if (child + 1 < r->heap_size && before(ctx, r->heap[child + 1], r->heap[child])) child++;
+        if (!before(ctx, r->heap[child], frame_index)) break;
+        heap_place(r, ctx->ram_frames, pos, r->heap[child]);
+        pos = child;
+    }
+    heap_place(r, ctx->ram_frames, pos, frame_index);
+}
+
+static void heap_push(SimContext *ctx, int frame_index, FrameBefore before) {
+    ReplacementState *r = &ctx->replacement;
+    heap_place(r, ctx->ram_frames, r->heap_size++, frame_index);
+    heap_sift_up(ctx, r->heap_size - 1, before);
+}
+
+static void heap_remove(SimContext *ctx, int frame_index, FrameBefore before) {
+    ReplacementState *r = &ctx->replacement;
+    int pos = ctx->ram_frames[frame_index].heap_pos;
+    int last = r->heap[--r->heap_size];
+    ctx->ram_frames[frame_index].heap_pos = -1;
+    if (pos == r->heap_size) return;
+    heap_place(r, ctx->ram_frames, pos, last);
+    heap_sift_up(ctx, pos, before);
+    heap_sift_down(ctx, ctx->ram_frames[last].heap_pos, before);
+}
+
+// Reorder a frame whose key changed
+static void heap_update(SimContext *ctx, int frame_index, FrameBefore before) {
+    heap_sift_up(ctx, ctx->ram_frames[frame_index].heap_pos, before);
+    heap_sift_down(ctx, ctx->ram_frames[frame_index].heap_pos, before);
+}
+
+// Current tick as seen by the policies. The replays of a page event log start
+// over at tick 0, so the clock only follows current_time_global forward.
+static int policy_time(SimContext *ctx) {
+    if (ctx->current_time_global > ctx->replacement.clock) {
+        ctx->replacement.clock = ctx->current_time_global;
+    }
+    return ctx->replacement.clock;
+}
+
+static int resident_frames(SimContext *ctx) {
+    return ctx->num_frames - ctx->free_frame_count;
+}
+
+// Resident frames a victim may come from
+static int pickable_frames(SimContext *ctx) {
+    return resident_frames(ctx) - (ctx->replacement.pinned != -1);
+}
+
+// ---------------------------------------------------------------------------
+// FIFO: evict the page loaded first
+
+static void fifo_on_load(SimContext *ctx, int frame_index) {
+    list_append(ctx, &ctx->replacement.list, frame_index, frame_link);
+}
+
+static void fifo_on_access(SimContext *ctx, int frame_index) {
+    (void)ctx;
+    (void)frame_index;
+}
+
+static int list_pick_victim(SimContext *ctx, int process_index, int page_number) {
+    (void)process_index;
+    (void)page_number;
+    int head = ctx->replacement.list.head;
+    return head != -1 && head == ctx->replacement.pinned ? ctx->ram_frames[head].link.next : head;
+}
+
+static void list_on_evict(SimContext *ctx, int frame_index) {
+    list_unlink(ctx, &ctx->replacement.list, frame_index, frame_link);
+}
+
+// ---------------------------------------------------------------------------
+// LRU: evict the page used least recently
+
+static void lru_on_access(SimContext *ctx, int frame_index) {
+    list_unlink(ctx, &ctx->replacement.list, frame_index, frame_link);
+    list_append(ctx, &ctx->replacement.list, frame_index, frame_link);
+}
+
+// ---------------------------------------------------------------------------
+// CLOCK (second chance): the hand sweeps the frames, clearing reference bits,
+// and stops at the first resident page that was not used since its last pass
+
+static void clock_on_load(SimContext *ctx, int frame_index) {
+    ctx->ram_frames[frame_index].referenced = true;
+}
+
+static void clock_on_access(SimContext *ctx, int frame_index) {
+    ctx->ram_frames[frame_index].referenced = true;
+}
+
+static int clock_advance(SimContext *ctx) {
+    int frame_index = ctx->replacement.clock_hand;
+    ctx->replacement.clock_hand = (frame_index + 1) % ctx->num_frames;
+    return frame_index;
+}
+
+static int clock_pick_victim(SimContext *ctx, int process_index, int page_number) {
+    (void)process_index;
+    (void)page_number;
+    if (pickable_frames(ctx) == 0) return -1;
+
+    // At most two laps: the first one clears every bit it passes
+    for (;;) {
+        int frame_index = clock_advance(ctx);
+        Frame *frame = &ctx->ram_frames[frame_index];
+        if (frame->process_index == -1 || frame_index == ctx->replacement.pinned) continue;
+        if (!frame->referenced) return frame_index;
+        frame->referenced = false;
+    }
+}
+
+static void clock_on_evict(SimContext *ctx, int frame_index) {
+    ctx->ram_frames[frame_index].referenced = false;
+}
+
+// ---------------------------------------------------------------------------
+// WSClock: CLOCK over the working set. A page not referenced since the last
+// pass is only evicted once it is older than the window; if every page is in
+// the working set, the oldest unreferenced one goes.
+
+static int wsclock_pick_victim(SimContext *ctx, int process_index, int page_number) {
+    if (pickable_frames(ctx) == 0) return -1;
+    int now = policy_time(ctx);
+
+    int oldest = -1;
+    for (int scanned = 0; scanned < ctx->num_frames; scanned++) {
+        int frame_index = clock_advance(ctx);
+        Frame *frame = &ctx->ram_frames[frame_index];
+        if (frame->process_index == -1 || frame_index == ctx->replacement.pinned) continue;
+        if (frame->referenced) {
+            frame->referenced = false;
+            continue;
+        }
+        if (now - frame->last_access > WSCLOCK_WINDOW) return frame_index;
+        if (oldest == -1 || frame->last_access < ctx->ram_frames[oldest].last_access) {
+            oldest = frame_index;
+        }
+    }
+    if (oldest != -1) return oldest;
+
+    // Every page was referenced during the lap; their bits are clear now
+    return clock_pick_victim(ctx, process_index, page_number);
+}
+
+// ---------------------------------------------------------------------------
+// Aging: every tick shifts a page's register right and sets the top bit if the
+// page was used; the page with the smallest register goes. Registers are
+// shifted lazily, when touched or compared. Shifting every register by the
+// same amount never reorders them, so the heap stays valid as time passes.
+
+static unsigned int aged(const Frame *frame, int now) {
+    int shift = now - frame->age_time;
+    return shift >= AGING_BITS ? 0 : frame->age >> shift;
+}
+
+static bool aging_before(SimContext *ctx, int a, int b) {
+    int now = ctx->replacement.clock;
+    return aged(&ctx->ram_frames[a], now) < aged(&ctx->ram_frames[b], now);
+}
+
+static void aging_reference(SimContext *ctx, int frame_index) {
+    Frame *frame = &ctx->ram_frames[frame_index];
+    int now = policy_time(ctx);
+    frame->age = aged(frame, now) | 1u << (AGING_BITS - 1);
+    frame->age_time = now;
+}
+
+static void aging_on_load(SimContext *ctx, int frame_index) {
+    ctx->ram_frames[frame_index].age = 0;
+    ctx->ram_frames[frame_index].age_time = policy_time(ctx);
+    aging_reference(ctx, frame_index);
+    heap_push(ctx, frame_index, aging_before);
+}
+
+static void aging_on_access(SimContext *ctx, int frame_index) {
+    aging_reference(ctx, frame_index);
+    heap_sift_down(ctx, ctx->ram_frames[frame_index].heap_pos, aging_before);
+}
+
+// Top of the heap, or the better of its children if the top is pinned
+static int heap_victim(SimContext *ctx, FrameBefore before) {
+    const ReplacementState *r = &ctx->replacement;
+    policy_time(ctx);
+    if (r->heap_size == 0) return -1;
+    if (r->heap[0] != r->pinned) return r->heap[0];
+    int victim = r->heap_size > 1 ? r->heap[1] : -1;
+    if (r->heap_size > 2 && before(ctx, r->heap[2], victim)) victim = r->heap[2];
+    return victim;
+}
+
+static int aging_pick_victim(SimContext *ctx, int process_index, int page_number) {
+    (void)process_index;
+    (void)page_number;
+    return heap_victim(ctx, aging_before);
+}
+
+static void aging_on_evict(SimContext *ctx, int frame_index) {
+    heap_remove(ctx, frame_index, aging_before);
+}
+
+// ---------------------------------------------------------------------------
+// LFU: evict the page referenced the fewest times since it was loaded, the
+// least recently used one among equals
+
+static bool lfu_before(SimContext *ctx, int a, int b) {
+    const Frame *fa = &ctx->ram_frames[a];
+    const Frame *fb = &ctx->ram_frames[b];
+    if (fa->frequency != fb->frequency) return fa->frequency < fb->frequency;
+    return fa->last_use < fb->last_use;
+}
+
+static void lfu_on_load(SimContext *ctx, int frame_index) {
+    ctx->ram_frames[frame_index].frequency = 1;
+    ctx->ram_frames[frame_index].last_use = ++ctx->replacement.uses;
+    heap_push(ctx, frame_index, lfu_before);
+}
+
+static void lfu_on_access(SimContext *ctx, int frame_index) {
+    ctx->ram_frames[frame_index].frequency++;
+    ctx->ram_frames[frame_index].last_use = ++ctx->replacement.uses;
+    heap_sift_down(ctx, ctx->ram_frames[frame_index].heap_pos, lfu_before);
+}
+
+static int lfu_pick_victim(SimContext *ctx, int process_index, int page_number) {
+    (void)process_index;
+    (void)page_number;
+    return heap_victim(ctx, lfu_before);
+}
+
+static void lfu_on_evict(SimContext *ctx, int frame_index) {
+    heap_remove(ctx, frame_index, lfu_before);
+}
+
+// ---------------------------------------------------------------------------
+// ARC (Megiddo and Modha): T1 holds pages referenced once since they were
+// loaded, T2 pages referenced again; B1 and B2 remember pages recently evicted from
+// each. A miss on a B1 page grows the target size of T1, a miss on a B2 page
+// shrinks it, and victims come from T1 while it is above its target.
+// The target adapts before the victim is picked (REPLACE in the paper), and
+// only complete misses trim the ghost lists, so a ghost is never dropped by
+// the eviction made for its own page.
+
+static FrameList *arc_list(SimContext *ctx, int frame_index) {
+    return ctx->ram_frames[frame_index].frequent ? &ctx->replacement.frequent : &ctx->replacement.list;
+}
+
+// Ghost entry of a page, -1 if it was not evicted recently
+static int arc_find_ghost(SimContext *ctx, int process_index, int page_number) {
+    int g = ctx->processes[process_index].pages[page_number].ghost;
+    const ReplacementState *r = &ctx->replacement;
+    if (g < 0 || g >= r->ghosts_capacity) return -1;
+    if (r->ghosts[g].process_index != process_index || r->ghosts[g].page_number != page_number) return -1;
+    return g;
+}
+
+static void arc_drop_ghost(SimContext *ctx, int g) {
+    ReplacementState *r = &ctx->replacement;
+    GhostPage *ghost = &r->ghosts[g];
+    list_unlink(ctx, ghost->frequent ? &r->frequent_ghosts : &r->recent_ghosts, g, ghost_link);
+    ctx->processes[ghost->process_index].pages[ghost->page_number].ghost = -1;
+    ghost->process_index = -1;
+    ghost->page_number = -1;
+    ghost->next_free = r->ghost_free;
+    r->ghost_free = g;
+}
+
+// Miss on a ghost: move the target towards the list it came from and forget it
+static void arc_hit_ghost(SimContext *ctx, int g) {
+    ReplacementState *r = &ctx->replacement;
+    int recent = r->recent_ghosts.size;
+    int frequent = r->frequent_ghosts.size;
+    if (r->ghosts[g].frequent) {
+        int delta = frequent >= recent ? 1 : recent / frequent;
+        r->target = r->target > delta ? r->target - delta : 0;
+    } else {
+        int delta = recent >= frequent ? 1 : frequent / recent;
+        r->target = r->target + delta < ctx->num_frames ? r->target + delta : ctx->num_frames;
+    }
+    arc_drop_ghost(ctx, g);
+}
+
+// Complete miss evicting the frame: keep |T1| + |B1| <= c and |B1| + |B2| <= c
+static void arc_trim_ghosts(SimContext *ctx, int victim) {
+    ReplacementState *r = &ctx->replacement;
+    bool recent = !ctx->ram_frames[victim].frequent;
+    if (recent && r->list.size - 1 + r->recent_ghosts.size >= ctx->num_frames && r->recent_ghosts.size > 0) {
+        arc_drop_ghost(ctx, r->recent_ghosts.head);
+    }
+    if (r->recent_ghosts.size + r->frequent_ghosts.size >= ctx->num_frames) {
+        arc_drop_ghost(ctx, r->frequent_ghosts.size > 0 ? r->frequent_ghosts.head : r->recent_ghosts.head);
+    }
+}
+
+static void arc_add_ghost(SimContext *ctx, int process_index, int page_number, bool frequent) {
+    ReplacementState *r = &ctx->replacement;
+
+    // Evictions outside a miss (swap-outs, frame allocation) reuse the
+    // oldest ghost once the lists are full
+    if (r->ghost_free == -1) {
+        if (r->recent_ghosts.size + r->frequent_ghosts.size == 0) return;
+        arc_drop_ghost(ctx, r->frequent_ghosts.size > 0 ? r->frequent_ghosts.head : r->recent_ghosts.head);
+    }
+    int g = r->ghost_free;
+    r->ghost_free = r->ghosts[g].next_free;
+
+    GhostPage *ghost = &r->ghosts[g];
+    ghost->process_index = process_index;
+    ghost->page_number = page_number;
+    ghost->frequent = frequent;
+    ghost->next_free = -1;
+    list_append(ctx, frequent ? &r->frequent_ghosts : &r->recent_ghosts, g, ghost_link);
+    ctx->processes[process_index].pages[page_number].ghost = g;
+}
+
+static void arc_on_load(SimContext *ctx, int frame_index) {
+    ReplacementState *r = &ctx->replacement;
+    Frame *frame = &ctx->ram_frames[frame_index];
+    frame->frequent = r->ghost_hit;
+    r->ghost_hit = false;
+
+    // A ghost loaded into a free frame adapts here, with no victim to pick
+    int g = arc_find_ghost(ctx, frame->process_index, frame->page_number);
+    if (g != -1) {
+        arc_hit_ghost(ctx, g);
+        frame->frequent = true;
+    }
+    list_append(ctx, arc_list(ctx, frame_index), frame_index, frame_link);
+}
+
+static void arc_on_access(SimContext *ctx, int frame_index) {
+    list_unlink(ctx, arc_list(ctx, frame_index), frame_index, frame_link);
+    ctx->ram_frames[frame_index].frequent = true;
+    list_append(ctx, arc_list(ctx, frame_index), frame_index, frame_link);
+}
+
+static int arc_pick_victim(SimContext *ctx, int process_index, int page_number) {
+    ReplacementState *r = &ctx->replacement;
+    if (pickable_frames(ctx) == 0) return -1;
+
+    int g = arc_find_ghost(ctx, process_index, page_number);
+    bool in_frequent_ghosts = g != -1 && r->ghosts[g].frequent;
+    if (g != -1) {
+        arc_hit_ghost(ctx, g);
+        r->ghost_hit = true;
+    }
+
+    int recent = r->list.size;
+    const FrameList *from = &r->frequent;
+    if (recent > 0 && (recent > r->target || (in_frequent_ghosts && recent == r->target) ||
+                       r->frequent.size == 0)) {
+        from = &r->list;
+    }
+    int victim = from->head;
+    if (victim == r->pinned) {
+        // The next page of the same list, or else the other list's LRU
+        victim = ctx->ram_frames[victim].link.next;
+        if (victim == -1) victim = from == &r->list ? r->frequent.head : r->list.head;
+    }
+    if (g == -1) arc_trim_ghosts(ctx, victim);
+    return victim;
+}
+
+static void arc_on_evict(SimContext *ctx, int frame_index) {
+    Frame *frame = &ctx->ram_frames[frame_index];
+    list_unlink(ctx, arc_list(ctx, frame_index), frame_index, frame_link);
+    arc_add_ghost(ctx, frame->process_index, frame->page_number, frame->frequent);
+}
+
+// ---------------------------------------------------------------------------
+// OPT (Belady): evict the page whose next reference is furthest away. The
+// next use of every reference is planned from an earlier run of the same
+// schedule, whose references are the same since faults never change it.
+
+static bool opt_before(SimContext *ctx, int a, int b) {
+    return ctx->ram_frames[a].next_use > ctx->ram_frames[b].next_use;
+}
+
+// Next use of the page, which the current reference is to
+static void opt_plan(SimContext *ctx, int frame_index) {
+    const ReplacementState *r = &ctx->replacement;
+    Frame *frame = &ctx->ram_frames[frame_index];
+    frame->next_use = r->reference < r->num_planned ? r->next_use[r->reference] : INT_MAX;
+}
+
+static void opt_on_load(SimContext *ctx, int frame_index) {
+    opt_plan(ctx, frame_index);
+    heap_push(ctx, frame_index, opt_before);
+}
+
+static void opt_on_access(SimContext *ctx, int frame_index) {
+    opt_plan(ctx, frame_index);
+    heap_update(ctx, frame_index, opt_before);
+}
+
+static int opt_pick_victim(SimContext *ctx, int process_index, int page_number) {
+    (void)process_index;
+    (void)page_number;
+    return heap_victim(ctx, opt_before);
+}
+
+static void opt_on_evict(SimContext *ctx, int frame_index) {
+    heap_remove(ctx, frame_index, opt_before);
+}
+
+void replacement_plan_opt(SimContext *ctx, const PageEvent *events, int num_events) {
+    ReplacementState *r = &ctx->replacement;
+    free(r->next_use);
+    r->next_use = malloc((size_t)(num_events > 0 ? num_events : 1) * sizeof(int));
+    int *last_seen = malloc((size_t)(ctx->num_pages > 0 ? ctx->num_pages : 1) * sizeof(int));
+    if (r->next_use == NULL || last_seen == NULL) {
+        fprintf(stderr, "Error: Failed to allocate OPT plan for %d page references\n", num_events);
+        exit(1);
+    }
+    for (int page = 0; page < ctx->num_pages; page++) {
+        last_seen[page] = INT_MAX;
+    }
+
+    // Backwards, so the next reference of every page is already known
+    for (int e = num_events - 1; e >= 0; e--) {
+        int id = ctx->processes[events[e].process_index].first_page + events[e].page_number;
+        r->next_use[e] = last_seen[id];
+        last_seen[id] = e;
+    }
+    free(last_seen);
+    r->num_planned = num_events;
+}
+
+// ---------------------------------------------------------------------------
+
+const ReplacementOps replacement_ops[NUM_REPLACEMENT_POLICIES] = {
+    [POLICY_FIFO] = {fifo_on_load, fifo_on_access, list_pick_victim, list_on_evict},
+    [POLICY_LRU] = {fifo_on_load, lru_on_access, list_pick_victim, list_on_evict},
+    [POLICY_CLOCK] = {clock_on_load, clock_on_access, clock_pick_victim, clock_on_evict},
+    [POLICY_WSCLOCK] = {clock_on_load, clock_on_access, wsclock_pick_victim, clock_on_evict},
+    [POLICY_AGING] = {aging_on_load, aging_on_access, aging_pick_victim, aging_on_evict},
+    [POLICY_LFU] = {lfu_on_load, lfu_on_access, lfu_pick_victim, lfu_on_evict},
+    [POLICY_ARC] = {arc_on_load, arc_on_access, arc_pick_victim, arc_on_evict},
+    [POLICY_OPT] = {opt_on_load, opt_on_access, opt_pick_victim, opt_on_evict},
+};
+
+void replacement_reset(SimContext *ctx) {
+    ReplacementState *r = &ctx->replacement;
+    r->list = (FrameList){-1, -1, 0};
+    r->frequent = (FrameList){-1, -1, 0};
+    r->clock_hand = 0;
+    r->clock = 0;
+    r->heap_size = 0;
+    r->uses = 0;
+    r->recent_ghosts = (FrameList){-1, -1, 0};
+    r->frequent_ghosts = (FrameList){-1, -1, 0};
+    r->ghost_free = -1;
+    r->target = 0;
+    r->ghost_hit = false;
+    r->pinned = -1;
+    r->reference = 0;
+
+    // Heap and ghost entries are only sized for the policies that use them
+    bool heap = ctx->replacement_policy == POLICY_AGING || ctx->replacement_policy == POLICY_LFU ||
+                ctx->replacement_policy == POLICY_OPT;
+    if (heap && r->heap_capacity < ctx->num_frames) {
+        free(r->heap);
+        r->heap = malloc((size_t)ctx->num_frames * sizeof(int));
+        if (r->heap == NULL) {
+            fprintf(stderr, "Error: Failed to allocate replacement heap for %d frames\n", ctx->num_frames);
+            exit(1);
+        }
+        r->heap_capacity = ctx->num_frames;
+    }
+    if (ctx->replacement_policy == POLICY_ARC) {
+        if (r->ghosts_capacity < ctx->num_frames) {
+            free(r->ghosts);
+            r->ghosts = malloc((size_t)ctx->num_frames * sizeof(GhostPage));
+            if (r->ghosts == NULL) {
+                fprintf(stderr, "Error: Failed to allocate %d ARC ghost entries\n", ctx->num_frames);
+                exit(1);
+            }
+            r->ghosts_capacity = ctx->num_frames;
+        }
+        for (int g = r->ghosts_capacity - 1; g >= 0; g--) {
+            r->ghosts[g].process_index = -1;
+            r->ghosts[g].page_number = -1;
+            r->ghosts[g].frequent = false;
+            r->ghosts[g].link = (FrameLink){-1, -1};
+            r->ghosts[g].next_free = g < ctx->num_frames ? r->ghost_free : -1;
+            if (g < ctx->num_frames) r->ghost_free = g;
+        }
+    }
+}
+
+void replacement_free(SimContext *ctx) {
+    ReplacementState *r = &ctx->replacement;
+    free(r->heap);
+    free(r->ghosts);
+    free(r->next_use);
+    r->next_use = NULL;
+    r->num_planned = 0;
+    r->heap = NULL;
+    r->heap_capacity = 0;
+    r->heap_size = 0;
+    r->ghosts = NULL;
+    r->ghosts_capacity = 0;
+    r->ghost_free = -1;
+}
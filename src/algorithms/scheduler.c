@@ -2,6 +2,18 @@
 #include "../../include/globals.h"
 #include "../../include/metrics_utils.h"
 #include "../../include/memory.h"
+#include "../../include/memory_history.h"
+#include "../../include/replacement.h"
+#include "../../include/event_queue.h"
+#include "../../include/ready_heap.h"
+#include "../../include/vruntime_tree.h"
+#include "../../include/process_table.h"
+#include "../../include/timeline.h"
+#include "../../include/swap_device.h"
+#include "../../include/tlb.h"
+#include "../../include/trace.h"
+#include <limits.h>
+#include <stdio.h>
 #include <stdlib.h>
 
 static const int NONE = -1;
@@ -10,502 +22,1118 @@ bool has_executing_process(int running_process) {
     return running_process != NONE;
 }
 
-void initialize_default_processes() {
-    // Example process 1
-    processes[0].id = 1;
-    processes[0].arrival_time = 0;
-    processes[0].execution_time = 5;
-    processes[0].remaining_time = processes[0].execution_time;
-    processes[0].priority = 1;
-    processes[0].deadline = 10;
-
-    // Example process 2
-    processes[1].id = 2;
-    processes[1].arrival_time = 2;
-    processes[1].execution_time = 3;
-    processes[1].remaining_time = processes[1].execution_time;
-    processes[1].priority = 2;
-    processes[1].deadline = 8;
-
-    // Example process 3
-    processes[2].id = 3;
-    processes[2].arrival_time = 4;
-    processes[2].execution_time = 4;
-    processes[2].remaining_time = processes[2].execution_time;
-    processes[2].priority = 3;
-    processes[2].deadline = 15;
-
-    // Example process 4
-    processes[3].id = 4;
-    processes[3].arrival_time = 6;
-    processes[3].execution_time = 6;
-    processes[3].remaining_time = processes[3].execution_time;
-    processes[3].priority = 5;
-    processes[3].deadline = 21;
-
-    // Example process 5
-    processes[4].id = 5;
-    processes[4].arrival_time = 10;
-    processes[4].execution_time = 2;
-    processes[4].remaining_time = processes[4].execution_time;
-    processes[4].priority = 4;
-    processes[4].deadline = 18;
-
-    // Example process 6
-    processes[5].id = 6;
-    processes[5].arrival_time = 12;
-    processes[5].execution_time = 12;
-    processes[5].remaining_time = processes[5].execution_time;
-    processes[5].priority = 6;
-    processes[5].deadline = 35;
-
-    num_processes = 6;
-
-    // Allocate and initialize timeline arrays
-    for (int i = 0; i < num_processes; i++) {
-        processes[i].timeline = malloc(TOTAL_TIME * sizeof(ProcessState));
-        processes[i].page_fault_occurred = malloc(TOTAL_TIME * sizeof(bool));
-        for (int t = 0; t < TOTAL_TIME; t++) {
-            processes[i].timeline[t] = NOT_ARRIVED;
-            processes[i].page_fault_occurred[t] = false;
+void initialize_default_processes(SimContext *ctx) {
+    // Example processes: arrival, execution, priority, deadline
+    static const int defaults[][4] = {
+        {0, 5, 1, 10},
+        {2, 3, 2, 8},
+        {4, 4, 3, 15},
+        {6, 6, 5, 21},
+        {10, 2, 4, 18},
+        {12, 12, 6, 35}
+    };
+    int count = sizeof(defaults) / sizeof(defaults[0]);
+
+    process_table_clear(ctx);
+    for (int i = 0; i < count; i++) {
+        Process *p = process_table_add(ctx);
+        p->arrival_time = defaults[i][0];
+        p->execution_time = defaults[i][1];
+        p->remaining_time = p->execution_time;
+        p->priority = defaults[i][2];
+        p->deadline = defaults[i][3];
+    }
+
+    // Attach empty timelines
+    process_table_alloc_timelines(ctx);
+}
+
+// ---------------------------------------------------------------------------
+// Discrete-event engine
+//
+// Instead of walking every tick and rescanning all processes, each algorithm
+// pops the next event (arrival, burst end, overhead end, ...) from a queue,
+// decides what runs next and jumps straight to the following event. A process
+// only touches its timeline when its state changes, so idle and steady-state
+// stretches cost nothing.
+// ---------------------------------------------------------------------------
+
+// A context switch period started at tick start
+static void count_switch(SimContext *ctx, int start) {
+    if (start < ctx->exec_end - 1) {
+        ctx->switch_periods++;
+        return;
+    }
+    if (ctx->num_late_switches == ctx->late_switches_capacity) {
+        int new_capacity = ctx->late_switches_capacity > 0 ? ctx->late_switches_capacity * 2 : 16;
+        int *grown = realloc(ctx->late_switches, (size_t)new_capacity * sizeof(int));
+        if (grown == NULL) {
+            fprintf(stderr, "Error: Failed to grow context switch periods to %d\n", new_capacity);
+            exit(1);
         }
+        ctx->late_switches = grown;
+        ctx->late_switches_capacity = new_capacity;
     }
+    ctx->late_switches[ctx->num_late_switches++] = start;
 }
 
-void execute_fifo() {
-    int running_process = NONE;
-    int process_completed = 0;
+// An executed run ended at tick end, past every earlier one: the late
+// context switches starting before the tick before it count
+static void advance_exec_end(SimContext *ctx, int end) {
+    ctx->exec_end = end;
+    int kept = 0;
+    for (int k = 0; k < ctx->num_late_switches; k++) {
+        if (ctx->late_switches[k] < end - 1) {
+            ctx->switch_periods++;
+        } else {
+            ctx->late_switches[kept++] = ctx->late_switches[k];
+        }
+    }
+    ctx->num_late_switches = kept;
+}
 
-    for (int t = 0; t < TOTAL_TIME && process_completed < num_processes; t++) {
-        // If there are no process executing, find next on queue
-        if (!has_executing_process(running_process)) {
-            // Choose process that got in earlier and yet no finished
-            int earliest_arrival = TOTAL_TIME + 1;
-            running_process = NONE;
+// Add the run of the pending state of process i, up to tick end, to the
+// statistics of the run. A CPU's context switch periods end in order, and
+// touching ones are a single period.
+static void count_state_run(SimContext *ctx, int i, int end) {
+    Process *p = &ctx->processes[i];
+    CpuStats *cpu = &ctx->cpu_stats[p->cpu];
+    int start = p->state_since;
+    switch (p->state) {
+        case EXECUTING:
+        case DEADLINE_MISSED:
+            if (p->first_exec == -1) p->first_exec = start;
+            p->last_exec_end = end;
+            cpu->busy += end - start;
+            if (end > cpu->exec_end) cpu->exec_end = end;
+            if (end > ctx->exec_end) advance_exec_end(ctx, end);
+            break;
+        case WAITING:
+        case SUSPENDED:
+            p->wait_ticks += end - start;
+            break;
+        case PAGE_FAULT:
+            p->fault_wait_ticks += end - start;
+            break;
+        case OVERHEAD:
+            if (start > cpu->switch_until) count_switch(ctx, start);
+            if (end > cpu->switch_until) cpu->switch_until = end;
+            break;
+        default:
+            break;
+    }
+}
 
-            for (int i = 0; i < num_processes; i++) {
-                if (processes[i].arrival_time <= t &&
-                    processes[i].remaining_time > 0 &&
-                    processes[i].arrival_time < earliest_arrival) {
-                    earliest_arrival = processes[i].arrival_time;
-                    running_process = i;
-                }
-            }
-        }
+// Write the pending state run of process i up to (but not including) tick end
+static void flush_state(SimContext *ctx, int i, int end) {
+    Process *p = &ctx->processes[i];
+    if (end > ctx->total_time) end = ctx->total_time;
+    if (end <= p->state_since) return;
 
-        // Update states
-        for (int i = 0; i < num_processes; i++) {
-            if (i == running_process) {
-                // Check for page fault (if memory enabled) - mark but don't block
-                if (memory_enabled && processes[i].page_fault_occurred) {
-                    bool page_fault = check_page_fault(i);
-                    processes[i].page_fault_occurred[t] = page_fault;
-                }
+    count_state_run(ctx, i, end);
+    if (ctx->keep_timelines) {
+        timeline_append(&p->timeline, p->state_since, end - p->state_since, p->state, p->cpu, p->state_fault);
+    }
+    p->state_since = end;
+    p->state_fault = false;
+}
 
-                // Normal execution
-                processes[i].timeline[t] = EXECUTING;
-                processes[i].remaining_time--;
-                current_time_global = t;
+// Process i enters a new state at tick t
+static void set_state(SimContext *ctx, int i, int t, ProcessState state) {
+    if (ctx->processes[i].state == state) return;
+    if (ctx->processes[i].state == OVERHEAD) trace_event(ctx, TRACE_OVERHEAD_END, t, i, 0);
+    flush_state(ctx, i, t);
+    ctx->processes[i].state = state;
+    ctx->processes[i].state_since = t;
+    ctx->processes[i].state_fault = false;
+}
 
-                // Check if process is done
-                if (processes[i].remaining_time <= 0) {
-                    process_completed++;
-                    running_process = NONE;  // Free CPU for next process
-                }
-            } else if (processes[i].arrival_time <= t && processes[i].remaining_time > 0) {
-                processes[i].timeline[t] = WAITING;
-            } else if (processes[i].arrival_time > t) {
-                processes[i].timeline[t] = NOT_ARRIVED;
+// Process i starts a context switch (or a migration) at tick t on its CPU,
+// whose TLB is emptied if context switches flush it
+static void start_overhead(SimContext *ctx, int i, int t) {
+    set_state(ctx, i, t, OVERHEAD);
+    trace_event(ctx, TRACE_OVERHEAD_START, t, i, 0);
+    if (ctx->memory_enabled && ctx->tlb_flush) tlb_flush(&ctx->tlb, ctx->processes[i].cpu);
+}
+
+// Mark a page fault on tick t, which starts a new run of the current state
+static void mark_page_fault(SimContext *ctx, int i, int t) {
+    flush_state(ctx, i, t);
+    ctx->processes[i].state_fault = true;
+}
+
+// Move process i to another CPU's runqueue at tick t
+static void set_cpu(SimContext *ctx, int i, int t, int cpu) {
+    if (ctx->processes[i].cpu == cpu) return;
+    flush_state(ctx, i, t);
+    ctx->processes[i].cpu = cpu;
+}
+
+// Process i completed at tick t, giving its frames back under a bounded
+// frame allocation
+static void complete(SimContext *ctx, int i, int t) {
+    set_state(ctx, i, t, COMPLETED);
+    trace_event(ctx, TRACE_COMPLETE, t, i, 0);
+    if (ctx->memory_enabled) release_process_memory(ctx, i, t);
+}
+
+static void mark_arrived(SimContext *ctx, int i, int t) {
+    set_state(ctx, i, t, ctx->processes[i].remaining_time > 0 ? WAITING : COMPLETED);
+}
+
+// Faults block only when reading a page takes time. OPT plans on the
+// references of an earlier run, which blocking would make depend on the
+// choices of OPT itself, so its faults never block.
+static bool faults_block(const SimContext *ctx) {
+    return ctx->memory_enabled && ctx->fault_time > 0 && ctx->replacement_policy != POLICY_OPT;
+}
+
+// Process i no longer references pages; the others keep dispatch order
+static void stop_referencing(SimContext *ctx, int i) {
+    int r = 0;
+    while (r < ctx->num_running && ctx->running[r] != i) r++;
+    for (; r + 1 < ctx->num_running; r++) ctx->running[r] = ctx->running[r + 1];
+    if (r < ctx->num_running) ctx->num_running--;
+}
+
+// Start the next page read at tick t if the swap device is idle
+static void start_page_read(SimContext *ctx, EventQueue *events, int t) {
+    int ticks;
+    int i = swap_device_start(&ctx->swap, &ticks);
+    if (i == NONE) return;
+    long long done = (long long)t + ticks;
+    event_queue_push(events, done > INT_MAX ? INT_MAX : (int)done, EV_PAGE_READ, i, 0);
+}
+
+// Process i faulted on the page in slot at tick t. The tick goes to the
+// trap: the process blocks from it on, its CPU is given away on the next
+// one and the read queues on the swap device. The pending end of the burst
+// is dropped.
+static void block_on_fault(SimContext *ctx, EventQueue *events, int i, int slot, int t) {
+    Process *p = &ctx->processes[i];
+    stop_referencing(ctx, i);
+    set_state(ctx, i, t, PAGE_FAULT);
+    p->state_fault = true;
+    p->resume_reference = true;
+    p->burst_generation++;
+    event_queue_push(events, t + 1, EV_PAGE_FAULT, i, 0);
+    swap_device_request(&ctx->swap, i, slot);
+    start_page_read(ctx, events, t + 1);
+}
+
+// The page of process i arrived at tick t and the swap device moves on to
+// the next read. Returns whether the process is ready again: while memory
+// is overcommitted the load controller swaps it out instead.
+static bool finish_page_read(SimContext *ctx, EventQueue *events, int i, int t) {
+    swap_device_finish(&ctx->swap);
+    start_page_read(ctx, events, t);
+    if (memory_overcommitted(ctx, i)) {
+        swap_out_process(ctx, i, t);
+        set_state(ctx, i, t, SUSPENDED);
+        trace_event(ctx, TRACE_SWAP_OUT, t, i, 0);
+        return false;
+    }
+    set_state(ctx, i, t, WAITING);
+    return true;
+}
+
+// Swapped-out process brought back in at tick t, to be queued as ready;
+// NONE once no other one fits
+static int swap_in(SimContext *ctx, int t) {
+    if (!faults_block(ctx)) return NONE;
+    int i = swap_in_process(ctx);
+    if (i != NONE) {
+        set_state(ctx, i, t, WAITING);
+        trace_event(ctx, TRACE_SWAP_IN, t, i, 0);
+    }
+    return i;
+}
+
+// Burst end events that a page fault made stale
+static bool is_stale(const SimContext *ctx, const Event *ev) {
+    return ev->type == EV_BURST_END && ev->generation != ctx->processes[ev->process].burst_generation;
+}
+
+// Every running process references one page per executed tick, up to (not
+// including) tick t. Ticks go in order and the CPUs take turns within each,
+// so the policies see the references as they happened. Without blocking a
+// fault is only marked; otherwise the walk stops after the tick of the first
+// faults, so that the engine can hand their CPUs out. Returns the tick the
+// engine goes on from.
+static int reference_pages_until(SimContext *ctx, EventQueue *events, int t) {
+    if (!ctx->memory_enabled) return t;
+    bool blocking = faults_block(ctx);
+    for (int tick = ctx->referenced_until; tick < t && ctx->num_running > 0; tick++) {
+        // RAM only changes here, so the history logs page events at this tick
+        if (ctx->keep_memory_history) memory_history_advance(&ctx->memory_history, tick);
+        ctx->current_time_global = tick;
+        bool blocked = false;
+        for (int r = 0; r < ctx->num_running; r++) {
+            int i = ctx->running[r];
+            Process *p = &ctx->processes[i];
+            if (p->resume_reference) {
+                // Served by the page read the process blocked on
+                p->resume_reference = false;
+                continue;
+            }
+            int page = next_page_reference(ctx, i);
+            if (!reference_page(ctx, i, page)) continue;
+            if (blocking) {
+                block_on_fault(ctx, events, i, p->first_page + page, tick);
+                r--;
+                blocked = true;
             } else {
-                processes[i].timeline[t] = COMPLETED;
+                mark_page_fault(ctx, i, tick);
             }
         }
-
-        // Save memory state for this time unit (for animation)
-        if (memory_enabled) {
-            save_memory_state(t);
+        if (blocked) {
+            ctx->referenced_until = tick + 1;
+            return tick + 1;
         }
     }
+    if (t > ctx->referenced_until) ctx->referenced_until = t;
+    return t;
 }
 
-void execute_sjf() {
-    int running_process = NONE;
-    int process_completed = 0;
+// Next tick the engine handles: the next event, or the tick after the first
+// blocking faults before it
+static int next_engine_time(SimContext *ctx, EventQueue *events) {
+    int t = event_queue_next_time(events);
+    return reference_pages_until(ctx, events, t < ctx->total_time ? t : ctx->total_time);
+}
 
-    for (int t = 0; t < TOTAL_TIME && process_completed < num_processes; t++) {
-        // If there are no process executing, find next on queue (shortest one)
-        if (!has_executing_process(running_process)) {
-            int shortest_time = TOTAL_TIME + 1;
-            running_process = NONE;
+// Give the CPU to process i at tick t
+static void dispatch(SimContext *ctx, int i, int t, ProcessState state) {
+    Process *p = &ctx->processes[i];
 
-            // Find process with least total execution time
-            for (int i = 0; i < num_processes; i++) {
-                if (processes[i].arrival_time <= t &&
-                    processes[i].remaining_time > 0 &&
-                    processes[i].execution_time < shortest_time) {
-                    shortest_time = processes[i].execution_time;
-                    running_process = i;
-                }
-            }
+    p->burst_start = t;
+    ctx->dispatches++;
+    set_state(ctx, i, t, state);
+    trace_event(ctx, TRACE_PICK, t, i, 0);
+    if (ctx->memory_enabled) ctx->running[ctx->num_running++] = i;
+}
+
+// Take the CPU away from process i at tick t (it ran during [burst_start, t))
+static void end_burst(SimContext *ctx, int i, int t) {
+    Process *p = &ctx->processes[i];
+    int executed = t - p->burst_start;
+    p->burst_start = NONE;
+
+    if (ctx->memory_enabled) stop_referencing(ctx, i);
+    if (executed > 0) p->remaining_time -= executed;
+    if (p->remaining_time > 0) trace_event(ctx, TRACE_PREEMPT, t, i, 0);
+}
+
+static void engine_begin(SimContext *ctx, EventQueue *events) {
+    event_queue_init(events, ctx->num_processes * 2);
+    for (int i = 0; i < ctx->num_processes; i++) {
+        ctx->processes[i].state = NOT_ARRIVED;
+        ctx->processes[i].state_since = 0;
+        ctx->processes[i].state_fault = false;
+        ctx->processes[i].burst_start = NONE;
+        ctx->processes[i].cpu = 0;
+        ctx->processes[i].burst_generation = 0;
+        ctx->processes[i].resume_reference = false;
+        ctx->processes[i].first_exec = -1;
+        ctx->processes[i].last_exec_end = -1;
+        ctx->processes[i].wait_ticks = 0;
+        ctx->processes[i].fault_wait_ticks = 0;
+        event_queue_push(events, ctx->processes[i].arrival_time, EV_ARRIVAL, i, 0);
+    }
+    ctx->migrations = 0;
+    ctx->dispatches = 0;
+    for (int c = 0; c < ctx->num_cpus; c++) ctx->cpu_stats[c] = (CpuStats){0, 0, -1};
+    ctx->exec_end = 0;
+    ctx->switch_periods = 0;
+    ctx->num_late_switches = 0;
+
+    // At most one running process per CPU
+    ctx->num_running = 0;
+    ctx->referenced_until = 0;
+    if (ctx->memory_enabled) {
+        ctx->running = malloc((size_t)ctx->num_cpus * sizeof(int));
+        if (ctx->running == NULL) {
+            fprintf(stderr, "Error: Failed to allocate running processes for %d CPUs\n", ctx->num_cpus);
+            exit(1);
         }
+    }
+    if (faults_block(ctx)) swap_device_init(&ctx->swap, ctx);
+}
 
-        // Assign states
-        for (int i = 0; i < num_processes; i++) {
-            if (i == running_process) {
-                // Check for page fault
-                if (memory_enabled && processes[i].page_fault_occurred) {
-                    bool page_fault = check_page_fault(i);
-                    processes[i].page_fault_occurred[t] = page_fault;
-                }
+// Close the simulation at end_time: stop the running bursts and write every
+// pending state run to the timelines
+static void engine_finish(SimContext *ctx, EventQueue *events, int end_time) {
+    while (reference_pages_until(ctx, events, end_time) < end_time) {
+    }
+    for (int i = 0; i < ctx->num_processes; i++) {
+        Process *p = &ctx->processes[i];
+        if (p->burst_start != NONE) {
+            // A fault left unhandled ended the burst when it blocked
+            end_burst(ctx, i, p->state == PAGE_FAULT ? p->state_since : end_time);
+        }
+    }
+    for (int i = 0; i < ctx->num_processes; i++) {
+        flush_state(ctx, i, end_time);
+    }
+    if (ctx->memory_enabled && ctx->keep_memory_history) {
+        memory_history_finish(&ctx->memory_history, end_time);
+    }
+    free(ctx->running);
+    ctx->running = NULL;
+    ctx->num_running = 0;
+    if (faults_block(ctx)) swap_device_free(&ctx->swap);
+    event_queue_free(events);
+}
+
+static int min_int(int a, int b) {
+    return a < b ? a : b;
+}
+
+// Ready-queue orderings. Each one is a strict order on process indices so
+// ties always resolve the same way.
+
+// FIFO: process that got in earlier, lowest index on ties
+static bool arrives_first(const void *context, int a, int b) {
+    const SimContext *ctx = context;
+    if (ctx->processes[a].arrival_time != ctx->processes[b].arrival_time) {
+        return ctx->processes[a].arrival_time < ctx->processes[b].arrival_time;
+    }
+    return a < b;
+}
 
-                // Normal execution
-                processes[i].timeline[t] = EXECUTING;
-                processes[i].remaining_time--;
-                current_time_global = t;
+// SJF: least total execution time, lowest index on ties
+static bool shorter_job(const void *context, int a, int b) {
+    const SimContext *ctx = context;
+    if (ctx->processes[a].execution_time != ctx->processes[b].execution_time) {
+        return ctx->processes[a].execution_time < ctx->processes[b].execution_time;
+    }
+    return a < b;
+}
 
-                // Check if process is done
-                if (processes[i].remaining_time <= 0) {
+// EDF: earliest absolute deadline, lowest index on ties
+static bool earlier_deadline(const void *context, int a, int b) {
+    const SimContext *ctx = context;
+    int deadline_a = ctx->processes[a].arrival_time + ctx->processes[a].deadline;
+    int deadline_b = ctx->processes[b].arrival_time + ctx->processes[b].deadline;
+    if (deadline_a != deadline_b) {
+        return deadline_a < deadline_b;
+    }
+    return a < b;
+}
+
+// Non-preemptive loop shared by FIFO and SJF: a process keeps the CPU until
+// it completes, so the only events are arrivals and completions
+static void run_non_preemptive(SimContext *ctx, ReadyHeapBefore before) {
+    EventQueue events;
+    ReadyHeap ready;
+    int running_process = NONE;
+    int process_completed = 0;
+    int end_time = ctx->total_time;
+    Event ev;
+
+    engine_begin(ctx, &events);
+    ready_heap_init(&ready, ctx->num_processes, before, ctx);
+
+    while (!event_queue_empty(&events)) {
+        int t = next_engine_time(ctx, &events);
+        if (t >= ctx->total_time) break;
+
+        while (event_queue_pop_at(&events, t, &ev)) {
+            if (is_stale(ctx, &ev)) continue;
+            switch (ev.type) {
+                case EV_ARRIVAL:
+                    mark_arrived(ctx, ev.process, t);
+                    if (ctx->processes[ev.process].remaining_time > 0) {
+                        ready_heap_push(&ready, ev.process);
+                    }
+                    break;
+                case EV_BURST_END:
+                    end_burst(ctx, ev.process, t);
+                    complete(ctx, ev.process, t);
                     process_completed++;
+                    running_process = NONE;  // Free CPU for next process
+                    break;
+                case EV_PAGE_FAULT:
+                    end_burst(ctx, ev.process, t - 1);
                     running_process = NONE;
-                }
-
-            } else if (processes[i].arrival_time <= t && processes[i].remaining_time > 0) {
-                processes[i].timeline[t] = WAITING;
-            } else if (processes[i].arrival_time > t) {
-                processes[i].timeline[t] = NOT_ARRIVED;
-            } else {
-                processes[i].timeline[t] = COMPLETED;
+                    break;
+                case EV_PAGE_READ:
+                    if (finish_page_read(ctx, &events, ev.process, t)) ready_heap_push(&ready, ev.process);
+                    break;
+                default:
+                    break;
             }
         }
 
-        // Save memory state
-        if (memory_enabled) {
-            save_memory_state(t);
+        // Simulation stops once every process is done
+        if (process_completed >= ctx->num_processes) {
+            end_time = t;
+            break;
+        }
+
+        // Swapped-out processes rejoin the ready queue once their memory fits
+        for (int i = swap_in(ctx, t); i != NONE; i = swap_in(ctx, t)) {
+            ready_heap_push(&ready, i);
+        }
+
+        // If there are no process executing, take the head of the ready queue
+        if (!has_executing_process(running_process)) {
+            running_process = ready_heap_pop(&ready);
+            if (has_executing_process(running_process)) {
+                dispatch(ctx, running_process, t, EXECUTING);
+                event_queue_push(&events, t + ctx->processes[running_process].remaining_time,
+                                 EV_BURST_END, running_process, ctx->processes[running_process].burst_generation);
+            }
         }
     }
+
+    ready_heap_free(&ready);
+    engine_finish(ctx, &events, end_time);
 }
 
-void execute_edf() {
-    int current_quantum = 0;
+void execute_fifo(SimContext *ctx) {
+    run_non_preemptive(ctx, arrives_first);
+}
+
+void execute_sjf(SimContext *ctx) {
+    run_non_preemptive(ctx, shorter_job);
+}
+
+void execute_edf(SimContext *ctx) {
+    EventQueue events;
+    ReadyHeap ready;
     int running_process = NONE;
-    int overhead_remaining = 0;
+    int overhead_process = NONE;
+    bool burst_over = false;
+    Event ev;
 
     // Reset remaining times and initialize overhead flag
-    for (int i = 0; i < num_processes; i++) {
-        processes[i].remaining_time = processes[i].execution_time;
-        processes[i].overhead = false;
-        for (int t = 0; t < TOTAL_TIME; t++) {
-            processes[i].timeline[t] = NOT_ARRIVED;
-        }
+    for (int i = 0; i < ctx->num_processes; i++) {
+        ctx->processes[i].remaining_time = ctx->processes[i].execution_time;
+        ctx->processes[i].overhead = false;
     }
 
-    for (int t = 0; t < TOTAL_TIME; t++) {
-        // Check if current process finished its quantum or completed
-        if (has_executing_process(running_process)) {
-            bool needs_preemption = (current_quantum >= quantum);
-            bool has_finished = (processes[running_process].remaining_time <= 0);
+    engine_begin(ctx, &events);
+    ready_heap_init(&ready, ctx->num_processes, earlier_deadline, ctx);
+    for (int i = 0; i < ctx->num_processes; i++) {
+        event_queue_push(&events, ctx->processes[i].arrival_time + ctx->processes[i].deadline,
+                         EV_DEADLINE, i, 0);
+    }
 
-            if (needs_preemption || has_finished) {
-                // If quantum over and not finishe, add overhead
-                if (needs_preemption && processes[running_process].remaining_time > 0) {
-                    processes[running_process].overhead = true;
-                    overhead_remaining = overhead_time;
-                }
-                running_process = NONE;
-                current_quantum = 0;
+    while (!event_queue_empty(&events)) {
+        int t = next_engine_time(ctx, &events);
+        if (t >= ctx->total_time) break;
+
+        while (event_queue_pop_at(&events, t, &ev)) {
+            if (is_stale(ctx, &ev)) continue;
+            switch (ev.type) {
+                case EV_ARRIVAL:
+                    mark_arrived(ctx, ev.process, t);
+                    if (ctx->processes[ev.process].remaining_time > 0) {
+                        ready_heap_push(&ready, ev.process);
+                    }
+                    break;
+                case EV_DEADLINE:
+                    // Not if it blocked on a fault the tick before
+                    if (ev.process == running_process && ctx->processes[ev.process].state == EXECUTING) {
+                        set_state(ctx, running_process, t, DEADLINE_MISSED);
+                    }
+                    break;
+                case EV_BURST_END:
+                    burst_over = true;
+                    break;
+                case EV_OVERHEAD_END:
+                    ctx->processes[overhead_process].overhead = false;
+                    set_state(ctx, overhead_process, t, WAITING);
+                    ready_heap_push(&ready, overhead_process);
+                    overhead_process = NONE;
+                    break;
+                case EV_PAGE_FAULT:
+                    end_burst(ctx, ev.process, t - 1);
+                    running_process = NONE;
+                    break;
+                case EV_PAGE_READ:
+                    if (finish_page_read(ctx, &events, ev.process, t)) ready_heap_push(&ready, ev.process);
+                    break;
+                default:
+                    break;
             }
         }
 
-        // Get next process (EDF selection)
-        if (!has_executing_process(running_process) && overhead_remaining == 0) {
-            int earliest_deadline = TOTAL_TIME + 1;
+        // Current process finished its quantum or completed
+        if (burst_over) {
+            end_burst(ctx, running_process, t);
+            // If quantum over and not finished, add overhead
+            if (ctx->processes[running_process].remaining_time > 0) {
+                ctx->processes[running_process].overhead = true;
+                overhead_process = running_process;
+                start_overhead(ctx, running_process, t);
+                event_queue_push(&events, t + ctx->overhead_time, EV_OVERHEAD_END, running_process, 0);
+            } else {
+                complete(ctx, running_process, t);
+            }
             running_process = NONE;
+            burst_over = false;
+        }
 
-            // Find process with earliest deadline
-            for (int i = 0; i < num_processes; i++) {
-                if (processes[i].arrival_time <= t &&
-                    processes[i].remaining_time > 0 &&
-                    processes[i].deadline < earliest_deadline) {
-                    earliest_deadline = processes[i].deadline;
-                    running_process = i;
-                }
+        // Swapped-out processes rejoin the ready queue once their memory fits
+        for (int i = swap_in(ctx, t); i != NONE; i = swap_in(ctx, t)) {
+            ready_heap_push(&ready, i);
+        }
+
+        // Get next process (EDF selection)
+        if (!has_executing_process(running_process) && overhead_process == NONE) {
+            running_process = ready_heap_pop(&ready);
+            if (has_executing_process(running_process)) {
+                Process *p = &ctx->processes[running_process];
+                bool missed = t - p->arrival_time >= p->deadline;
+                dispatch(ctx, running_process, t, missed ? DEADLINE_MISSED : EXECUTING);
+                event_queue_push(&events, t + min_int(ctx->quantum, p->remaining_time),
+                                 EV_BURST_END, running_process, p->burst_generation);
             }
         }
+    }
 
-        // Update states
-        for (int i = 0; i < num_processes; i++) {
-            if (processes[i].overhead) {
-                processes[i].timeline[t] = OVERHEAD;
+    ready_heap_free(&ready);
+    engine_finish(ctx, &events, ctx->total_time);
+}
 
-                overhead_remaining--;
-                if (overhead_remaining == 0) {
-                    processes[i].overhead = false;
-                }
-            } else if (i == running_process) {
-                // Check for page fault (if memory enabled) - mark but don't block
-                if (memory_enabled && processes[i].page_fault_occurred) {
-                    bool page_fault = check_page_fault(i);
-                    processes[i].page_fault_occurred[t] = page_fault;
-                }
+// ---------------------------------------------------------------------------
+// SMP support (RR and CFS)
+//
+// Every CPU owns a runqueue. Arrivals go to the least loaded CPU, and a CPU
+// that runs out of work steals a waiting process from the busiest one.
+// Moving a process counts as a migration and, when migration_cost > 0, the
+// process spends that many ticks in overhead on its new CPU before it can run.
+// ---------------------------------------------------------------------------
+
+typedef struct {
+    int running;            // process executing on this CPU (NONE if idle)
+    int overhead_process;   // process in a context switch or migration (NONE if none)
+    bool burst_over;        // running process finished its quantum or completed (RR)
+    // RR runqueue: FIFO linked through next_in_queue, running process excluded
+    int queue_head;
+    int queue_tail;
+    int queue_size;
+    // CFS runqueue: waiting processes of this CPU, running process excluded
+    VruntimeTree tree;
+    long long base_vruntime;   // vruntime of the running process when its burst started
+    long long vruntime_delta;  // vruntime it gains per executed tick
+    int wakeup_time;        // tick of the pending wakeup event (CFS)
+} Cpu;
+
+static Cpu *cpus_create(SimContext *ctx) {
+    Cpu *cpus = calloc(ctx->num_cpus, sizeof(Cpu));
+    if (cpus == NULL) {
+        fprintf(stderr, "Error: Failed to allocate CPU state\n");
+        exit(1);
+    }
+    for (int c = 0; c < ctx->num_cpus; c++) {
+        cpus[c].running = NONE;
+        cpus[c].overhead_process = NONE;
+        cpus[c].queue_head = NONE;
+        cpus[c].queue_tail = NONE;
+        cpus[c].wakeup_time = NONE;
+    }
+    return cpus;
+}
 
-                // Normal execution
-                if (t - processes[i].arrival_time >= processes[i].deadline) {
-                    processes[i].timeline[t] = DEADLINE_MISSED;
-                    processes[i].remaining_time--;
-                    current_quantum++;
-                } else {
-                    processes[i].timeline[t] = EXECUTING;
-                    processes[i].remaining_time--;
-                    current_quantum++;
-                }
-                current_time_global = t;
-            } else if (processes[i].arrival_time <= t && processes[i].remaining_time > 0) {
-                processes[i].timeline[t] = WAITING;
-            } else if (processes[i].arrival_time > t) {
-                processes[i].timeline[t] = NOT_ARRIVED;
-            } else {
-                processes[i].timeline[t] = COMPLETED;
-            }
-        }
+// Move process i to CPU thief at tick t, paying the migration cost there
+static void migrate(SimContext *ctx, EventQueue *events, Cpu *cpus, int i, int thief, int t) {
+    ctx->migrations++;
+    set_cpu(ctx, i, t, thief);
+    if (ctx->migration_cost > 0) {
+        cpus[thief].overhead_process = i;
+        start_overhead(ctx, i, t);
+        event_queue_push(events, t + ctx->migration_cost, EV_OVERHEAD_END, i, 0);
+    }
+}
 
-        // Save memory state for this time unit (for animation)
-        if (memory_enabled) {
-            save_memory_state(t);
+static void rr_enqueue(Cpu *cpu, int *next_in_queue, int i) {
+    next_in_queue[i] = NONE;
+    if (cpu->queue_size == 0) {
+        cpu->queue_head = i;
+    } else {
+        next_in_queue[cpu->queue_tail] = i;
+    }
+    cpu->queue_tail = i;
+    cpu->queue_size++;
+}
+
+static int rr_dequeue(Cpu *cpu, int *next_in_queue) {
+    int i = cpu->queue_head;
+    cpu->queue_head = next_in_queue[i];
+    if (--cpu->queue_size == 0) cpu->queue_tail = NONE;
+    return i;
+}
+
+// Unlink the first queued process that is not in a context switch on this
+// CPU (NONE if there is none)
+static int rr_steal(Cpu *cpu, int *next_in_queue) {
+    int prev = NONE;
+    for (int i = cpu->queue_head; i != NONE; prev = i, i = next_in_queue[i]) {
+        if (i == cpu->overhead_process) continue;
+        if (prev == NONE) {
+            cpu->queue_head = next_in_queue[i];
+        } else {
+            next_in_queue[prev] = next_in_queue[i];
         }
+        if (cpu->queue_tail == i) cpu->queue_tail = prev;
+        cpu->queue_size--;
+        return i;
     }
+    return NONE;
 }
 
-void execute_rr() {
-    int current_quantum = 0;
-    int running_process = NONE;
-    int process_queue[MAX_PROCESSES];
-    int queue_size = 0;
-    int overhead_remaining = 0;
+static int rr_load(const Cpu *cpu) {
+    return cpu->queue_size + (cpu->running != NONE);
+}
 
-    // Initialize queue with processes in arrival order
-    for (int t = 0; t < TOTAL_TIME; t++) {
+// Least loaded CPU, lowest index on ties
+static int rr_least_loaded(const Cpu *cpus, int num_cpus) {
+    int best = 0;
+    for (int c = 1; c < num_cpus; c++) {
+        if (rr_load(&cpus[c]) < rr_load(&cpus[best])) best = c;
+    }
+    return best;
+}
 
-        // Add newly arrived processes to queue
-        for (int i = 0; i < num_processes; i++) {
-            if (processes[i].arrival_time == t) {
-                process_queue[queue_size++] = i;
-            }
+// Idle CPUs pull a waiting process from the busiest CPU that has one to spare
+static void rr_balance(SimContext *ctx, EventQueue *events, Cpu *cpus, int *next_in_queue, int t) {
+    for (int thief = 0; thief < ctx->num_cpus; thief++) {
+        Cpu *cpu = &cpus[thief];
+        if (cpu->running != NONE || cpu->overhead_process != NONE || cpu->queue_size > 0) continue;
+
+        int victim = NONE;
+        for (int c = 0; c < ctx->num_cpus; c++) {
+            int waiting = cpus[c].queue_size - (cpus[c].overhead_process != NONE);
+            if (rr_load(&cpus[c]) < 2 || waiting < 1) continue;
+            if (victim == NONE || rr_load(&cpus[c]) > rr_load(&cpus[victim])) victim = c;
         }
+        if (victim == NONE) return;
 
-        // Check if current process finished its quantum or completed
-        if (has_executing_process(running_process)) {
-            bool needs_preemption = (current_quantum >= quantum);
-            bool has_finished = (processes[running_process].remaining_time <= 0);
-
-            if (needs_preemption || has_finished) {
-                // If quantum over and not finished, add overhead
-                if (needs_preemption && processes[running_process].remaining_time > 0) {
-                    processes[running_process].overhead = true;
-                    process_queue[queue_size++] = running_process;
-                    overhead_remaining = overhead_time;
-                }
-                running_process = NONE;
-                current_quantum = 0;
+        int i = rr_steal(&cpus[victim], next_in_queue);
+        migrate(ctx, events, cpus, i, thief, t);
+        rr_enqueue(cpu, next_in_queue, i);
+    }
+}
+
+void execute_rr(SimContext *ctx) {
+    EventQueue events;
+    Cpu *cpus = cpus_create(ctx);
+    int *next_in_queue = malloc((ctx->num_processes > 0 ? ctx->num_processes : 1) * sizeof(int));
+    Event ev;
+
+    if (next_in_queue == NULL) {
+        fprintf(stderr, "Error: Failed to allocate round robin queue\n");
+        exit(1);
+    }
+
+    engine_begin(ctx, &events);
+
+    while (!event_queue_empty(&events)) {
+        int t = next_engine_time(ctx, &events);
+        if (t >= ctx->total_time) break;
+
+        while (event_queue_pop_at(&events, t, &ev)) {
+            if (is_stale(ctx, &ev)) continue;
+            Cpu *cpu = &cpus[ctx->processes[ev.process].cpu];
+            switch (ev.type) {
+                case EV_ARRIVAL:
+                    // Add newly arrived processes to the least loaded queue
+                    mark_arrived(ctx, ev.process, t);
+                    if (ctx->processes[ev.process].remaining_time > 0) {
+                        int target = rr_least_loaded(cpus, ctx->num_cpus);
+                        set_cpu(ctx, ev.process, t, target);
+                        rr_enqueue(&cpus[target], next_in_queue, ev.process);
+                    }
+                    break;
+                case EV_BURST_END:
+                    cpu->burst_over = true;
+                    break;
+                case EV_OVERHEAD_END:
+                    ctx->processes[ev.process].overhead = false;
+                    set_state(ctx, ev.process, t, WAITING);
+                    cpu->overhead_process = NONE;
+                    break;
+                case EV_PAGE_FAULT:
+                    end_burst(ctx, ev.process, t - 1);
+                    cpu->running = NONE;
+                    break;
+                case EV_PAGE_READ:
+                    // Back on the queue of the CPU it last ran on
+                    if (finish_page_read(ctx, &events, ev.process, t)) rr_enqueue(cpu, next_in_queue, ev.process);
+                    break;
+                default:
+                    break;
             }
         }
 
-        // Get next process from queue
-        if (!has_executing_process(running_process) && queue_size > 0 && overhead_remaining == 0) {
-            running_process = process_queue[0];
-            // Remove from queue
-            for (int i = 0; i < queue_size - 1; i++) {
-                process_queue[i] = process_queue[i + 1];
+        // Current processes finished their quantum or completed
+        for (int c = 0; c < ctx->num_cpus; c++) {
+            Cpu *cpu = &cpus[c];
+            int running_process = cpu->running;
+            if (!cpu->burst_over) continue;
+
+            end_burst(ctx, running_process, t);
+            // If quantum over and not finished, add overhead and requeue it
+            if (ctx->processes[running_process].remaining_time > 0) {
+                ctx->processes[running_process].overhead = true;
+                cpu->overhead_process = running_process;
+                rr_enqueue(cpu, next_in_queue, running_process);
+                start_overhead(ctx, running_process, t);
+                event_queue_push(&events, t + ctx->overhead_time, EV_OVERHEAD_END, running_process, 0);
+            } else {
+                complete(ctx, running_process, t);
             }
-            queue_size--;
+            cpu->running = NONE;
+            cpu->burst_over = false;
         }
 
-        // Update states
-        for (int i = 0; i < num_processes; i++) {
-            if (processes[i].overhead) {
-                processes[i].timeline[t] = OVERHEAD;
+        // Swapped-out processes go back on the queue of the CPU they last ran on
+        for (int i = swap_in(ctx, t); i != NONE; i = swap_in(ctx, t)) {
+            rr_enqueue(&cpus[ctx->processes[i].cpu], next_in_queue, i);
+        }
 
-                overhead_remaining--;
-                if (overhead_remaining == 0) {
-                    processes[i].overhead = false;
-                }
-            }
-            else if (i == running_process) {
-                // Check for page fault (if memory enabled) - mark but don't block
-                if (memory_enabled && processes[i].page_fault_occurred) {
-                    bool page_fault = check_page_fault(i);
-                    processes[i].page_fault_occurred[t] = page_fault;
-                }
+        if (ctx->num_cpus > 1) {
+            rr_balance(ctx, &events, cpus, next_in_queue, t);
+        }
 
-                // Normal execution
-                processes[i].timeline[t] = EXECUTING;
-                processes[i].remaining_time--;
-                current_quantum++;
-                current_time_global = t;
-            } else if (processes[i].arrival_time <= t && processes[i].remaining_time > 0) {
-                processes[i].timeline[t] = WAITING;
-            } else if (processes[i].arrival_time > t) {
-                processes[i].timeline[t] = NOT_ARRIVED;
-            } else {
-                processes[i].timeline[t] = COMPLETED;
+        // Get next process from each queue
+        for (int c = 0; c < ctx->num_cpus; c++) {
+            Cpu *cpu = &cpus[c];
+            if (has_executing_process(cpu->running) || cpu->queue_size == 0 || cpu->overhead_process != NONE) {
+                continue;
             }
+            int running_process = rr_dequeue(cpu, next_in_queue);
+            cpu->running = running_process;
+            dispatch(ctx, running_process, t, EXECUTING);
+            event_queue_push(&events, t + min_int(ctx->quantum, ctx->processes[running_process].remaining_time),
+                             EV_BURST_END, running_process, ctx->processes[running_process].burst_generation);
         }
     }
+
+    free(next_in_queue);
+    free(cpus);
+    engine_finish(ctx, &events, ctx->total_time);
 }
 
-void execute_cfs() {
-    int running_process = NONE;
-    int process_completed = 0;
-    int overhead_remaining = 0;
-    int preempted_process = NONE;
-    const double EPSILON = 1e-9; // Tolerance for comparison of double
-
-    for (int i = 0; i < num_processes; i++) {
-        processes[i].remaining_time = processes[i].execution_time;
-        processes[i].vruntime = -1.0;
-        for (int t = 0; t < TOTAL_TIME; t++) {
-            processes[i].timeline[t] = NOT_ARRIVED;
-        }
+// vruntime is kept in fixed point, CFS_VRUNTIME_SCALE units per tick
+#define CFS_VRUNTIME_SCALE 262144LL
+
+// vruntime gained per executed tick, indexed by priority - 1. Each priority
+// weighs 1.25x the previous one (as in the kernel's sched_prio_to_weight);
+// 1.25^9 = 5^9 / 4^9, so with a 4^9 scale every entry is exact
+static const long long cfs_prio_to_delta[10] = {
+    262144, 327680, 409600, 512000, 640000,
+    800000, 1000000, 1250000, 1562500, 1953125
+};
+
+static long long cfs_delta(int priority) {
+    if (priority < 1) priority = 1;
+    if (priority > 10) priority = 10;
+    return cfs_prio_to_delta[priority - 1];
+}
+
+// Whether the running process, at the given vruntime, still wins the
+// selection against the best waiting process (lowest vruntime, highest index on ties)
+static bool cfs_keeps_cpu(SimContext *ctx, int running, long long vruntime, int rival) {
+    long long rival_vruntime = ctx->processes[rival].vruntime;
+    return vruntime < rival_vruntime || (vruntime == rival_vruntime && running > rival);
+}
+
+// First tick after t at which the running process loses the CPU to the best
+// waiting process (rival), assuming no new arrivals.
+// vruntime at tick u is base_vruntime + (u - burst_start) * delta.
+static int next_vruntime_cross(SimContext *ctx, int running, int rival, int t, long long base_vruntime, long long delta, int limit) {
+    int burst_start = ctx->processes[running].burst_start;
+    long long gap = (ctx->processes[rival].vruntime - ctx->processes[running].vruntime) / delta;
+    int k = gap > limit ? limit : (int)gap;
+    if (k < 1) k = 1;
+
+    while (k > 1 && !cfs_keeps_cpu(ctx, running, base_vruntime + (t + k - 1 - burst_start) * delta, rival)) {
+        k--;
+    }
+    while (k < limit && cfs_keeps_cpu(ctx, running, base_vruntime + (t + k - burst_start) * delta, rival)) {
+        k++;
     }
+    return t + k;
+}
 
-    // Main Time Loop
-    for (int t = 0; t < TOTAL_TIME && process_completed < num_processes; t++) {
+static int cfs_load(const Cpu *cpu) {
+    return cpu->tree.size + (cpu->running != NONE);
+}
 
-        // vruntime = current_time on arrival
-        for (int i = 0; i < num_processes; i++) {
-            if (processes[i].arrival_time == t && processes[i].vruntime < 0) {
-                processes[i].vruntime = (double)t;
-            }
-        }
+// Least loaded CPU, lowest index on ties
+static int cfs_least_loaded(const Cpu *cpus, int num_cpus) {
+    int best = 0;
+    for (int c = 1; c < num_cpus; c++) {
+        if (cfs_load(&cpus[c]) < cfs_load(&cpus[best])) best = c;
+    }
+    return best;
+}
 
-        if (overhead_remaining > 0) {
-            for (int i = 0; i < num_processes; i++) {
-                if (i == preempted_process) {
-                    processes[i].timeline[t] = OVERHEAD;
-                } else if (processes[i].arrival_time <= t && processes[i].remaining_time > 0) {
-                    processes[i].timeline[t] = WAITING;
-                } else if (processes[i].remaining_time <= 0) {
-                    processes[i].timeline[t] = COMPLETED;
-                }
-            }
-            overhead_remaining--;
-            running_process = NONE;
-            if (overhead_remaining == 0) {
-                preempted_process = NONE;
-            }
-            continue;
+// Idle CPUs pull the best waiting process from the busiest CPU that has one
+// to spare
+static void cfs_balance(SimContext *ctx, EventQueue *events, Cpu *cpus, int t) {
+    for (int thief = 0; thief < ctx->num_cpus; thief++) {
+        Cpu *cpu = &cpus[thief];
+        if (cfs_load(cpu) > 0 || cpu->overhead_process != NONE) continue;
+
+        int victim = NONE;
+        for (int c = 0; c < ctx->num_cpus; c++) {
+            if (cfs_load(&cpus[c]) < 2) continue;
+            if (victim == NONE || cfs_load(&cpus[c]) > cfs_load(&cpus[victim])) victim = c;
         }
+        if (victim == NONE) return;
 
-        if (has_executing_process(running_process) && processes[running_process].remaining_time <= 0) {
-            process_completed++;
-            running_process = NONE;
-        }
+        // A process in a context switch on the victim CPU stays there
+        Cpu *from = &cpus[victim];
+        int i = vruntime_tree_first(&from->tree);
+        if (i == from->overhead_process) i = vruntime_tree_next(&from->tree, i);
 
-        // Select the lowest vruntim,
-        // if tied, select the process with the highest index
-        int selected_process = NONE;
-        double min_vruntime_prontos = -1.0;
-
-        for (int i = 0; i < num_processes; i++) {
-            if (processes[i].arrival_time <= t && processes[i].remaining_time > 0 && processes[i].vruntime >= 0.0) {
-
-                // Select: Strictly lowest OR tie + highest index (i > selected_process)
-                if (selected_process == NONE ||
-                    processes[i].vruntime < min_vruntime_prontos - EPSILON ||
-                    (fabs(processes[i].vruntime - min_vruntime_prontos) < EPSILON && i > selected_process))
-                {
-                    min_vruntime_prontos = processes[i].vruntime;
-                    selected_process = i;
+        vruntime_tree_remove(&from->tree, i);
+        vruntime_tree_insert(&cpu->tree, i, ctx->processes[i].vruntime);
+        migrate(ctx, events, cpus, i, thief, t);
+    }
+}
+
+void execute_cfs(SimContext *ctx) {
+    EventQueue events;
+    Cpu *cpus = cpus_create(ctx);
+    int process_completed = 0;
+    int end_time = ctx->total_time;
+    int generation = 0;
+    Event ev;
+
+    for (int i = 0; i < ctx->num_processes; i++) {
+        ctx->processes[i].remaining_time = ctx->processes[i].execution_time;
+        ctx->processes[i].vruntime = -1;
+    }
+
+    engine_begin(ctx, &events);
+    for (int c = 0; c < ctx->num_cpus; c++) {
+        vruntime_tree_init(&cpus[c].tree, ctx->num_processes);
+        cpus[c].vruntime_delta = cfs_delta(1);
+    }
+
+    while (!event_queue_empty(&events)) {
+        int t = next_engine_time(ctx, &events);
+        if (t >= ctx->total_time) break;
+
+        while (event_queue_pop_at(&events, t, &ev)) {
+            switch (ev.type) {
+                case EV_ARRIVAL:
+                    // vruntime = current_time on arrival
+                    if (ctx->processes[ev.process].vruntime < 0) {
+                        ctx->processes[ev.process].vruntime = t * CFS_VRUNTIME_SCALE;
+                    }
+                    mark_arrived(ctx, ev.process, t);
+                    if (ctx->processes[ev.process].remaining_time > 0) {
+                        int target = cfs_least_loaded(cpus, ctx->num_cpus);
+                        set_cpu(ctx, ev.process, t, target);
+                        vruntime_tree_insert(&cpus[target].tree, ev.process, ctx->processes[ev.process].vruntime);
+                    }
+                    break;
+                case EV_OVERHEAD_END:
+                    set_state(ctx, ev.process, t, WAITING);
+                    cpus[ctx->processes[ev.process].cpu].overhead_process = NONE;
+                    break;
+                case EV_PAGE_FAULT: {
+                    // Charge the ticks it ran before the fault
+                    Process *p = &ctx->processes[ev.process];
+                    Cpu *cpu = &cpus[p->cpu];
+                    p->vruntime = cpu->base_vruntime + (t - 1 - p->burst_start) * cpu->vruntime_delta;
+                    end_burst(ctx, ev.process, t - 1);
+                    cpu->running = NONE;
+                    break;
                 }
+                case EV_PAGE_READ:
+                    // Wakes up on its CPU with the vruntime it blocked with
+                    if (finish_page_read(ctx, &events, ev.process, t)) {
+                        vruntime_tree_insert(&cpus[ctx->processes[ev.process].cpu].tree, ev.process,
+                                             ctx->processes[ev.process].vruntime);
+                    }
+                    break;
+                default:
+                    // Burst end / vruntime cross only wake the scheduler up;
+                    // the decision below recomputes everything from state
+                    break;
             }
         }
 
-        int current_rp = running_process;
-        running_process = selected_process;
+        for (int c = 0; c < ctx->num_cpus; c++) {
+            Cpu *cpu = &cpus[c];
+            int running_process = cpu->running;
+            if (!has_executing_process(running_process)) continue;
 
-        // If a process was running before and the new selected is different
-        if (current_rp != NONE && selected_process != current_rp) {
+            Process *p = &ctx->processes[running_process];
+            int executed = t - p->burst_start;
 
-            int is_strict_preemption = (processes[current_rp].vruntime > processes[selected_process].vruntime + EPSILON);
-
-            int is_tie_switch = (fabs(processes[current_rp].vruntime - processes[selected_process].vruntime) < EPSILON);
+            // vruntime_i = vruntime_i + Delta_t * w(prioridade_i)
+            p->vruntime = cpu->base_vruntime + executed * cpu->vruntime_delta;
 
-            if (is_strict_preemption || is_tie_switch)
-            {
-                overhead_remaining = overhead_time;
-                preempted_process = current_rp;
-                running_process = NONE;
-                t--; // Decrement time to make selected process run on next tick (after overhead)
-                continue;
+            if (executed >= p->remaining_time) {
+                end_burst(ctx, running_process, t);
+                complete(ctx, running_process, t);
+                process_completed++;
+                cpu->running = NONE;
             }
         }
 
-        if (has_executing_process(running_process)) {
-            int i = running_process;
+        // The tick on which the last completion is noticed is still recorded
+        if (process_completed >= ctx->num_processes) {
+            end_time = t + 1;
+            break;
+        }
 
-            // Check for page fault (if memory enabled) - mark but don't block
-            if (memory_enabled && processes[i].page_fault_occurred) {
-                bool page_fault = check_page_fault(i);
-                processes[i].page_fault_occurred[t] = page_fault;
-            }
+        // Swapped-out processes wake up like after a page read
+        for (int i = swap_in(ctx, t); i != NONE; i = swap_in(ctx, t)) {
+            vruntime_tree_insert(&cpus[ctx->processes[i].cpu].tree, i, ctx->processes[i].vruntime);
+        }
 
-            // Normal execution
-            processes[i].timeline[t] = EXECUTING;
+        if (ctx->num_cpus > 1) {
+            cfs_balance(ctx, &events, cpus, t);
+        }
 
-            int delta_t = 1;
-            // vruntime_i = vruntime_i + Delta_t * w(prioridade_i)
-            double priority_weight = pow(1.25, (double)processes[i].priority - 1.0);
-            processes[i].vruntime += delta_t * priority_weight;
-            processes[i].remaining_time--;
+        for (int c = 0; c < ctx->num_cpus; c++) {
+            Cpu *cpu = &cpus[c];
+            if (cpu->overhead_process != NONE) continue;
+
+            int running_process = cpu->running;
+            int selected_process = vruntime_tree_first(&cpu->tree);
+
+            // A waiting process has a lower vruntime: preempt with overhead,
+            // the selected process runs after the context switch
+            if (has_executing_process(running_process) && selected_process != NONE &&
+                !cfs_keeps_cpu(ctx, running_process, ctx->processes[running_process].vruntime, selected_process)) {
+                vruntime_tree_insert(&cpu->tree, running_process, ctx->processes[running_process].vruntime);
+                end_burst(ctx, running_process, t);
+                start_overhead(ctx, running_process, t);
+                cpu->overhead_process = running_process;
+                cpu->running = NONE;
+                event_queue_push(&events, t + ctx->overhead_time, EV_OVERHEAD_END, running_process, 0);
+                continue;
+            }
 
-            current_time_global = t;  // Update global time for LRU
-        }
+            if (!has_executing_process(running_process) && selected_process != NONE) {
+                running_process = selected_process;
+                vruntime_tree_remove(&cpu->tree, running_process);
+                cpu->running = running_process;
+                dispatch(ctx, running_process, t, EXECUTING);
+                cpu->base_vruntime = ctx->processes[running_process].vruntime;
+                cpu->vruntime_delta = cfs_delta(ctx->processes[running_process].priority);
+            }
 
-        for (int i = 0; i < num_processes; i++) {
-            if (processes[i].timeline[t] != EXECUTING && processes[i].timeline[t] != OVERHEAD) {
-                if (processes[i].arrival_time <= t && processes[i].remaining_time > 0)
-                    processes[i].timeline[t] = WAITING;
-                else if (processes[i].remaining_time <= 0)
-                    processes[i].timeline[t] = COMPLETED;
-                else if (processes[i].arrival_time > t)
-                    processes[i].timeline[t] = NOT_ARRIVED;
+            // Wake up on completion or when another process gets a lower vruntime
+            if (has_executing_process(running_process)) {
+                Process *p = &ctx->processes[running_process];
+                int completion = p->burst_start + p->remaining_time;
+                int rival = vruntime_tree_first(&cpu->tree);
+                int wakeup = completion;
+                EventType type = EV_BURST_END;
+                if (rival != NONE) {
+                    int cross = next_vruntime_cross(ctx, running_process, rival, t, cpu->base_vruntime,
+                                                    cpu->vruntime_delta, completion - t);
+                    if (cross < completion) {
+                        wakeup = cross;
+                        type = EV_VRUNTIME_CROSS;
+                    }
+                }
+                // One pending wakeup per tick is enough, the engine rechecks every CPU
+                if (wakeup != cpu->wakeup_time) {
+                    generation++;
+                    event_queue_push(&events, wakeup, type, running_process, generation);
+                    cpu->wakeup_time = wakeup;
+                }
             }
         }
+    }
 
-        // Save memory state for this time unit (for animation)
-        if (memory_enabled) {
-            save_memory_state(t);
-        }
+    for (int c = 0; c < ctx->num_cpus; c++) {
+        vruntime_tree_free(&cpus[c].tree);
     }
+    free(cpus);
+    engine_finish(ctx, &events, end_time);
 }
 
-void run_current_algorithm() {
-    // Initialize memory system if enabled
-    if (memory_enabled) {
-        init_memory_system();
+static void run_schedule(SimContext *ctx) {
+    switch (ctx->algorithm) {
+        case 0: execute_fifo(ctx); break;
+        case 1: execute_sjf(ctx); break;
+        case 2: execute_edf(ctx); break;
+        case 3: execute_rr(ctx); break;
+        case 4: execute_cfs(ctx); break;
     }
+}
+
+// OPT needs the future page references. Non-blocking faults never change
+// the schedule, so a FIFO run of it logs the same references that the OPT
+// run will make.
+static void plan_opt(SimContext *ctx) {
+    bool keep_page_events = ctx->keep_page_events;
+    int fault_time = ctx->fault_time;
+    ctx->keep_page_events = true;
+    ctx->replacement_policy = POLICY_FIFO;
+    ctx->fault_time = 0;
+    init_memory_system(ctx);
+    run_schedule(ctx);
+
+    replacement_plan_opt(ctx, ctx->page_events, ctx->num_page_events);
+    reset_simulation(ctx);
+    ctx->replacement_policy = POLICY_OPT;
+    ctx->fault_time = fault_time;
+    ctx->keep_page_events = keep_page_events;
+}
 
-    switch (current_algorithm) {
-        case 0: execute_fifo(); break;
-        case 1: execute_sjf(); break;
-        case 2: execute_edf(); break;
-        case 3: execute_rr(); break;
-        case 4: execute_cfs(); break;
+// Faults each process saved by reading ahead: its page references replayed
+// under the same policy with demand paging alone, minus the faults of the run
+static void count_faults_saved(SimContext *ctx) {
+    int *demand_faults = malloc((ctx->num_processes > 0 ? ctx->num_processes : 1) * sizeof(int));
+    if (demand_faults == NULL) {
+        fprintf(stderr, "Error: Failed to allocate fault counts for %d processes\n", ctx->num_processes);
+        exit(1);
     }
+    replay_page_faults(ctx, ctx->replacement_policy, demand_faults);
+    for (int i = 0; i < ctx->num_processes; i++) {
+        ctx->processes[i].metrics[MI_FAULTS_SAVED] = demand_faults[i] - ctx->processes[i].page_faults;
+    }
+    free(demand_faults);
+}
 
-    // After running the chosen algorithm compute the summary metrics
-    compute_metrics_for_all();
-    compute_summary_stats();
-}
-
-void reset_simulation() {
-    current_time = 0;
-    for (int i = 0; i < num_processes; i++) {
-        processes[i].remaining_time = processes[i].execution_time;
-        for (int t = 0; t < TOTAL_TIME; t++) {
-            processes[i].timeline[t] = NOT_ARRIVED;
-            if (processes[i].page_fault_occurred) {
-                processes[i].page_fault_occurred[t] = false;
-            }
+void run_current_algorithm(SimContext *ctx) {
+    if (ctx->trace.events != NULL) trace_reset(&ctx->trace);
+
+    // Initialize memory system if enabled
+    if (ctx->memory_enabled) {
+        if (ctx->replacement_policy == POLICY_OPT) {
+            trace_event(ctx, TRACE_PHASE_BEGIN, 0, NONE, TRACE_PHASE_PLAN_OPT);
+            plan_opt(ctx);
+            trace_event(ctx, TRACE_PHASE_END, 0, NONE, TRACE_PHASE_PLAN_OPT);
         }
+        init_memory_system(ctx);
+    }
+
+    trace_event(ctx, TRACE_PHASE_BEGIN, 0, NONE, TRACE_PHASE_SCHEDULE);
+    run_schedule(ctx);
+    trace_event(ctx, TRACE_PHASE_END, ctx->total_time, NONE, TRACE_PHASE_SCHEDULE);
+
+    // After running the chosen algorithm compute the summary metrics
+    trace_event(ctx, TRACE_PHASE_BEGIN, ctx->total_time, NONE, TRACE_PHASE_METRICS);
+    compute_metrics_for_all(ctx);
+    compute_summary_stats(ctx);
+    trace_event(ctx, TRACE_PHASE_END, ctx->total_time, NONE, TRACE_PHASE_METRICS);
+    if (ctx->memory_enabled && ctx->keep_page_events && ctx->replacement_policy != POLICY_OPT) {
+        trace_event(ctx, TRACE_PHASE_BEGIN, ctx->total_time, NONE, TRACE_PHASE_REPLAY);
+        ctx->summary_stats.opt_page_faults = replay_page_faults(ctx, POLICY_OPT, NULL);
+        if (ctx->readahead_pages > 0) count_faults_saved(ctx);
+        trace_event(ctx, TRACE_PHASE_END, ctx->total_time, NONE, TRACE_PHASE_REPLAY);
+    }
+}
+
+void reset_simulation(SimContext *ctx) {
+    for (int i = 0; i < ctx->num_processes; i++) {
+        ctx->processes[i].remaining_time = ctx->processes[i].execution_time;
+        timeline_reset(&ctx->processes[i].timeline);
     }
 }
@@ -0,0 +1,129 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "../../include/swap_device.h"
+
+int swap_device_tracks(long long num_pages) {
+    long long tracks = (num_pages + SWAP_TRACK_PAGES - 1) / SWAP_TRACK_PAGES;
+    return tracks > 0 ? (int)tracks : 1;
+}
+
+void swap_device_init(SwapDevice *dev, const SimContext *ctx) {
+    dev->schedule = ctx->disk_schedule;
+    dev->read_time = ctx->fault_time;
+    dev->num_tracks = swap_device_tracks(ctx->num_pages);
+    dev->capacity = ctx->num_processes > 0 ? ctx->num_processes : 1;
+    dev->slot = malloc((size_t)dev->capacity * sizeof(int));
+    dev->fifo = malloc((size_t)dev->capacity * sizeof(int));
+    if (dev->slot == NULL || dev->fifo == NULL) {
+        fprintf(stderr, "Error: Failed to allocate swap device for %d processes\n", dev->capacity);
+        exit(1);
+    }
+    dev->fifo_head = 0;
+    vruntime_tree_init(&dev->by_slot, dev->capacity);
+    dev->pending = 0;
+    dev->busy = -1;
+    dev->head = 0;
+    dev->direction = 1;
+}
+
+void swap_device_free(SwapDevice *dev) {
+    free(dev->slot);
+    free(dev->fifo);
+    dev->slot = NULL;
+    dev->fifo = NULL;
+    vruntime_tree_free(&dev->by_slot);
+    dev->pending = 0;
+    dev->busy = -1;
+}
+
+void swap_device_request(SwapDevice *dev, int process, int slot) {
+    dev->slot[process] = slot;
+    if (dev->schedule == DISK_FCFS) {
+        dev->fifo[(dev->fifo_head + dev->pending) % dev->capacity] = process;
+    } else {
+        vruntime_tree_insert(&dev->by_slot, process, slot);
+    }
+    dev->pending++;
+}
+
+static int track_of(int slot) {
+    return slot / SWAP_TRACK_PAGES;
+}
+
+static int track_distance(int a, int b) {
+    return a > b ? a - b : b - a;
+}
+
+// Pending process to serve next, with the tracks the head crosses to get
+// there
+static int pick_request(SwapDevice *dev, int *seek) {
+    int from = track_of(dev->head);
+    int up = -1;
+    int down = -1;
+    int i;
+
+    switch (dev->schedule) {
+        case DISK_SSTF:
+            // Closest slot either way, the higher one on ties
+            up = vruntime_tree_ceiling(&dev->by_slot, dev->head);
+            down = vruntime_tree_floor(&dev->by_slot, dev->head);
+            if (up == -1 || (down != -1 && dev->head - dev->slot[down] < dev->slot[up] - dev->head)) {
+                i = down;
+            } else {
+                i = up;
+            }
+            *seek = track_distance(from, track_of(dev->slot[i]));
+            return i;
+        case DISK_SCAN:
+            // Sweep on to the edge of the disk before turning around
+            if (dev->direction > 0) {
+                i = vruntime_tree_ceiling(&dev->by_slot, dev->head);
+                if (i != -1) {
+                    *seek = track_of(dev->slot[i]) - from;
+                    return i;
+                }
+                i = vruntime_tree_floor(&dev->by_slot, dev->head);
+                dev->direction = -1;
+                *seek = 2 * (dev->num_tracks - 1) - from - track_of(dev->slot[i]);
+                return i;
+            }
+            i = vruntime_tree_floor(&dev->by_slot, dev->head);
+            if (i != -1) {
+                *seek = from - track_of(dev->slot[i]);
+                return i;
+            }
+            i = vruntime_tree_ceiling(&dev->by_slot, dev->head);
+            dev->direction = 1;
+            *seek = from + track_of(dev->slot[i]);
+            return i;
+        case DISK_CLOOK:
+            // Upward only, jumping back to the lowest slot past the last one
+            i = vruntime_tree_ceiling(&dev->by_slot, dev->head);
+            if (i == -1) i = vruntime_tree_first(&dev->by_slot);
+            *seek = track_distance(from, track_of(dev->slot[i]));
+            return i;
+        case DISK_FCFS:
+        default:
+            i = dev->fifo[dev->fifo_head];
+            dev->fifo_head = (dev->fifo_head + 1) % dev->capacity;
+            *seek = track_distance(from, track_of(dev->slot[i]));
+            return i;
+    }
+}
+
+int swap_device_start(SwapDevice *dev, int *ticks) {
+    if (dev->busy != -1 || dev->pending == 0) return -1;
+
+    int seek;
+    int i = pick_request(dev, &seek);
+    if (dev->schedule != DISK_FCFS) vruntime_tree_remove(&dev->by_slot, i);
+    dev->pending--;
+    dev->busy = i;
+    dev->head = dev->slot[i];
+    *ticks = seek + dev->read_time;
+    return i;
+}
+
+void swap_device_finish(SwapDevice *dev) {
+    dev->busy = -1;
+}
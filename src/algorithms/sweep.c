@@ -0,0 +1,219 @@
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include "../../include/sweep.h"
+#include "../../include/scheduler.h"
+#include "../../include/sim_context.h"
+#include "../../include/thread_pool.h"
+
+// One grid point
+typedef struct {
+    int algorithm;
+    int quantum;
+    int overhead;
+    SweepMemory memory;
+    int frames;
+    int cpus;
+} SweepPoint;
+
+// Summary columns of one row (SummaryStats minus the per-CPU table)
+typedef struct {
+    double avg_execution;
+    double avg_wait;
+    double avg_turnaround;
+    double throughput;
+    double idle_percentage;
+    int context_switches;
+    int migrations;
+    int page_faults;
+    int opt_page_faults;
+    double avg_fault_wait;
+    double tlb_hit_rate;
+    long long tlb_stall_cycles;
+    double switch_stall_cycles;
+    int swap_outs;
+} SweepResult;
+
+// State shared by the workers of one sweep
+typedef struct {
+    const SimContext *base;
+    SweepPoint *points;
+    SweepResult *results;
+    bool *done;
+    long long count;
+    long long next_to_write;   // rows before this one are already written
+    FILE *out;
+    pthread_mutex_t lock;      // guards done[], next_to_write and out
+} SweepRun;
+
+typedef struct {
+    SweepRun *run;
+    long long index;
+} SweepJob;
+
+const char *sweep_memory_key(int memory) {
+    return memory == SWEEP_MEMORY_OFF ? "off" : replacement_policy_keys[memory - 1];
+}
+
+void sweep_spec_from_context(SweepSpec *spec, const SimContext *base) {
+    for (int a = 0; a < NUM_ALGORITHMS; a++) {
+        spec->algorithms[a] = a == base->algorithm;
+    }
+    spec->quantum = (SweepRange){base->quantum, base->quantum, 1};
+    spec->overhead = (SweepRange){base->overhead_time, base->overhead_time, 1};
+    spec->frames = (SweepRange){base->num_frames, base->num_frames, 1};
+    spec->cpus = (SweepRange){base->num_cpus, base->num_cpus, 1};
+    for (int m = 0; m < SWEEP_MEMORY_COUNT; m++) {
+        spec->memory[m] = false;
+    }
+    spec->memory[base->memory_enabled ? base->replacement_policy + 1 : SWEEP_MEMORY_OFF] = true;
+    spec->threads = 0;
+}
+
+static bool parse_bounded(const char *text, char **endptr, int min_val, int max_val, int *out) {
+    errno = 0;
+    long value = strtol(text, endptr, 10);
+    if (*endptr == text || errno == ERANGE || value < min_val || value > max_val) {
+        return false;
+    }
+    *out = (int)value;
+    return true;
+}
+
+bool sweep_parse_range(const char *text, int min_val, int max_val, SweepRange *range) {
+    char *end;
+    if (!parse_bounded(text, &end, min_val, max_val, &range->from)) return false;
+    range->to = range->from;
+    range->step = 1;
+
+    if (*end == ':') {
+        if (!parse_bounded(end + 1, &end, min_val, max_val, &range->to)) return false;
+        if (*end == ':') {
+            if (!parse_bounded(end + 1, &end, 1, max_val > 1 ? max_val : 1, &range->step)) return false;
+        }
+    }
+    return *end == '\0' && range->from <= range->to;
+}
+
+static long long range_length(const SweepRange *range) {
+    return (range->to - range->from) / range->step + 1;
+}
+
+long long sweep_size(const SweepSpec *spec) {
+    long long algorithms = 0;
+    long long memory = 0;
+    for (int a = 0; a < NUM_ALGORITHMS; a++) algorithms += spec->algorithms[a];
+    for (int m = 0; m < SWEEP_MEMORY_COUNT; m++) memory += spec->memory[m];
+    return algorithms * memory * range_length(&spec->quantum) *
+           range_length(&spec->overhead) * range_length(&spec->frames) * range_length(&spec->cpus);
+}
+
+static void write_row(FILE *out, const SweepPoint *point, const SweepResult *r) {
+    fprintf(out, "%s,%d,%d,%s,%d,%d,%.6f,%.6f,%.6f,%.6f,%.6f,%d,%d,%d,%d,%.6f,%.6f,%lld,%.6f,%d\n",
+            algorithm_keys[point->algorithm], point->quantum, point->overhead,
+            sweep_memory_key(point->memory), point->frames, point->cpus,
+            r->avg_execution, r->avg_wait, r->avg_turnaround,
+            r->throughput, r->idle_percentage, r->context_switches, r->migrations,
+            r->page_faults, r->opt_page_faults, r->avg_fault_wait, r->tlb_hit_rate,
+            r->tlb_stall_cycles, r->switch_stall_cycles, r->swap_outs);
+}
+
+static void run_point_task(void *arg) {
+    SweepJob *job = arg;
+    SweepRun *run = job->run;
+    const SweepPoint *point = &run->points[job->index];
+
+    SimContext *ctx = sim_context_create();
+    sim_context_copy_workload(ctx, run->base);
+    ctx->algorithm = point->algorithm;
+    ctx->quantum = point->quantum;
+    ctx->overhead_time = point->overhead;
+    ctx->memory_enabled = point->memory != SWEEP_MEMORY_OFF;
+    if (ctx->memory_enabled) ctx->replacement_policy = point->memory - 1;
+    ctx->num_frames = point->frames;
+    ctx->num_cpus = point->cpus;
+    ctx->keep_page_events = ctx->memory_enabled;  // replayed for opt_page_faults
+    ctx->keep_timelines = false;
+
+    reset_simulation(ctx);
+    run_current_algorithm(ctx);
+    const SummaryStats *s = &ctx->summary_stats;
+    run->results[job->index] = (SweepResult){s->avg_execution, s->avg_wait, s->avg_turnaround,
+                                             s->throughput, s->idle_percentage,
+                                             s->context_switches, s->migrations,
+                                             s->page_faults, s->opt_page_faults, s->avg_fault_wait,
+                                             s->tlb_hit_rate, s->tlb_stall_cycles,
+                                             s->switch_stall_cycles, s->swap_outs};
+    sim_context_destroy(ctx);
+
+    // Write every finished row that is next in grid order
+    pthread_mutex_lock(&run->lock);
+    run->done[job->index] = true;
+    bool wrote = false;
+    while (run->next_to_write < run->count && run->done[run->next_to_write]) {
+        write_row(run->out, &run->points[run->next_to_write], &run->results[run->next_to_write]);
+        run->next_to_write++;
+        wrote = true;
+    }
+    if (wrote) fflush(run->out);
+    pthread_mutex_unlock(&run->lock);
+}
+
+long long run_sweep(const SimContext *base, const SweepSpec *spec, FILE *out) {
+    SweepRun run;
+    run.base = base;
+    run.count = sweep_size(spec);
+    run.next_to_write = 0;
+    run.out = out;
+    run.points = malloc((run.count > 0 ? run.count : 1) * sizeof(SweepPoint));
+    run.results = malloc((run.count > 0 ? run.count : 1) * sizeof(SweepResult));
+    run.done = calloc(run.count > 0 ? run.count : 1, sizeof(bool));
+    SweepJob *jobs = malloc((run.count > 0 ? run.count : 1) * sizeof(SweepJob));
+    if (run.points == NULL || run.results == NULL || run.done == NULL || jobs == NULL) {
+        fprintf(stderr, "Error: Failed to allocate sweep of %lld configurations\n", run.count);
+        exit(1);
+    }
+    pthread_mutex_init(&run.lock, NULL);
+
+    // Grid order: algorithm, memory, frames, cpus, quantum, overhead
+    long long n = 0;
+    for (int a = 0; a < NUM_ALGORITHMS; a++) {
+        if (!spec->algorithms[a]) continue;
+        for (int m = 0; m < SWEEP_MEMORY_COUNT; m++) {
+            if (!spec->memory[m]) continue;
+            for (int f = spec->frames.from; f <= spec->frames.to; f += spec->frames.step) {
+                for (int c = spec->cpus.from; c <= spec->cpus.to; c += spec->cpus.step) {
+                    for (int q = spec->quantum.from; q <= spec->quantum.to; q += spec->quantum.step) {
+                        for (int o = spec->overhead.from; o <= spec->overhead.to; o += spec->overhead.step) {
+                            run.points[n] = (SweepPoint){a, q, o, (SweepMemory)m, f, c};
+                            n++;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    fprintf(out, "algorithm,quantum,overhead,memory,frames,cpus,avg_execution,avg_wait,"
+                 "avg_turnaround,throughput,idle_percentage,context_switches,migrations,"
+                 "page_faults,opt_page_faults,avg_fault_wait,tlb_hit_rate,tlb_stall_cycles,"
+                 "switch_stall_cycles,swap_outs\n");
+    fflush(out);
+
+    int threads = spec->threads > 0 ? spec->threads : thread_pool_default_size();
+    ThreadPool *pool = thread_pool_create(threads);
+    for (long long i = 0; i < run.count; i++) {
+        jobs[i].run = &run;
+        jobs[i].index = i;
+        thread_pool_submit(pool, run_point_task, &jobs[i]);
+    }
+    thread_pool_wait(pool);
+    thread_pool_destroy(pool);
+
+    pthread_mutex_destroy(&run.lock);
+    free(jobs);
+    free(run.done);
+    free(run.results);
+    free(run.points);
+    return run.next_to_write;
+}
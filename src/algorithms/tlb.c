@@ -0,0 +1,92 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "../../include/tlb.h"
+
+// Empty entries have last_use 0, so they are taken before any LRU victim
+static void empty_entry(TlbEntry *entry) {
+    entry->page = -1;
+    entry->last_use = 0;
+}
+
+static TlbEntry *alloc_entries(int count) {
+    TlbEntry *entries = malloc((size_t)count * sizeof(TlbEntry));
+    if (entries == NULL) {
+        fprintf(stderr, "Error: Failed to allocate %d TLB entries\n", count);
+        exit(1);
+    }
+    for (int e = 0; e < count; e++) {
+        empty_entry(&entries[e]);
+    }
+    return entries;
+}
+
+void tlb_init(Tlb *tlb, const SimContext *ctx) {
+    tlb_free(tlb);
+    tlb->entries = ctx->tlb_entries;
+    if (tlb->entries <= 0) return;
+
+    int ways = ctx->tlb_ways < 1 ? 1 : ctx->tlb_ways > tlb->entries ? tlb->entries : ctx->tlb_ways;
+    while (tlb->entries % ways != 0) ways--;
+    tlb->ways = ways;
+    tlb->sets = tlb->entries / ways;
+    tlb->num_cpus = ctx->num_cpus;
+    tlb->slots = alloc_entries(tlb->num_cpus * tlb->entries);
+    if (ctx->tlb_flush) tlb->shadow = alloc_entries(tlb->num_cpus * tlb->entries);
+}
+
+void tlb_free(Tlb *tlb) {
+    free(tlb->slots);
+    free(tlb->shadow);
+    *tlb = (Tlb){0};
+}
+
+// First entry of the set page_number maps to on a CPU
+static TlbEntry *set_of(const Tlb *tlb, TlbEntry *entries, int cpu, int page_number) {
+    return entries + ((long long)cpu * tlb->sets + page_number % tlb->sets) * tlb->ways;
+}
+
+static bool lookup_set(Tlb *tlb, TlbEntry *set, int page) {
+    TlbEntry *victim = set;
+    for (int w = 0; w < tlb->ways; w++) {
+        if (set[w].page == page) {
+            set[w].last_use = tlb->clock;
+            return true;
+        }
+        if (set[w].last_use < victim->last_use) victim = &set[w];
+    }
+    victim->page = page;
+    victim->last_use = tlb->clock;
+    return false;
+}
+
+bool tlb_lookup(Tlb *tlb, int cpu, int page_number, int page) {
+    tlb->clock++;
+    if (tlb->shadow != NULL && !lookup_set(tlb, set_of(tlb, tlb->shadow, cpu, page_number), page)) {
+        tlb->shadow_misses++;
+    }
+    if (lookup_set(tlb, set_of(tlb, tlb->slots, cpu, page_number), page)) return true;
+    tlb->misses++;
+    return false;
+}
+
+void tlb_flush(Tlb *tlb, int cpu) {
+    if (tlb->slots == NULL) return;
+    TlbEntry *entries = tlb->slots + (long long)cpu * tlb->entries;
+    for (int e = 0; e < tlb->entries; e++) {
+        empty_entry(&entries[e]);
+    }
+    tlb->flushes++;
+}
+
+void tlb_invalidate(Tlb *tlb, int page_number, int page) {
+    if (tlb->slots == NULL) return;
+    for (int c = 0; c < tlb->num_cpus; c++) {
+        TlbEntry *sets[2] = {set_of(tlb, tlb->slots, c, page_number),
+                             tlb->shadow != NULL ? set_of(tlb, tlb->shadow, c, page_number) : NULL};
+        for (int s = 0; s < 2 && sets[s] != NULL; s++) {
+            for (int w = 0; w < tlb->ways; w++) {
+                if (sets[s][w].page == page) empty_entry(&sets[s][w]);
+            }
+        }
+    }
+}
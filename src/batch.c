@@ -0,0 +1,681 @@
+#include <ctype.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include "../include/batch.h"
+#include "../include/compare.h"
+#include "../include/globals.h"
+#include "../include/miss_ratio.h"
+#include "../include/scheduler.h"
+#include "../include/process_table.h"
+#include "../include/sim_context.h"
+#include "../include/swap_device.h"
+#include "../include/sweep.h"
+#include "../include/trace.h"
+#include "../include/trace_import.h"
+#include "../include/workload.h"
+
+typedef enum {
+    FORMAT_CSV = 0,
+    FORMAT_JSON = 1
+} OutputFormat;
+
+static void print_usage(FILE *out, const char *prog) {
+    fprintf(out,
+        "Usage: %s --batch FILE [options]\n"
+        "       %s --trace FILE [options]\n"
+        "\n"
+        "Runs FILE (one process per line: arrival execution deadline priority\n"
+        "[pages [pattern]], '-' reads stdin) and prints per-process metrics and the\n"
+        "summary.\n"
+        "\n"
+        "--trace replays a `trace-cmd report` or `perf sched script` text trace\n"
+        "instead: every CPU burst of a task (wakeup until it blocks) is a process.\n"
+        "  --trace-tick US   trace microseconds per simulator tick (default: 1000)\n"
+        "  --trace-limit N   import at most N bursts (default: all)\n"
+        "\n"
+        "Options:\n"
+        "  --algo NAME       fifo, sjf, edf, rr, cfs, or all to run every algorithm\n"
+        "                    in parallel and print one summary row each (default: fifo)\n"
+        "  --quantum N       time slice for EDF/RR (default: 2)\n"
+        "  --overhead N      context switch time (default: 1)\n"
+        "  --time N          simulation horizon (default: long enough for every process)\n"
+        "  --memory POLICY   enable paging with fifo, lru, clock, wsclock, aging, lfu,\n"
+        "                    arc or opt (Belady) replacement (default: off); the\n"
+        "                    summary also gives the page faults of the run under opt\n"
+        "  --frames N        RAM frames available to paging, 1-%d (default: %d)\n"
+        "  --frame-size KB   size of a frame in KB (default: %d)\n"
+        "  --ram SIZE        RAM size instead of --frames, in KB or with a K, M, G\n"
+        "                    or T suffix (e.g. 512M, 4G)\n"
+        "  --access PATTERN  page referenced on each executed tick by processes whose\n"
+        "                    line names no pattern: seq, stride, random, zipf or\n"
+        "                    phases (default: seq)\n"
+        "  --max-pages N     pages a process may have, 1-%d (default: %d)\n"
+        "  --fault-time N    ticks to read a faulting page from swap, 0-%d; a fault\n"
+        "                    then blocks the process until its read is done\n"
+        "                    (default: 0, faults don't block; not with opt or --mrc)\n"
+        "  --disk ORDER      order of the pending swap reads: fcfs, sstf, scan or\n"
+        "                    clook (default: fcfs)\n"
+        "  --readahead N     largest window of pages read ahead of a sequential run,\n"
+        "                    0-%d, capped at a quarter of the RAM (default: 0,\n"
+        "                    demand paging only; opt never reads ahead)\n"
+        "  --tlb N           TLB entries per CPU, 0-%d, caching the translations of\n"
+        "                    resident pages; a miss stalls %d cycles (default: 0, no TLB)\n"
+        "  --tlb-ways N      TLB associativity, dividing --tlb (default: %d)\n"
+        "  --tlb-flush on|off  empty a CPU's TLB on each context switch (default: off)\n"
+        "  --allocation MODE frame allocation: global (any process may take any frame),\n"
+        "                    ws (resident sets trimmed to the working set) or pff\n"
+        "                    (allocations driven by the page fault frequency); with\n"
+        "                    --fault-time, processes are swapped out while their\n"
+        "                    demand exceeds the RAM (default: global; opt is global)\n"
+        "  --ws-window N     references a working set looks back, 1-%d (default: %d)\n"
+        "  --pff LOW:HIGH    PFF grows the allocation of a process whose faults come\n"
+        "                    less than LOW references apart and shrinks it past HIGH\n"
+        "                    (default: %d:%d)\n"
+        "  --cpus N          CPUs for RR and CFS, 1-%d (default: 1)\n"
+        "  --migration N     ticks a process spends moving to another CPU (default: 1)\n"
+        "  --format FMT      csv or json (default: csv)\n"
+        "  --mrc RATE        print the LRU miss-ratio curve of the page references\n"
+        "                    (frames,misses,miss_ratio) for every RAM size instead,\n"
+        "                    tracking a RATE fraction of the pages, 0-1 (1 = all)\n"
+        "  --chrome-trace FILE  also write the picks, preemptions, context switches,\n"
+        "                    faults and evictions of the run to FILE as Chrome\n"
+        "                    trace-event JSON (Perfetto), on simulated time and on\n"
+        "                    the simulator's wall clock\n"
+        "  --chrome-trace-size N  latest events the trace keeps, 1-%d (default: %d)\n"
+        "  --help            show this message\n"
+        "\n"
+        "Parameter sweep (any of these runs every combination and prints one CSV row\n"
+        "per configuration; ranges are A, A:B or A:B:STEP):\n"
+        "  --sweep-quantum R     quantum values\n"
+        "  --sweep-overhead R    context switch times\n"
+        "  --sweep-frames R      RAM frame counts\n"
+        "  --sweep-cpus R        CPU counts\n"
+        "  --sweep-memory LIST   comma separated off and replacement policies\n"
+        "  --threads N           worker threads (default: one per CPU)\n",
+        prog, prog, MAX_RAM_FRAMES, DEFAULT_RAM_FRAMES, DEFAULT_FRAME_SIZE_KB,
+        MAX_PAGES_LIMIT, DEFAULT_MAX_PAGES_PER_PROCESS, MAX_FAULT_TIME, MAX_READAHEAD_PAGES,
+        MAX_TLB_ENTRIES, TLB_MISS_CYCLES, DEFAULT_TLB_WAYS, MAX_WS_WINDOW, DEFAULT_WS_WINDOW,
+        DEFAULT_PFF_LOW, DEFAULT_PFF_HIGH, MAX_CPUS, MAX_TRACE_EVENTS, DEFAULT_TRACE_EVENTS);
+}
+
+static int parse_algorithm(const char *name) {
+    for (int i = 0; i < NUM_ALGORITHMS; i++) {
+        if (strcasecmp(name, algorithm_keys[i]) == 0) return i;
+    }
+    return -1;
+}
+
+static int parse_policy(const char *name) {
+    for (int i = 0; i < NUM_REPLACEMENT_POLICIES; i++) {
+        if (strcasecmp(name, replacement_policy_keys[i]) == 0) return i;
+    }
+    return -1;
+}
+
+static int parse_disk_schedule(const char *name) {
+    for (int i = 0; i < NUM_DISK_SCHEDULES; i++) {
+        if (strcasecmp(name, disk_schedule_keys[i]) == 0) return i;
+    }
+    return -1;
+}
+
+static int parse_frame_allocation(const char *name) {
+    for (int i = 0; i < NUM_FRAME_ALLOCATIONS; i++) {
+        if (strcasecmp(name, frame_allocation_keys[i]) == 0) return i;
+    }
+    return -1;
+}
+
+static bool parse_int_arg(const char *text, int min_val, int max_val, int *out) {
+    char *endptr;
+    long value = strtol(text, &endptr, 10);
+    if (endptr == text || *endptr != '\0' || value < min_val || value > max_val) {
+        return false;
+    }
+    *out = (int)value;
+    return true;
+}
+
+// PFF thresholds LOW:HIGH, 1 <= LOW <= HIGH <= MAX_WS_WINDOW
+static bool parse_pff_arg(const char *text, int *low, int *high) {
+    char *endptr;
+    long low_value = strtol(text, &endptr, 10);
+    if (endptr == text || *endptr != ':') return false;
+    const char *rest = endptr + 1;
+    long high_value = strtol(rest, &endptr, 10);
+    if (endptr == rest || *endptr != '\0' || low_value < 1 || low_value > high_value ||
+        high_value > MAX_WS_WINDOW) {
+        return false;
+    }
+    *low = (int)low_value;
+    *high = (int)high_value;
+    return true;
+}
+
+// Fraction in (0, 1]
+static bool parse_rate_arg(const char *text, double *out) {
+    char *endptr;
+    double value = strtod(text, &endptr);
+    if (endptr == text || *endptr != '\0' || !(value > 0.0 && value <= 1.0)) {
+        return false;
+    }
+    *out = value;
+    return true;
+}
+
+// Memory size in KB, with an optional K, M, G or T suffix (a trailing B is allowed)
+static bool parse_size_kb(const char *text, long long *out) {
+    char *endptr;
+    long long value = strtoll(text, &endptr, 10);
+    if (endptr == text || value < 1) return false;
+
+    const char *units = "KMGT";
+    const char *unit = *endptr != '\0' ? strchr(units, toupper((unsigned char)*endptr)) : units;
+    if (unit == NULL) return false;
+    if (*endptr != '\0') endptr++;
+    if (toupper((unsigned char)*endptr) == 'B') endptr++;
+    if (*endptr != '\0') return false;
+
+    for (int shift = (int)(unit - units); shift > 0; shift--) {
+        if (value > LLONG_MAX / 1024) return false;
+        value *= 1024;
+    }
+    *out = value;
+    return true;
+}
+
+// Horizon long enough for every process to finish even if each executed
+// tick were followed by a context switch of the given length and a blocking
+// fault: its trap tick, a seek across the whole swap device and the read
+static int default_horizon(const SimContext *ctx, int overhead) {
+    long long latest_arrival = 0;
+    long long pages = 0;
+    for (int i = 0; i < ctx->num_processes; i++) {
+        int num_pages = ctx->processes[i].num_pages;
+        pages += num_pages < ctx->max_pages_per_process ? num_pages : ctx->max_pages_per_process;
+    }
+    long long fault = ctx->fault_time > 0 ? 1 + ctx->fault_time + 2LL * swap_device_tracks(pages) : 0;
+
+    long long busy = 0;
+    for (int i = 0; i < ctx->num_processes; i++) {
+        if (ctx->processes[i].arrival_time > latest_arrival) latest_arrival = ctx->processes[i].arrival_time;
+        busy += (long long)ctx->processes[i].execution_time * (1 + overhead + fault);
+    }
+    long long horizon = latest_arrival + busy + 1;
+    return horizon > INT_MAX ? INT_MAX : (int)horizon;
+}
+
+#define SUMMARY_CSV_HEADER "algorithm,avg_execution,avg_wait,avg_turnaround,throughput,idle_percentage," \
+                           "context_switches,cpus,migrations,cpu_utilization,page_faults,opt_page_faults," \
+                           "avg_fault_wait,tlb_hit_rate,tlb_stall_cycles,switch_stall_cycles,swap_outs"
+
+// cpu_utilization is one field with the CPUs separated by ';'
+static void print_summary_csv(int algorithm, const SummaryStats *s) {
+    printf("%s,%.6f,%.6f,%.6f,%.6f,%.6f,%d,%d,%d,", algorithm_keys[algorithm],
+           s->avg_execution, s->avg_wait, s->avg_turnaround,
+           s->throughput, s->idle_percentage, s->context_switches,
+           s->num_cpus, s->migrations);
+    for (int c = 0; c < s->num_cpus; c++) {
+        printf("%s%.6f", c > 0 ? ";" : "", s->cpu_utilization[c]);
+    }
+    printf(",%d,%d,%.6f,%.6f,%lld,%.6f,%d\n", s->page_faults, s->opt_page_faults, s->avg_fault_wait,
+           s->tlb_hit_rate, s->tlb_stall_cycles, s->switch_stall_cycles, s->swap_outs);
+}
+
+static void print_summary_json(const SummaryStats *s) {
+    printf("{\"avg_execution\": %.6f, \"avg_wait\": %.6f, \"avg_turnaround\": %.6f, "
+           "\"throughput\": %.6f, \"idle_percentage\": %.6f, \"context_switches\": %d, "
+           "\"cpus\": %d, \"migrations\": %d, \"cpu_utilization\": [",
+           s->avg_execution, s->avg_wait, s->avg_turnaround,
+           s->throughput, s->idle_percentage, s->context_switches,
+           s->num_cpus, s->migrations);
+    for (int c = 0; c < s->num_cpus; c++) {
+        printf("%s%.6f", c > 0 ? ", " : "", s->cpu_utilization[c]);
+    }
+    printf("], \"page_faults\": %d, \"opt_page_faults\": %d, \"avg_fault_wait\": %.6f, "
+           "\"tlb_hit_rate\": %.6f, \"tlb_stall_cycles\": %lld, \"switch_stall_cycles\": %.6f, "
+           "\"swap_outs\": %d}",
+           s->page_faults, s->opt_page_faults, s->avg_fault_wait,
+           s->tlb_hit_rate, s->tlb_stall_cycles, s->switch_stall_cycles, s->swap_outs);
+}
+
+static void print_csv(const SimContext *ctx) {
+    printf("id,arrival,execution,deadline,priority,start,end,wait,turnaround,deadline_ok,page_faults,"
+           "prefetch_hits,prefetch_wasted,faults_saved,tlb_hit_rate,tlb_stall\n");
+    for (int i = 0; i < ctx->num_processes; i++) {
+        int *m = ctx->processes[i].metrics;
+        printf("%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d\n", ctx->processes[i].id,
+               m[MI_ARRIVAL], m[MI_EXECUTION], m[MI_DEADLINE], m[MI_PRIORITY],
+               m[MI_START], m[MI_END], m[MI_WAIT], m[MI_TURNAROUND],
+               m[MI_DEADLINE_OK], m[MI_PAGE_FAULTS],
+               m[MI_PREFETCH_HITS], m[MI_PREFETCH_WASTED], m[MI_FAULTS_SAVED],
+               m[MI_TLB_HIT_RATE], m[MI_TLB_STALL]);
+    }
+
+    printf("\n%s\n", SUMMARY_CSV_HEADER);
+    print_summary_csv(ctx->algorithm, &ctx->summary_stats);
+}
+
+static void print_json(const SimContext *ctx) {
+    printf("{\n  \"algorithm\": \"%s\",\n", algorithm_keys[ctx->algorithm]);
+    printf("  \"quantum\": %d,\n  \"overhead\": %d,\n  \"total_time\": %d,\n",
+           ctx->quantum, ctx->overhead_time, ctx->total_time);
+    printf("  \"cpus\": %d,\n  \"migration_cost\": %d,\n", ctx->num_cpus, ctx->migration_cost);
+    printf("  \"frames\": %d,\n  \"frame_size_kb\": %d,\n", ctx->num_frames, ctx->frame_size_kb);
+    printf("  \"fault_time\": %d,\n  \"disk\": \"%s\",\n", ctx->fault_time, disk_schedule_keys[ctx->disk_schedule]);
+    printf("  \"readahead\": %d,\n", ctx->readahead_pages);
+    printf("  \"tlb_entries\": %d,\n  \"tlb_ways\": %d,\n  \"tlb_flush\": %s,\n",
+           ctx->tlb_entries, ctx->tlb_ways, ctx->tlb_flush ? "true" : "false");
+    printf("  \"allocation\": \"%s\",\n  \"ws_window\": %d,\n  \"pff_low\": %d,\n  \"pff_high\": %d,\n",
+           frame_allocation_keys[ctx->frame_allocation], ctx->ws_window, ctx->pff_low, ctx->pff_high);
+    printf("  \"processes\": [");
+    for (int i = 0; i < ctx->num_processes; i++) {
+        int *m = ctx->processes[i].metrics;
+        printf("%s\n    {\"id\": %d, \"arrival\": %d, \"execution\": %d, \"deadline\": %d, "
+               "\"priority\": %d, \"start\": %d, \"end\": %d, \"wait\": %d, \"turnaround\": %d, "
+               "\"deadline_ok\": %s, \"page_faults\": %d, \"prefetch_hits\": %d, "
+               "\"prefetch_wasted\": %d, \"faults_saved\": %d, \"tlb_hit_rate\": %d, \"tlb_stall\": %d}",
+               i > 0 ? "," : "", ctx->processes[i].id,
+               m[MI_ARRIVAL], m[MI_EXECUTION], m[MI_DEADLINE], m[MI_PRIORITY],
+               m[MI_START], m[MI_END], m[MI_WAIT], m[MI_TURNAROUND],
+               m[MI_DEADLINE_OK] ? "true" : "false", m[MI_PAGE_FAULTS],
+               m[MI_PREFETCH_HITS], m[MI_PREFETCH_WASTED], m[MI_FAULTS_SAVED],
+               m[MI_TLB_HIT_RATE], m[MI_TLB_STALL]);
+    }
+    printf("\n  ],\n  \"summary\": ");
+    print_summary_json(&ctx->summary_stats);
+    printf("\n}\n");
+}
+
+// One summary per algorithm, all run on the same workload
+static void print_comparison(const SimContext *ctx, const SummaryStats results[NUM_ALGORITHMS],
+                             OutputFormat format) {
+    if (format == FORMAT_CSV) {
+        printf("%s\n", SUMMARY_CSV_HEADER);
+        for (int a = 0; a < NUM_ALGORITHMS; a++) {
+            print_summary_csv(a, &results[a]);
+        }
+        return;
+    }
+
+    printf("{\n  \"quantum\": %d,\n  \"overhead\": %d,\n  \"total_time\": %d,\n",
+           ctx->quantum, ctx->overhead_time, ctx->total_time);
+    printf("  \"cpus\": %d,\n  \"migration_cost\": %d,\n", ctx->num_cpus, ctx->migration_cost);
+    printf("  \"frames\": %d,\n  \"frame_size_kb\": %d,\n", ctx->num_frames, ctx->frame_size_kb);
+    printf("  \"fault_time\": %d,\n  \"disk\": \"%s\",\n", ctx->fault_time, disk_schedule_keys[ctx->disk_schedule]);
+    printf("  \"readahead\": %d,\n", ctx->readahead_pages);
+    printf("  \"tlb_entries\": %d,\n  \"tlb_ways\": %d,\n  \"tlb_flush\": %s,\n",
+           ctx->tlb_entries, ctx->tlb_ways, ctx->tlb_flush ? "true" : "false");
+    printf("  \"allocation\": \"%s\",\n  \"ws_window\": %d,\n  \"pff_low\": %d,\n  \"pff_high\": %d,\n",
+           frame_allocation_keys[ctx->frame_allocation], ctx->ws_window, ctx->pff_low, ctx->pff_high);
+    printf("  \"algorithms\": {");
+    for (int a = 0; a < NUM_ALGORITHMS; a++) {
+        printf("%s\n    \"%s\": ", a > 0 ? "," : "", algorithm_keys[a]);
+        print_summary_json(&results[a]);
+    }
+    printf("\n  }\n}\n");
+}
+
+// Options that are not part of the simulation configuration
+typedef struct {
+    const char *workload_path;
+    const char *trace_path;   // --trace replaces the workload file
+    TraceImportOptions trace;
+    int horizon;              // 0 picks default_horizon()
+    OutputFormat format;
+    bool compare_all;         // --algo all
+    bool sweep;               // some --sweep-* option was given
+    SweepSpec spec;           // grid, filled in once ctx has its final values
+    const char *sweep_quantum;
+    const char *sweep_overhead;
+    const char *sweep_frames;
+    const char *sweep_cpus;
+    const char *sweep_memory;
+    int threads;              // 0 = one per CPU
+    double mrc_sample_rate;   // --mrc, 0 when not asked for
+    const char *chrome_trace_path;  // NULL when not asked for
+    int chrome_trace_size;
+} BatchOptions;
+
+#define SWEEP_MAX_CONFIGURATIONS 10000000LL
+#define SWEEP_MAX_VALUE 1000000
+
+// Comma separated list of off and replacement policies
+static bool parse_memory_list(const char *text, bool memory[SWEEP_MEMORY_COUNT]) {
+    char buffer[128];
+    if (strlen(text) >= sizeof(buffer)) return false;
+    strcpy(buffer, text);
+
+    for (int m = 0; m < SWEEP_MEMORY_COUNT; m++) memory[m] = false;
+    int found = 0;
+    for (char *item = strtok(buffer, ","); item != NULL; item = strtok(NULL, ",")) {
+        int m = 0;
+        while (m < SWEEP_MEMORY_COUNT && strcasecmp(item, sweep_memory_key(m)) != 0) m++;
+        if (m == SWEEP_MEMORY_COUNT) return false;
+        memory[m] = true;
+        found++;
+    }
+    return found > 0;
+}
+
+// Build the sweep grid: axes without a range keep the single configured value
+static bool build_sweep_spec(const SimContext *ctx, BatchOptions *opts, const char **bad_option) {
+    SweepSpec *spec = &opts->spec;
+    sweep_spec_from_context(spec, ctx);
+    spec->threads = opts->threads;
+    if (opts->compare_all) {
+        for (int a = 0; a < NUM_ALGORITHMS; a++) spec->algorithms[a] = true;
+    }
+
+    if (opts->sweep_quantum != NULL &&
+        !sweep_parse_range(opts->sweep_quantum, 1, SWEEP_MAX_VALUE, &spec->quantum)) {
+        *bad_option = "--sweep-quantum";
+        return false;
+    }
+    if (opts->sweep_overhead != NULL &&
+        !sweep_parse_range(opts->sweep_overhead, 0, SWEEP_MAX_VALUE, &spec->overhead)) {
+        *bad_option = "--sweep-overhead";
+        return false;
+    }
+    if (opts->sweep_frames != NULL &&
+        !sweep_parse_range(opts->sweep_frames, 1, MAX_RAM_FRAMES, &spec->frames)) {
+        *bad_option = "--sweep-frames";
+        return false;
+    }
+    if (opts->sweep_cpus != NULL &&
+        !sweep_parse_range(opts->sweep_cpus, 1, MAX_CPUS, &spec->cpus)) {
+        *bad_option = "--sweep-cpus";
+        return false;
+    }
+    if (opts->sweep_memory != NULL && !parse_memory_list(opts->sweep_memory, spec->memory)) {
+        *bad_option = "--sweep-memory";
+        return false;
+    }
+    return true;
+}
+
+// Fill ctx and opts from the command line. Returns -1 to go on with the
+// run, otherwise the exit status.
+static int parse_options(int argc, char **argv, SimContext *ctx, BatchOptions *opts) {
+    long long ram_kb = 0;     // --ram, converted to frames once the frame size is known
+    bool frames_given = false;
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *value = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+        if (strcmp(arg, "--help") == 0 || strcmp(arg, "-h") == 0) {
+            print_usage(stdout, argv[0]);
+            return 0;
+        }
+        if (value == NULL) {
+            fprintf(stderr, "%s: missing value for %s\n", argv[0], arg);
+            print_usage(stderr, argv[0]);
+            return 2;
+        }
+
+        bool ok = true;
+        if (strcmp(arg, "--batch") == 0) {
+            opts->workload_path = value;
+        } else if (strcmp(arg, "--trace") == 0) {
+            opts->trace_path = value;
+        } else if (strcmp(arg, "--trace-tick") == 0) {
+            int microseconds;
+            ok = parse_int_arg(value, 1, INT_MAX, &microseconds);
+            opts->trace.tick_ns = microseconds * 1000LL;
+        } else if (strcmp(arg, "--trace-limit") == 0) {
+            ok = parse_int_arg(value, 1, INT_MAX, &opts->trace.max_processes);
+        } else if (strcmp(arg, "--algo") == 0) {
+            opts->compare_all = strcasecmp(value, "all") == 0;
+            ctx->algorithm = opts->compare_all ? 0 : parse_algorithm(value);
+            ok = ctx->algorithm >= 0;
+        } else if (strcmp(arg, "--quantum") == 0) {
+            ok = parse_int_arg(value, 1, INT_MAX, &ctx->quantum);
+        } else if (strcmp(arg, "--overhead") == 0) {
+            ok = parse_int_arg(value, 0, INT_MAX, &ctx->overhead_time);
+        } else if (strcmp(arg, "--time") == 0) {
+            ok = parse_int_arg(value, 1, INT_MAX, &opts->horizon);
+        } else if (strcmp(arg, "--memory") == 0) {
+            if (strcasecmp(value, "off") == 0) {
+                ctx->memory_enabled = false;
+            } else {
+                int policy = parse_policy(value);
+                ok = policy >= 0;
+                if (ok) {
+                    ctx->memory_enabled = true;
+                    ctx->replacement_policy = policy;
+                }
+            }
+        } else if (strcmp(arg, "--frames") == 0) {
+            ok = parse_int_arg(value, 1, MAX_RAM_FRAMES, &ctx->num_frames);
+            frames_given = true;
+        } else if (strcmp(arg, "--frame-size") == 0) {
+            ok = parse_int_arg(value, 1, MAX_FRAME_SIZE_KB, &ctx->frame_size_kb);
+        } else if (strcmp(arg, "--ram") == 0) {
+            ok = parse_size_kb(value, &ram_kb);
+        } else if (strcmp(arg, "--access") == 0) {
+            int pattern = parse_access_pattern(value);
+            ok = pattern >= 0;
+            if (ok) ctx->access_pattern = pattern;
+        } else if (strcmp(arg, "--max-pages") == 0) {
+            ok = parse_int_arg(value, 1, MAX_PAGES_LIMIT, &ctx->max_pages_per_process);
+        } else if (strcmp(arg, "--fault-time") == 0) {
+            ok = parse_int_arg(value, 0, MAX_FAULT_TIME, &ctx->fault_time);
+        } else if (strcmp(arg, "--disk") == 0) {
+            int schedule = parse_disk_schedule(value);
+            ok = schedule >= 0;
+            if (ok) ctx->disk_schedule = schedule;
+        } else if (strcmp(arg, "--readahead") == 0) {
+            ok = parse_int_arg(value, 0, MAX_READAHEAD_PAGES, &ctx->readahead_pages);
+        } else if (strcmp(arg, "--tlb") == 0) {
+            ok = parse_int_arg(value, 0, MAX_TLB_ENTRIES, &ctx->tlb_entries);
+        } else if (strcmp(arg, "--tlb-ways") == 0) {
+            ok = parse_int_arg(value, 1, MAX_TLB_ENTRIES, &ctx->tlb_ways);
+        } else if (strcmp(arg, "--tlb-flush") == 0) {
+            ok = strcasecmp(value, "on") == 0 || strcasecmp(value, "off") == 0;
+            ctx->tlb_flush = strcasecmp(value, "on") == 0;
+        } else if (strcmp(arg, "--allocation") == 0) {
+            int mode = parse_frame_allocation(value);
+            ok = mode >= 0;
+            if (ok) ctx->frame_allocation = mode;
+        } else if (strcmp(arg, "--ws-window") == 0) {
+            ok = parse_int_arg(value, 1, MAX_WS_WINDOW, &ctx->ws_window);
+        } else if (strcmp(arg, "--pff") == 0) {
+            ok = parse_pff_arg(value, &ctx->pff_low, &ctx->pff_high);
+        } else if (strcmp(arg, "--cpus") == 0) {
+            ok = parse_int_arg(value, 1, MAX_CPUS, &ctx->num_cpus);
+        } else if (strcmp(arg, "--migration") == 0) {
+            ok = parse_int_arg(value, 0, INT_MAX, &ctx->migration_cost);
+        } else if (strcmp(arg, "--sweep-quantum") == 0) {
+            opts->sweep_quantum = value;
+            opts->sweep = true;
+        } else if (strcmp(arg, "--sweep-overhead") == 0) {
+            opts->sweep_overhead = value;
+            opts->sweep = true;
+        } else if (strcmp(arg, "--sweep-frames") == 0) {
+            opts->sweep_frames = value;
+            opts->sweep = true;
+        } else if (strcmp(arg, "--sweep-cpus") == 0) {
+            opts->sweep_cpus = value;
+            opts->sweep = true;
+        } else if (strcmp(arg, "--sweep-memory") == 0) {
+            opts->sweep_memory = value;
+            opts->sweep = true;
+        } else if (strcmp(arg, "--mrc") == 0) {
+            ok = parse_rate_arg(value, &opts->mrc_sample_rate);
+        } else if (strcmp(arg, "--chrome-trace") == 0) {
+            opts->chrome_trace_path = value;
+        } else if (strcmp(arg, "--chrome-trace-size") == 0) {
+            ok = parse_int_arg(value, 1, MAX_TRACE_EVENTS, &opts->chrome_trace_size);
+        } else if (strcmp(arg, "--threads") == 0) {
+            ok = parse_int_arg(value, 1, 1024, &opts->threads);
+        } else if (strcmp(arg, "--format") == 0) {
+            if (strcasecmp(value, "csv") == 0) {
+                opts->format = FORMAT_CSV;
+            } else if (strcasecmp(value, "json") == 0) {
+                opts->format = FORMAT_JSON;
+            } else {
+                ok = false;
+            }
+        } else {
+            fprintf(stderr, "%s: unknown option %s\n", argv[0], arg);
+            print_usage(stderr, argv[0]);
+            return 2;
+        }
+
+        if (!ok) {
+            fprintf(stderr, "%s: invalid value '%s' for %s\n", argv[0], value, arg);
+            return 2;
+        }
+        i++;
+    }
+
+    if ((opts->workload_path == NULL) == (opts->trace_path == NULL)) {
+        print_usage(stderr, argv[0]);
+        return 2;
+    }
+
+    if (ram_kb > 0) {
+        long long frames = ram_kb / ctx->frame_size_kb;
+        if (frames_given || frames < 1 || frames > MAX_RAM_FRAMES) {
+            fprintf(stderr, "%s: --ram must hold 1-%d frames and cannot be combined with --frames\n",
+                    argv[0], MAX_RAM_FRAMES);
+            return 2;
+        }
+        ctx->num_frames = (int)frames;
+    }
+
+    if (ctx->tlb_entries % ctx->tlb_ways != 0) {
+        fprintf(stderr, "%s: --tlb must be a multiple of --tlb-ways\n", argv[0]);
+        return 2;
+    }
+
+    if (opts->mrc_sample_rate > 0 && (opts->sweep || opts->compare_all || opts->format != FORMAT_CSV)) {
+        fprintf(stderr, "%s: --mrc runs a single algorithm and only writes CSV\n", argv[0]);
+        return 2;
+    }
+
+    if (opts->chrome_trace_path != NULL && (opts->sweep || opts->compare_all)) {
+        fprintf(stderr, "%s: --chrome-trace runs a single algorithm\n", argv[0]);
+        return 2;
+    }
+
+    // OPT and the miss-ratio curve need a schedule that faults don't change
+    if (ctx->fault_time > 0 && (opts->mrc_sample_rate > 0 ||
+                                (ctx->memory_enabled && ctx->replacement_policy == POLICY_OPT))) {
+        fprintf(stderr, "%s: --fault-time cannot be combined with --memory opt or --mrc\n", argv[0]);
+        return 2;
+    }
+
+    if (opts->sweep) {
+        const char *bad_option = NULL;
+        if (!build_sweep_spec(ctx, opts, &bad_option)) {
+            fprintf(stderr, "%s: invalid range for %s\n", argv[0], bad_option);
+            return 2;
+        }
+        if (ctx->fault_time > 0 && opts->spec.memory[POLICY_OPT + 1]) {
+            fprintf(stderr, "%s: --fault-time cannot be combined with --memory opt\n", argv[0]);
+            return 2;
+        }
+        if (opts->format != FORMAT_CSV) {
+            fprintf(stderr, "%s: sweeps only write CSV\n", argv[0]);
+            return 2;
+        }
+        if (sweep_size(&opts->spec) > SWEEP_MAX_CONFIGURATIONS) {
+            fprintf(stderr, "%s: sweep of %lld configurations is too large (max %lld)\n",
+                    argv[0], sweep_size(&opts->spec), SWEEP_MAX_CONFIGURATIONS);
+            return 2;
+        }
+    }
+    return -1;
+}
+
+int run_batch(int argc, char **argv) {
+    BatchOptions opts;
+    memset(&opts, 0, sizeof(opts));
+    opts.format = FORMAT_CSV;
+    opts.chrome_trace_size = DEFAULT_TRACE_EVENTS;
+    trace_import_defaults(&opts.trace);
+    SimContext *ctx = sim_context_create();
+
+    int status = parse_options(argc, argv, ctx, &opts);
+    if (status >= 0) {
+        sim_context_destroy(ctx);
+        return status;
+    }
+
+    char err[256];
+    int loaded = opts.trace_path != NULL
+        ? load_sched_trace_file(ctx, opts.trace_path, &opts.trace, err, sizeof(err))
+        : load_workload_file(ctx, opts.workload_path, err, sizeof(err));
+    if (loaded < 0) {
+        fprintf(stderr, "%s: %s\n", argv[0], err);
+        sim_context_destroy(ctx);
+        return 1;
+    }
+
+    // Sweeps size the default horizon for their longest context switch;
+    // with several CPUs a tick may also be followed by a migration
+    int overhead = opts.sweep ? opts.spec.overhead.to : ctx->overhead_time;
+    int max_cpus = opts.sweep ? opts.spec.cpus.to : ctx->num_cpus;
+    if (max_cpus > 1 && overhead <= INT_MAX - ctx->migration_cost) overhead += ctx->migration_cost;
+    ctx->total_time = opts.horizon > 0 ? opts.horizon : default_horizon(ctx, overhead);
+    process_table_alloc_timelines(ctx);
+
+    if (opts.sweep) {
+        run_sweep(ctx, &opts.spec, stdout);
+        sim_context_destroy(ctx);
+        return 0;
+    }
+
+    if (opts.compare_all) {
+        SummaryStats results[NUM_ALGORITHMS];
+        compare_algorithms(ctx, results);
+        print_comparison(ctx, results, opts.format);
+        sim_context_destroy(ctx);
+        return 0;
+    }
+
+    if (opts.mrc_sample_rate > 0) {
+        // Non-blocking faults never change the schedule, so one run yields
+        // the reference stream of every RAM size
+        ctx->memory_enabled = true;
+        ctx->keep_miss_ratio_curve = true;
+        miss_ratio_init(&ctx->miss_ratio_curve, opts.mrc_sample_rate);
+    }
+
+    // Only metrics are printed
+    ctx->keep_timelines = false;
+
+    FILE *trace_out = NULL;
+    if (opts.chrome_trace_path != NULL) {
+        trace_out = fopen(opts.chrome_trace_path, "w");
+        if (trace_out == NULL) {
+            fprintf(stderr, "%s: cannot write %s\n", argv[0], opts.chrome_trace_path);
+            sim_context_destroy(ctx);
+            return 1;
+        }
+        trace_enable(&ctx->trace, opts.chrome_trace_size);
+    }
+
+    reset_simulation(ctx);
+    run_current_algorithm(ctx);
+
+    if (trace_out != NULL) {
+        trace_write_chrome(&ctx->trace, ctx, trace_out);
+        fclose(trace_out);
+    }
+
+    if (opts.mrc_sample_rate > 0) {
+        miss_ratio_write_csv(&ctx->miss_ratio_curve, stdout);
+    } else if (opts.format == FORMAT_JSON) {
+        print_json(ctx);
+    } else {
+        print_csv(ctx);
+    }
+
+    sim_context_destroy(ctx);
+    return 0;
+}
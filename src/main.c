@@ -6,15 +6,25 @@
 #include "../include/ui.h"
 #include "../include/config_ui.h"
 #include "../include/screen_utils.h"
+#include "../include/sim_context.h"
+#include "../include/batch.h"
+
+// Clear the last run and rewind the view to the first tick
+static void reset_view() {
+    reset_simulation(&sim);
+    current_time = 0;
+}
 
 void cleanup() {
-    for (int i = 0; i < num_processes; i++) {
-        free(processes[i].timeline);
-        free(processes[i].page_fault_occurred);
-    }
+    sim_context_free(&sim);
 }
 
-int main() {
+int main(int argc, char **argv) {
+    // Any command line argument selects the headless batch mode
+    if (argc > 1) {
+        return run_batch(argc, argv);
+    }
+
     setlocale(LC_ALL, "");
     initscr();
     cbreak();
@@ -38,8 +48,8 @@ int main() {
 
     show_configuration_screen();
 
-    if (num_processes == 0) {
-        initialize_default_processes();
+    if (sim.num_processes == 0) {
+        initialize_default_processes(&sim);
     }
 
     int running = 0;
@@ -57,15 +67,15 @@ int main() {
             case ' ':
                 running = !running;
                 if (running) {
-                    reset_simulation();
-                    run_current_algorithm();
+                    reset_view();
+                    run_current_algorithm(&sim);
                     // Sync memory frame with current time
                     memory_animation_frame = current_time;
                 }
                 break;
 
             case KEY_RIGHT:
-                if (current_time < TOTAL_TIME - 1) {
+                if (current_time < sim.total_time - 1) {
                     current_time++;
                     // Automatic Scroll when current_time is off screen
                     if (current_time >= time_offset + visible_columns) {
@@ -102,7 +112,7 @@ int main() {
 
             case '>':  // Navigate memory animation forward
             case '.':
-                if (memory_animation_frame < TOTAL_TIME - 1) {
+                if (memory_animation_frame < sim.total_time - 1) {
                     memory_animation_frame++;
                     follow_mode = false;
                 }
@@ -117,7 +127,7 @@ int main() {
 
             case 'd': // Right Scroll
             case 'D':
-                if (time_offset + visible_columns < TOTAL_TIME) {
+                if (time_offset + visible_columns < sim.total_time) {
                     time_offset++;
                 }
                 break;
@@ -134,42 +144,47 @@ int main() {
                 break;
 
             case 'e': // End - go to end
-                time_offset = TOTAL_TIME - visible_columns;
+                time_offset = sim.total_time - visible_columns;
                 if (time_offset < 0) time_offset = 0;
                 break;
 
             case 'm':
-                reset_simulation();
+                reset_view();
                 show_configuration_screen();
                 break;
 
+            case 'c': // Compare all algorithms side by side
+            case 'C':
+                show_comparison_screen();
+                break;
+
             case KEY_F(1):
-                current_algorithm = 0;
-                reset_simulation();
+                sim.algorithm = 0;
+                reset_view();
                 running = 0;
                 break;
 
             case KEY_F(2):
-                current_algorithm = 1;
-                reset_simulation();
+                sim.algorithm = 1;
+                reset_view();
                 running = 0;
                 break;
 
             case KEY_F(3):
-                current_algorithm = 2;
-                reset_simulation();
+                sim.algorithm = 2;
+                reset_view();
                 running = 0;
                 break;
 
             case KEY_F(4):
-                current_algorithm = 3;
-                reset_simulation();
+                sim.algorithm = 3;
+                reset_view();
                 running = 0;
                 break;
 
             case KEY_F(5):
-                current_algorithm = 4;
-                reset_simulation();
+                sim.algorithm = 4;
+                reset_view();
                 running = 0;
                 break;
         }
@@ -1,9 +1,12 @@
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include "../../include/config_ui.h"
 #include "../../include/globals.h"
 #include "../../include/ui.h"
 #include "../../include/screen_utils.h"
+#include "../../include/process_table.h"
+#include "../../include/memory.h"
 
 void show_error_message(const char* message) {
     int screen_height, screen_width;
@@ -87,6 +90,7 @@ int get_int_input(int y, int x, const char* prompt, int min_val, int max_val, in
 
 void edit_process_screen() {
     int selected_process = 0;
+    int list_offset = 0;  // first process shown when the list scrolls
     int ch;
     int screen_height, screen_width;
 
@@ -94,9 +98,18 @@ void edit_process_screen() {
         clear();
         getmaxyx(stdscr, screen_height, screen_width);
 
+        // Only as many rows as fit on screen; the list scrolls with the selection
+        int visible_rows = screen_height - 20;
+        if (visible_rows < 1) visible_rows = 1;
+        if (visible_rows > sim.num_processes) visible_rows = sim.num_processes;
+        if (selected_process < list_offset) list_offset = selected_process;
+        if (selected_process >= list_offset + visible_rows) list_offset = selected_process - visible_rows + 1;
+        if (list_offset < 0) list_offset = 0;
+        int selected_row = selected_process - list_offset;
+
         // Calculate centered position
-        int box_height = 15 + num_processes;
-        int box_width = 60;
+        int box_height = 15 + visible_rows;
+        int box_width = 70;
         int start_y = (screen_height - box_height) / 2;
         int start_x = (screen_width - box_width) / 2;
 
@@ -123,25 +136,34 @@ void edit_process_screen() {
         mvaddstr(start_y + 3, start_x + 26, "Deadline");
         mvaddstr(start_y + 3, start_x + 37, "Priority");
         mvaddstr(start_y + 3, start_x + 48, "Pages");
+        mvaddstr(start_y + 3, start_x + 56, "Pattern");
 
         // List processes
-        for (int i = 0; i < num_processes; i++) {
+        for (int row = 0; row < visible_rows; row++) {
+            int i = list_offset + row;
             if (i == selected_process) {
                 attron(A_REVERSE | COLOR_PAIR(GREEN));
             }
 
-            mvprintw(start_y + 5 + i, start_x + 2, "P%d", processes[i].id);
-            mvprintw(start_y + 5 + i, start_x + 8, "%d", processes[i].arrival_time);
-            mvprintw(start_y + 5 + i, start_x + 18, "%d", processes[i].execution_time);
-            mvprintw(start_y + 5 + i, start_x + 26, "%d", processes[i].deadline);
-            mvprintw(start_y + 5 + i, start_x + 37, "%d", processes[i].priority);
-            mvprintw(start_y + 5 + i, start_x + 48, "%d", processes[i].num_pages);
+            mvprintw(start_y + 5 + row, start_x + 2, "P%d", sim.processes[i].id);
+            mvprintw(start_y + 5 + row, start_x + 8, "%d", sim.processes[i].arrival_time);
+            mvprintw(start_y + 5 + row, start_x + 18, "%d", sim.processes[i].execution_time);
+            mvprintw(start_y + 5 + row, start_x + 26, "%d", sim.processes[i].deadline);
+            mvprintw(start_y + 5 + row, start_x + 37, "%d", sim.processes[i].priority);
+            mvprintw(start_y + 5 + row, start_x + 48, "%d", sim.processes[i].num_pages);
+            mvprintw(start_y + 5 + row, start_x + 56, "%s", access_pattern_names[sim.processes[i].access_pattern]);
 
             if (i == selected_process) {
                 attroff(A_REVERSE | COLOR_PAIR(GREEN));
             }
         }
 
+        // Scroll indicator if necessary
+        if (visible_rows < sim.num_processes) {
+            mvprintw(start_y + 5 + visible_rows, start_x + 2, "Showing %d-%d of %d",
+                     list_offset + 1, list_offset + visible_rows, sim.num_processes);
+        }
+
         // Controls (centered at bottom of box)
         int controls_y = start_y + box_height - 8;
         mvaddstr(controls_y, start_x + 2, "UP/DOWN: Select process");
@@ -149,6 +171,10 @@ void edit_process_screen() {
         mvaddstr(controls_y + 2, start_x + 2, "'A': Add new process");
         mvaddstr(controls_y + 3, start_x + 2, "'D': Delete process");
         mvaddstr(controls_y + 4, start_x + 2, "'M': Back to main menu");
+        mvaddstr(controls_y + 5, start_x + 2, "Patterns:");
+        for (int a = 0; a < NUM_ACCESS_PATTERNS; a++) {
+            printw(" %d=%s", a, access_pattern_names[a]);
+        }
 
         refresh();
 
@@ -158,108 +184,54 @@ void edit_process_screen() {
                 if (selected_process > 0) selected_process--;
                 break;
             case KEY_DOWN:
-                if (selected_process < num_processes - 1) selected_process++;
+                if (selected_process < sim.num_processes - 1) selected_process++;
                 break;
             case '\n': // ENTER key
             case KEY_ENTER:
-                if (num_processes > 0) {
+                if (sim.num_processes > 0) {
                     // Edit selected process (centered input)
-                    processes[selected_process].arrival_time = get_int_input(
-                        start_y + 5 + selected_process, start_x + 6,
-                        "", 0, TOTAL_TIME - 1,
-                        processes[selected_process].arrival_time
+                    sim.processes[selected_process].arrival_time = get_int_input(
+                        start_y + 5 + selected_row, start_x + 6,
+                        "", 0, sim.total_time - 1,
+                        sim.processes[selected_process].arrival_time
                     );
-                    processes[selected_process].execution_time = get_int_input(
-                        start_y + 5 + selected_process, start_x + 16,
-                        "", 1, TOTAL_TIME,
-                        processes[selected_process].execution_time
+                    sim.processes[selected_process].execution_time = get_int_input(
+                        start_y + 5 + selected_row, start_x + 16,
+                        "", 1, sim.total_time,
+                        sim.processes[selected_process].execution_time
                     );
-                    processes[selected_process].deadline = get_int_input(
-                        start_y + 5 + selected_process, start_x + 24,
-                        "", processes[selected_process].arrival_time + 1,
-                        TOTAL_TIME * 2, processes[selected_process].deadline
+                    sim.processes[selected_process].deadline = get_int_input(
+                        start_y + 5 + selected_row, start_x + 24,
+                        "", sim.processes[selected_process].arrival_time + 1,
+                        sim.total_time * 2, sim.processes[selected_process].deadline
                     );
-                    processes[selected_process].priority = get_int_input(
-                        start_y + 5 + selected_process, start_x + 35,
-                        "", 1, 10, processes[selected_process].priority
+                    sim.processes[selected_process].priority = get_int_input(
+                        start_y + 5 + selected_row, start_x + 35,
+                        "", 1, 10, sim.processes[selected_process].priority
                     );
-                    processes[selected_process].num_pages = get_int_input(
-                        start_y + 5 + selected_process, start_x + 46,
-                        "", 1, MAX_PAGES_PER_PROCESS,
-                        processes[selected_process].num_pages > 0 ? processes[selected_process].num_pages : 3
+                    sim.processes[selected_process].num_pages = get_int_input(
+                        start_y + 5 + selected_row, start_x + 46,
+                        "", 1, sim.max_pages_per_process,
+                        sim.processes[selected_process].num_pages > 0 ? sim.processes[selected_process].num_pages : 3
                     );
-                    processes[selected_process].remaining_time = processes[selected_process].execution_time;
+                    sim.processes[selected_process].access_pattern = get_int_input(
+                        start_y + 5 + selected_row, start_x + 54,
+                        "", 0, NUM_ACCESS_PATTERNS - 1, sim.processes[selected_process].access_pattern
+                    );
+                    sim.processes[selected_process].remaining_time = sim.processes[selected_process].execution_time;
                 }
                 break;
             case 'a':
             case 'A':
-                if (num_processes < MAX_PROCESSES) {
-                    int new_idx = num_processes;
-                    processes[new_idx].id = new_idx + 1;
-                    processes[new_idx].arrival_time = 0;
-                    processes[new_idx].execution_time = 1;
-                    processes[new_idx].remaining_time = 1;
-                    processes[new_idx].deadline = 10;
-                    processes[new_idx].priority = 1;
-                    processes[new_idx].final_status = PS_PENDING;
-                    processes[new_idx].timeline = NULL;
-                    processes[new_idx].page_fault_occurred = NULL;
-                    processes[new_idx].vruntime = 0.0;
-                    processes[new_idx].overhead = false;
-                    processes[new_idx].num_pages = 3; // Default to 3 pages
-                    processes[new_idx].page_faults = 0;
-                    processes[new_idx].page_fault_remaining = 0;
-                    processes[new_idx].next_page_to_access = 0;
-                    processes[new_idx].exec_units_since_page_access = 0;
-
-                    for (int p = 0; p < MAX_PAGES_PER_PROCESS; p++) {
-                        processes[new_idx].pages[p].in_ram = false;
-                        processes[new_idx].pages[p].frame_index = -1;
-                    }
-
-                    for (int m = 0; m < MI_COUNT; m++) {
-                        processes[new_idx].metrics[m] = 0;
-                    }
-                    num_processes++;
-                    selected_process = num_processes - 1;
-                }
+                process_table_add(&sim);
+                selected_process = sim.num_processes - 1;
                 break;
             case 'd':
             case 'D':
-                if (num_processes > 1) {
-                    // Free timeline and page_fault_occurred of the removed process (if allocated)
-                    if (processes[selected_process].timeline) {
-                        free(processes[selected_process].timeline);
-                        processes[selected_process].timeline = NULL;
-                    }
-                    if (processes[selected_process].page_fault_occurred) {
-                        free(processes[selected_process].page_fault_occurred);
-                        processes[selected_process].page_fault_occurred = NULL;
-                    }
-
-                    // Shift remaining processes left
-                    for (int i = selected_process; i < num_processes - 1; i++) {
-                        processes[i] = processes[i + 1];
-                        processes[i].id = i + 1;
-                    }
-
-                    // Clear the now-unused last slot to avoid dangling pointers
-                    processes[num_processes - 1].timeline = NULL;
-                    processes[num_processes - 1].page_fault_occurred = NULL;
-                    processes[num_processes - 1].id = 0;
-                    processes[num_processes - 1].arrival_time = 0;
-                    processes[num_processes - 1].execution_time = 0;
-                    processes[num_processes - 1].remaining_time = 0;
-                    processes[num_processes - 1].priority = 0;
-                    processes[num_processes - 1].deadline = 0;
-                    processes[num_processes - 1].final_status = PS_PENDING;
-                    for (int m = 0; m < MI_COUNT; m++) {
-                        processes[num_processes - 1].metrics[m] = 0;
-                    }
-
-                    num_processes--;
-                    if (selected_process >= num_processes) {
-                        selected_process = num_processes - 1;
+                if (sim.num_processes > 1) {
+                    process_table_remove(&sim, selected_process);
+                    if (selected_process >= sim.num_processes) {
+                        selected_process = sim.num_processes - 1;
                     }
                 }
                 break;
@@ -270,6 +242,17 @@ void edit_process_screen() {
     }
 }
 
+// RAM size in the largest unit that divides it exactly
+static void format_memory_size(char *buffer, size_t size, long long kb) {
+    const char *units[] = {"KB", "MB", "GB", "TB"};
+    int unit = 0;
+    while (unit < 3 && kb >= 1024 && kb % 1024 == 0) {
+        kb /= 1024;
+        unit++;
+    }
+    snprintf(buffer, size, "%lld %s", kb, units[unit]);
+}
+
 void show_main_menu() {
     int selected = 0;
     int ch;
@@ -279,10 +262,11 @@ void show_main_menu() {
         "Start Simulation",
         "Configure Processes",
         "Set Quantum & Overhead",
+        "Set CPUs & Migration",
         "Memory Configuration",
         "Exit"
     };
-    int menu_size = 5;
+    int menu_size = 6;
 
     while (1) {
         clear();
@@ -334,12 +318,15 @@ void show_main_menu() {
         }
 
         // Current configuration (centered)
-        mvaddstr(start_y + 10, start_x + 2, "Current Configuration:");
-        mvprintw(start_y + 11, start_x + 2, "Quantum: %d | Overhead: %d", quantum, overhead_time);
-        mvprintw(start_y + 12, start_x + 2, "Total Time: %d | Processes: %d", TOTAL_TIME, num_processes);
-        mvprintw(start_y + 13, start_x + 2, "Memory: %s | Policy: %s",
-                 memory_enabled ? "ON" : "OFF",
-                 replacement_policy == POLICY_FIFO ? "FIFO" : "LRU");
+        mvaddstr(start_y + 11, start_x + 2, "Current Configuration:");
+        mvprintw(start_y + 12, start_x + 2, "Quantum: %d | Overhead: %d", sim.quantum, sim.overhead_time);
+        mvprintw(start_y + 13, start_x + 2, "Total Time: %d | Processes: %d", sim.total_time, sim.num_processes);
+        char ram_size[24];
+        format_memory_size(ram_size, sizeof(ram_size), (long long)sim.num_frames * sim.frame_size_kb);
+        mvprintw(start_y + 14, start_x + 2, "Memory: %s | Policy: %s | RAM: %s",
+                 sim.memory_enabled ? "ON" : "OFF",
+                 replacement_policy_names[sim.replacement_policy], ram_size);
+        mvprintw(start_y + 15, start_x + 2, "CPUs: %d | Migration: %d", sim.num_cpus, sim.migration_cost);
 
         // Controls (centered at bottom)
         mvaddstr(start_y + box_height - 3, start_x + 2, "UP/DOWN: Navigate | ENTER: Select | Q: Quit");
@@ -368,34 +355,118 @@ void show_main_menu() {
                         edit_process_screen();
                         break;
                     case 2: // Set Quantum & Overhead
-                        quantum = get_int_input(
-                            start_y + 14, start_x + 17,
-                            "Quantum", 2, 10, quantum
+                        sim.quantum = get_int_input(
+                            start_y + 16, start_x + 17,
+                            "Quantum", 2, 10, sim.quantum
+                        );
+                        sim.overhead_time = get_int_input(
+                            start_y + 16, start_x + 17,
+                            "Overhead", 1, 5, sim.overhead_time
                         );
-                        overhead_time = get_int_input(
-                            start_y + 14, start_x + 17,
-                            "Overhead", 1, 5, overhead_time
+                        break;
+                    case 3: // Set CPUs & Migration (RR and CFS only)
+                        sim.num_cpus = get_int_input(
+                            start_y + 16, start_x + 17,
+                            "CPUs", 1, 8, sim.num_cpus
+                        );
+                        sim.migration_cost = get_int_input(
+                            start_y + 16, start_x + 17,
+                            "Migration", 0, 5, sim.migration_cost
                         );
                         break;
-                    case 3: // Memory Configuration
+                    case 4: // Memory Configuration
                         {
                             int mem_choice = 0;
                             clear();
                             mvaddstr(5, 5, "Memory Configuration");
                             mvaddstr(7, 5, "Enable Memory? (0=NO, 1=YES): ");
-                            mem_choice = get_int_input(7, 37, "", 0, 1, memory_enabled ? 1 : 0);
-                            memory_enabled = (mem_choice == 1);
+                            mem_choice = get_int_input(7, 37, "", 0, 1, sim.memory_enabled ? 1 : 0);
+                            sim.memory_enabled = (mem_choice == 1);
+
+                            if (sim.memory_enabled) {
+                                mvaddstr(9, 5, "Policies:");
+                                for (int p = 0; p < NUM_REPLACEMENT_POLICIES; p++) {
+                                    printw(" %d=%s", p, replacement_policy_names[p]);
+                                }
+                                sim.replacement_policy = get_int_input(
+                                    10, 5, "Policy", 0, NUM_REPLACEMENT_POLICIES - 1, sim.replacement_policy
+                                );
+
+                                sim.frame_size_kb = get_int_input(
+                                    12, 5, "Frame size in KB", 1, MAX_FRAME_SIZE_KB, sim.frame_size_kb
+                                );
+                                long long ram_kb = (long long)sim.num_frames * sim.frame_size_kb;
+                                int ram_input = get_int_input(
+                                    14, 5, "RAM size in KB", sim.frame_size_kb, 999999999,
+                                    ram_kb > 999999999 ? 999999999 : (int)ram_kb
+                                );
+                                long long frames = ram_input / sim.frame_size_kb;
+                                sim.num_frames = frames > MAX_RAM_FRAMES ? MAX_RAM_FRAMES : (int)frames;
+                                sim.max_pages_per_process = get_int_input(
+                                    16, 5, "Max pages per process", 1, MAX_PAGES_LIMIT, sim.max_pages_per_process
+                                );
 
-                            if (memory_enabled) {
-                                int policy_choice = get_int_input(
-                                    9, 5, "Policy (0=FIFO, 1=LRU)", 0, 1,
-                                    replacement_policy == POLICY_FIFO ? 0 : 1
+                                // Faults never block and nothing is read ahead under OPT
+                                if (sim.replacement_policy != POLICY_OPT) {
+                                    sim.fault_time = get_int_input(
+                                        18, 5, "Page read time (0 = faults don't block)", 0, MAX_FAULT_TIME, sim.fault_time
+                                    );
+                                    if (sim.fault_time > 0) {
+                                        mvaddstr(20, 5, "Disk scheduling:");
+                                        for (int d = 0; d < NUM_DISK_SCHEDULES; d++) {
+                                            printw(" %d=%s", d, disk_schedule_names[d]);
+                                        }
+                                        sim.disk_schedule = get_int_input(
+                                            21, 5, "Disk", 0, NUM_DISK_SCHEDULES - 1, sim.disk_schedule
+                                        );
+                                    }
+                                    sim.readahead_pages = get_int_input(
+                                        23, 5, "Readahead window in pages (0 = off)", 0, MAX_READAHEAD_PAGES,
+                                        sim.readahead_pages
+                                    );
+                                }
+                                sim.tlb_entries = get_int_input(
+                                    25, 5, "TLB entries per CPU (0 = no TLB)", 0, MAX_TLB_ENTRIES, sim.tlb_entries
                                 );
-                                replacement_policy = (policy_choice == 0) ? POLICY_FIFO : POLICY_LRU;
+                                if (sim.tlb_entries > 0) {
+                                    // Rounded down to a divisor of the entries by the TLB
+                                    sim.tlb_ways = get_int_input(
+                                        26, 5, "TLB ways", 1, sim.tlb_entries,
+                                        sim.tlb_ways < sim.tlb_entries ? sim.tlb_ways : sim.tlb_entries
+                                    );
+                                    sim.tlb_flush = get_int_input(
+                                        27, 5, "Flush TLB on context switch? (0=NO, 1=YES)", 0, 1, sim.tlb_flush ? 1 : 0
+                                    ) == 1;
+                                }
+                                // OPT always replaces over the whole RAM
+                                if (sim.replacement_policy != POLICY_OPT) {
+                                    mvaddstr(29, 5, "Frame allocation:");
+                                    for (int a = 0; a < NUM_FRAME_ALLOCATIONS; a++) {
+                                        printw(" %d=%s", a, frame_allocation_names[a]);
+                                    }
+                                    sim.frame_allocation = get_int_input(
+                                        30, 5, "Allocation", 0, NUM_FRAME_ALLOCATIONS - 1, sim.frame_allocation
+                                    );
+                                    if (sim.frame_allocation == ALLOCATION_WORKING_SET) {
+                                        sim.ws_window = get_int_input(
+                                            31, 5, "Working set window in references", 1, MAX_WS_WINDOW, sim.ws_window
+                                        );
+                                    } else if (sim.frame_allocation == ALLOCATION_PFF) {
+                                        sim.pff_low = get_int_input(
+                                            31, 5, "PFF: grow below this many references between faults", 1,
+                                            MAX_WS_WINDOW, sim.pff_low
+                                        );
+                                        sim.pff_high = get_int_input(
+                                            32, 5, "PFF: shrink above", sim.pff_low, MAX_WS_WINDOW,
+                                            sim.pff_high > sim.pff_low ? sim.pff_high : sim.pff_low
+                                        );
+                                    }
+                                }
+                                reset_ram_frames(&sim);
                             }
                         }
                         break;
-                    case 4: // Exit
+                    case 5: // Exit
                         endwin();
                         exit(0);
                 }
@@ -411,32 +482,12 @@ void show_main_menu() {
 
 void show_configuration_screen() {
     // Initialize default values if not set
-    if (quantum == 0) quantum = 2;
-    if (overhead_time == 0) overhead_time = 1;
+    if (sim.quantum == 0) sim.quantum = 2;
+    if (sim.overhead_time == 0) sim.overhead_time = 1;
 
     // Show main menu
     show_main_menu();
 
     // Re-initialize processes with new configuration
-    for (int i = 0; i < num_processes; i++) {
-        if (processes[i].timeline) {
-            free(processes[i].timeline);
-        }
-        if (processes[i].page_fault_occurred) {
-            free(processes[i].page_fault_occurred);
-        }
-        processes[i].timeline = malloc(TOTAL_TIME * sizeof(ProcessState));
-        processes[i].page_fault_occurred = malloc(TOTAL_TIME * sizeof(bool));
-        if (processes[i].timeline == NULL || processes[i].page_fault_occurred == NULL) {
-            // Malloc failed, exit gracefully
-            endwin();
-            fprintf(stderr, "Error: Failed to allocate memory for process timeline\n");
-            exit(1);
-        }
-        processes[i].remaining_time = processes[i].execution_time;
-        for (int t = 0; t < TOTAL_TIME; t++) {
-            processes[i].timeline[t] = NOT_ARRIVED;
-            processes[i].page_fault_occurred[t] = false;
-        }
-    }
+    process_table_alloc_timelines(&sim);
 }
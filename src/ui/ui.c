@@ -1,5 +1,11 @@
 #include "../../include/ui.h"
 #include "../../include/globals.h"
+#include "../../include/process_table.h"
+#include "../../include/timeline.h"
+#include "../../include/compare.h"
+#include "../../include/memory_history.h"
+#include <stdlib.h>
+#include <time.h>
 
 void draw_legend(int start_y, int start_x) {
     mvaddstr(start_y, start_x, "LEGEND:");
@@ -9,6 +15,7 @@ void draw_legend(int start_y, int start_x) {
     mvaddstr(start_y + 5, start_x, "[   ] - Page Fault");
     mvaddstr(start_y + 6, start_x, "[   ] - Deadline Missed");
     mvaddstr(start_y + 7, start_x, "[ | ] - Absolute Deadline");
+    mvaddstr(start_y + 8, start_x, "[ S ] - Swapped Out");
 
     // Legend colors
     attron(COLOR_PAIR(GREEN));
@@ -30,6 +37,63 @@ void draw_legend(int start_y, int start_x) {
     attron(COLOR_PAIR(WHITE));
     mvaddstr(start_y + 6, start_x + 1, "   ");
     attroff(COLOR_PAIR(WHITE));
+
+    attron(COLOR_PAIR(YELLOW));
+    mvaddstr(start_y + 8, start_x + 1, " S ");
+    attroff(COLOR_PAIR(YELLOW));
+}
+
+// Rows the per-CPU lanes take below the process rows (none on one CPU)
+static int gantt_cpu_rows() {
+    return sim.num_cpus > 1 ? sim.num_cpus + 1 : 0;
+}
+
+// One lane per CPU showing which process holds it: green while executing,
+// red during a context switch or migration
+static void draw_cpu_lanes(int start_y, int start_x, int start_time, int end_time) {
+    int lane_process[MAX_CPUS];
+    ProcessState lane_state[MAX_CPUS];
+
+    for (int c = 0; c < sim.num_cpus; c++) {
+        mvprintw(start_y + c, start_x, "CPU%d:", c);
+    }
+
+    for (int t = start_time; t < end_time; t++) {
+        int screen_col = start_x + 8 + (t - time_offset) * CELL_WIDTH;
+
+        for (int c = 0; c < sim.num_cpus; c++) lane_process[c] = -1;
+        if (t <= current_time) {
+            for (int i = 0; i < sim.num_processes; i++) {
+                const Timeline *tl = &sim.processes[i].timeline;
+                int r = timeline_find_run(tl, t);
+                if (r < 0 || tl->runs[r].cpu >= sim.num_cpus) continue;
+                ProcessState state = tl->runs[r].state;
+                if (state == EXECUTING || state == DEADLINE_MISSED || state == OVERHEAD) {
+                    lane_process[tl->runs[r].cpu] = i;
+                    lane_state[tl->runs[r].cpu] = state;
+                }
+            }
+        }
+
+        if (t == current_time) {
+            attron(A_BOLD);
+        }
+        for (int c = 0; c < sim.num_cpus; c++) {
+            if (lane_process[c] == -1) {
+                attron(COLOR_PAIR(GRAY));
+                mvprintw(start_y + c, screen_col, "%-*s", CELL_WIDTH - 1, t > current_time ? "__" : "");
+                attroff(COLOR_PAIR(GRAY));
+                continue;
+            }
+            int color = lane_state[c] == OVERHEAD ? RED : GREEN;
+            attron(COLOR_PAIR(color));
+            mvprintw(start_y + c, screen_col, "%*d", CELL_WIDTH - 1, sim.processes[lane_process[c]].id % 100);
+            attroff(COLOR_PAIR(color));
+        }
+        if (t == current_time) {
+            attroff(A_BOLD);
+        }
+    }
 }
 
 void draw_gantt_chart(int start_y, int start_x) {
@@ -39,7 +103,7 @@ void draw_gantt_chart(int start_y, int start_x) {
     // Get visible range
     int start_time = time_offset;
     int end_time = time_offset + visible_columns;
-    if (end_time > TOTAL_TIME) end_time = TOTAL_TIME;
+    if (end_time > sim.total_time) end_time = sim.total_time;
 
     // Show only visible columns
     for (int t = start_time; t < end_time; t++) {
@@ -58,13 +122,13 @@ void draw_gantt_chart(int start_y, int start_x) {
     if (time_offset > 0) {
         mvaddstr(start_y, start_x + 6, "<");
     }
-    if (end_time < TOTAL_TIME) {
+    if (end_time < sim.total_time) {
         mvaddstr(start_y, start_x + 10 + visible_columns * CELL_WIDTH - 2, ">");
     }
 
     // Process rows - only visible columns
-    for (int i = 0; i < num_processes; i++) {
-        mvprintw(start_y + 2 + i, start_x, "P%d: ", processes[i].id);
+    for (int i = 0; i < sim.num_processes; i++) {
+        mvprintw(start_y + 2 + i, start_x, "P%d: ", sim.processes[i].id);
 
         for (int t = start_time; t < end_time; t++) {
             int screen_col = start_x + 8 + (t - time_offset) * CELL_WIDTH;
@@ -77,15 +141,14 @@ void draw_gantt_chart(int start_y, int start_x) {
                 color = 1; // Gray
                 cell_char = '_';
             } else {
-                switch (processes[i].timeline[t]) {
+                switch (timeline_state_at(&sim.processes[i].timeline, t)) {
                     case NOT_ARRIVED:
                         color = 1; // Gray
                         break;
                     case EXECUTING:
                         color = 2; // Green
                         // Check if page fault occurred during execution
-                        if (memory_enabled && processes[i].page_fault_occurred &&
-                            processes[i].page_fault_occurred[t]) {
+                        if (sim.memory_enabled && timeline_fault_at(&sim.processes[i].timeline, t)) {
                             show_page_fault = true;
                         }
                         break;
@@ -104,6 +167,10 @@ void draw_gantt_chart(int start_y, int start_x) {
                     case PAGE_FAULT:
                         color = 6; // Cyan
                         break;
+                    case SUSPENDED:
+                        color = 3; // Yellow, waiting for memory
+                        cell_char = 'S';
+                        break;
                 }
             }
 
@@ -128,9 +195,9 @@ void draw_gantt_chart(int start_y, int start_x) {
 
             // Here it considers the absolute deadline of each process by the calculation in abs_dead
             // Draws a vertical marker immediately to the right of the square and labels it with the process ID.
-            int abs_dead = (processes[i].arrival_time + processes[i].deadline) - 1;
+            int abs_dead = (sim.processes[i].arrival_time + sim.processes[i].deadline) - 1;
             // This condition ensures that the marker only appears in the EDF
-            if (t == abs_dead && current_algorithm == 2) {
+            if (t == abs_dead && sim.algorithm == 2) {
                 int marker_col = screen_col + (CELL_WIDTH - 1); // Column immediately after the square
                 mvaddch(start_y + 2 + i, marker_col, ACS_VLINE);
             }
@@ -141,10 +208,14 @@ void draw_gantt_chart(int start_y, int start_x) {
         }
     }
 
+    if (sim.num_cpus > 1) {
+        draw_cpu_lanes(start_y + sim.num_processes + 3, start_x, start_time, end_time);
+    }
+
     // Show scroll information
-    mvprintw(start_y + num_processes + 3, start_x,
+    mvprintw(start_y + sim.num_processes + 3 + gantt_cpu_rows(), start_x,
              "Showing time %d to %d (Total: %d)",
-             start_time, end_time - 1, TOTAL_TIME);
+             start_time, end_time - 1, sim.total_time);
 }
 
 
@@ -165,7 +236,7 @@ void draw_interface() {
 
     // Title
     attron(A_BOLD | COLOR_PAIR(WHITE));
-    mvprintw(1, 2, "CPU SCHEDULING ALGORITHM SIMULATOR - %s", algorithm_names[current_algorithm]);
+    mvprintw(1, 2, "CPU SCHEDULING ALGORITHM SIMULATOR - %s", algorithm_names[sim.algorithm]);
     attroff(A_BOLD | COLOR_PAIR(WHITE));
 
     // Gantt chart
@@ -175,19 +246,21 @@ void draw_interface() {
     // Legend
     draw_legend(4, 75);
 
-    // Controls
-    mvaddstr(15, 2, "CONTROLS:");
-    mvaddstr(16, 2, "F1-F5: Select algorithm (FIFO, SJF, EDF, RR, CFS)");
-    mvaddstr(17, 2, "SPACE: Run/Reset simulation");
-    mvaddstr(18, 2, "RIGHT|RIGHT ARROW: Advance or go back in time");
-    mvaddstr(19, 2, "A|D: Scroll chart left and right");
-    mvaddstr(20, 2, "H: Go to start, E: Go to end");
-    mvaddstr(21, 2, "M: Configuration Menu");
-    mvaddstr(22, 2, "Q: Quit");
+    // Controls, below the CPU lanes if there are any
+    int controls_y = 15 + gantt_cpu_rows();
+    mvaddstr(controls_y, 2, "CONTROLS:");
+    mvaddstr(controls_y + 1, 2, "F1-F5: Select algorithm (FIFO, SJF, EDF, RR, CFS)");
+    mvaddstr(controls_y + 2, 2, "SPACE: Run/Reset simulation");
+    mvaddstr(controls_y + 3, 2, "RIGHT|RIGHT ARROW: Advance or go back in time");
+    mvaddstr(controls_y + 4, 2, "A|D: Scroll chart left and right");
+    mvaddstr(controls_y + 5, 2, "H: Go to start, E: Go to end");
+    mvaddstr(controls_y + 6, 2, "M: Configuration Menu");
+    mvaddstr(controls_y + 7, 2, "C: Compare all algorithms");
+    mvaddstr(controls_y + 8, 2, "Q: Quit");
 
     // Metrics table (shown after simulation finishes / when computed)
-    int metrics_start_y = 24;
-    if (metrics_computed) {
+    int metrics_start_y = controls_y + 9;
+    if (sim.metrics_computed) {
         // Title
         attron(A_BOLD);
         mvprintw(metrics_start_y, 2, "METRICS:");
@@ -217,9 +290,9 @@ void draw_interface() {
         for (int c = 0; c < max_cols; c++) {
             int col_start = table_start_x + left_w + c * col_w;
             mvaddch(header_row, col_start + col_w, ACS_VLINE);
-            if (c < num_processes) {
+            if (c < sim.num_processes) {
                 mvprintw(header_row, col_start + 1, "%-*s", col_w - 1, "");
-                mvprintw(header_row, col_start + 1, "P%d", processes[c].id);
+                mvprintw(header_row, col_start + 1, "P%d", sim.processes[c].id);
             }
         }
 
@@ -228,22 +301,24 @@ void draw_interface() {
         for (int x = table_start_x + 1; x < table_start_x + table_width; x++) mvaddch(header_row + 1, x, ACS_HLINE);
         mvaddch(header_row + 1, table_start_x + table_width, ACS_RTEE);
 
-        // Metric labels (rows) with borders
+        // Metric labels (rows) with borders. The readahead metrics don't fit,
+        // their totals go on the summary.
+        int table_rows = MI_PAGE_FAULTS + 1;
         const char *labels[MI_COUNT] = {
             "Arrival", "Execution", "Deadline", "Priority",
             "Start", "End", "Wait", "Turnaround", "Deadline?", "PgFaults"
         };
 
-        for (int r = 0; r < MI_COUNT; r++) {
+        for (int r = 0; r < table_rows; r++) {
             int row_y = first_metric_row + r;
 
             // Left vertical border and metric name
             mvaddch(row_y, table_start_x, ACS_VLINE);
 
             // Skip deadline_ok label if not EDF algorithm, but still draw empty space
-            if (r == MI_DEADLINE_OK && current_algorithm != 2) {
+            if (r == MI_DEADLINE_OK && sim.algorithm != 2) {
                 mvprintw(row_y, table_start_x + 1, "%-*s", left_w - 1, ""); // Empty label
-            } else if (r == MI_PAGE_FAULTS && !memory_enabled) {
+            } else if (r == MI_PAGE_FAULTS && !sim.memory_enabled) {
                 mvprintw(row_y, table_start_x + 1, "%-*s", left_w - 1, ""); // Empty label
             } else {
                 mvprintw(row_y, table_start_x + 1, "%-*s", left_w - 1, labels[r]);
@@ -255,12 +330,12 @@ void draw_interface() {
             for (int c = 0; c < max_cols; c++) {
                 int col_start = table_start_x + left_w + c * col_w;
                 // content area is col_start +1 .. col_start + col_w -1
-                if (c < num_processes) {
-                    int *m = processes[c].metrics;
-                    if (r == MI_DEADLINE_OK && current_algorithm != 2) {
+                if (c < sim.num_processes) {
+                    int *m = sim.processes[c].metrics;
+                    if (r == MI_DEADLINE_OK && sim.algorithm != 2) {
                         // Empty cell for deadline_ok when not EDF
                         mvprintw(row_y, col_start + 1, "%-*s", col_w - 1, "");
-                    } else if (r == MI_PAGE_FAULTS && !memory_enabled) {
+                    } else if (r == MI_PAGE_FAULTS && !sim.memory_enabled) {
                         // Empty cell for page faults when memory not enabled
                         mvprintw(row_y, col_start + 1, "%-*s", col_w - 1, "");
                     } else if (r == MI_START) {
@@ -283,7 +358,7 @@ void draw_interface() {
 
             // Draw separator line below this row
             int sep_y = row_y + 1;
-            if (r < MI_COUNT - 1) {
+            if (r < table_rows - 1) {
                 mvaddch(sep_y, table_start_x, ACS_LTEE);
                 for (int x = table_start_x + 1; x < table_start_x + table_width; x++) mvaddch(sep_y, x, ACS_HLINE);
                 mvaddch(sep_y, table_start_x + table_width, ACS_RTEE);
@@ -296,26 +371,70 @@ void draw_interface() {
         }
 
         // Current time indicator placed after the table
-        mvprintw(first_metric_row + MI_COUNT + 2, 2, "Current Time: %d", current_time);
+        mvprintw(first_metric_row + table_rows + 2, 2, "Current Time: %d", current_time);
 
-        if (current_algorithm == 2 || current_algorithm == 3) {
-            mvprintw(first_metric_row + MI_COUNT + 2, 20, "Quantum: %d", quantum);
-            mvprintw(first_metric_row + MI_COUNT + 2, 34, "Overhead: %d", overhead_time);
+        if (sim.algorithm == 2 || sim.algorithm == 3) {
+            mvprintw(first_metric_row + table_rows + 2, 20, "Quantum: %d", sim.quantum);
+            mvprintw(first_metric_row + table_rows + 2, 34, "Overhead: %d", sim.overhead_time);
         }
 
         // Summary statistics (quantitative summary)
-        int summary_y = first_metric_row + MI_COUNT + 4;
+        int summary_y = first_metric_row + table_rows + 4;
         attron(A_BOLD);
         mvaddstr(summary_y, 2, "SUMMARY:");
         attroff(A_BOLD);
 
         mvprintw(summary_y + 1, 2, "Average Execution Time: %.2f  |  Average Waiting Time: %.2f  |  Average Turnaround: %.2f",
-                 summary_stats.avg_execution, summary_stats.avg_wait, summary_stats.avg_turnaround);
+                 sim.summary_stats.avg_execution, sim.summary_stats.avg_wait, sim.summary_stats.avg_turnaround);
         mvprintw(summary_y + 2, 2, "Throughput: %.4f process / time unit  |  Idleness: %.2f%%  |  Context Switches: %d",
-                 summary_stats.throughput, summary_stats.idle_percentage, summary_stats.context_switches);
+                 sim.summary_stats.throughput, sim.summary_stats.idle_percentage, sim.summary_stats.context_switches);
+        if (sim.memory_enabled && sim.tlb_entries > 0 && sim.tlb_flush) {
+            // What a switch really costs once the flushed TLB refills
+            printw("  |  Switch Cost: %d ticks + %.1f stall cycles",
+                   sim.overhead_time, sim.summary_stats.switch_stall_cycles);
+        }
+
+        if (sim.num_cpus > 1) {
+            mvprintw(summary_y + 3, 2, "CPUs: %d  |  Migrations: %d  |  Utilization:",
+                     sim.num_cpus, sim.summary_stats.migrations);
+            int x = getcurx(stdscr);
+            for (int c = 0; c < sim.num_cpus && x < screen_width - 16; c++) {
+                mvprintw(summary_y + 3, x, " CPU%d %.1f%%", c, sim.summary_stats.cpu_utilization[c]);
+                x = getcurx(stdscr);
+            }
+        }
+
+        if (sim.memory_enabled) {
+            mvprintw(summary_y + (sim.num_cpus > 1 ? 4 : 3), 2,
+                     "Page Faults: %d  |  Under OPT: %d  |  Gap to OPT: %d",
+                     sim.summary_stats.page_faults, sim.summary_stats.opt_page_faults,
+                     sim.summary_stats.page_faults - sim.summary_stats.opt_page_faults);
+            if (sim.fault_time > 0 && sim.replacement_policy != POLICY_OPT) {
+                printw("  |  Avg Fault Wait: %.2f", sim.summary_stats.avg_fault_wait);
+            }
+            if (sim.readahead_pages > 0 && sim.replacement_policy != POLICY_OPT) {
+                int hits = 0, wasted = 0, saved = 0;
+                for (int i = 0; i < sim.num_processes; i++) {
+                    hits += sim.processes[i].metrics[MI_PREFETCH_HITS];
+                    wasted += sim.processes[i].metrics[MI_PREFETCH_WASTED];
+                    saved += sim.processes[i].metrics[MI_FAULTS_SAVED];
+                }
+                printw("  |  Readahead: %d hits, %d wasted, %d faults saved", hits, wasted, saved);
+            }
+            if (sim.frame_allocation != ALLOCATION_GLOBAL && sim.replacement_policy != POLICY_OPT) {
+                printw("  |  %s: %d swap-outs", frame_allocation_names[sim.frame_allocation],
+                       sim.summary_stats.swap_outs);
+            }
+            if (sim.tlb_entries > 0) {
+                mvprintw(summary_y + (sim.num_cpus > 1 ? 5 : 4), 2,
+                         "TLB: %d entries, %d-way  |  Hit Rate: %.2f%%  |  Stall: %lld cycles",
+                         sim.tlb.entries, sim.tlb.ways, sim.summary_stats.tlb_hit_rate,
+                         sim.summary_stats.tlb_stall_cycles);
+            }
+        }
 
         // Memory visualization (if enabled)
-        if (memory_enabled) {
+        if (sim.memory_enabled) {
             draw_memory_visualization(4, 110);
         }
     } else {
@@ -326,6 +445,19 @@ void draw_interface() {
     refresh();
 }
 
+// Whether the process with this id executes on some CPU at tick t
+static bool executing_at(int proc_id, int t) {
+    int i = process_index_by_id(&sim, proc_id);
+    if (i < 0 || t < 0 || t >= sim.total_time) return false;
+    return timeline_state_at(&sim.processes[i].timeline, t) == EXECUTING;
+}
+
+// Id of the process owning a frame right now, -1 if free
+static int frame_process_id(int frame_index) {
+    int i = sim.ram_frames[frame_index].process_index;
+    return i >= 0 && i < sim.num_processes ? sim.processes[i].id : -1;
+}
+
 void draw_memory_visualization(int start_y, int start_x) {
     int x = start_x;
     int y = start_y;
@@ -337,26 +469,14 @@ void draw_memory_visualization(int start_y, int start_x) {
     // Display controls
     mvprintw(y, x + 40, "[< >: Navigate | /: Follow]");
 
-    // Determine which process is currently executing at this frame
-    int executing_process = -1;
-    if (memory_animation_frame >= 0 && memory_animation_frame < TOTAL_TIME) {
-        for (int i = 0; i < num_processes; i++) {
-            if (processes[i].timeline &&
-                processes[i].timeline[memory_animation_frame] == EXECUTING) {
-                executing_process = processes[i].id;
-                break;
-            }
-        }
-    }
 
     // Use historical RAM state if available, otherwise use current state
-    bool use_history = history_initialized &&
-                       memory_animation_frame >= 0 &&
-                       memory_animation_frame < MAX_HISTORY_SIZE;
+    const FrameSnapshot *history = memory_history_at(&sim.memory_history, memory_animation_frame);
+    int shown_frames = history != NULL ? sim.memory_history.num_frames : sim.num_frames;
 
-    // RAM Grid (50 frames = 10 cols x 5 rows)
+    // RAM Grid (first 50 frames = 10 cols x 5 rows)
     attron(A_BOLD);
-    mvprintw(y + 2, x, "RAM (50 Frames):");
+    mvprintw(y + 2, x, "RAM (%d Frames x %d KB):", sim.num_frames, sim.frame_size_kb);
     attroff(A_BOLD);
 
     int ram_y = y + 3;
@@ -365,14 +485,15 @@ void draw_memory_visualization(int start_y, int start_x) {
     for (int row = 0; row < 5; row++) {
         for (int col = 0; col < 10; col++) {
             int frame_idx = row * 10 + col;
+            if (frame_idx >= shown_frames) continue;
             int pos_y = ram_y + row;
             int pos_x = ram_x + col * 5;  // 5 chars spacing for better visualization
 
             int proc_id = -1;
-            if (use_history) {
-                proc_id = ram_history[memory_animation_frame][frame_idx].process_id;
+            if (history != NULL) {
+                proc_id = history[frame_idx].process_id;
             } else {
-                proc_id = ram_frames[frame_idx].process_id;
+                proc_id = frame_process_id(frame_idx);
             }
 
             if (proc_id == -1) {
@@ -383,14 +504,15 @@ void draw_memory_visualization(int start_y, int start_x) {
             } else {
                 // Frame occupied
                 // Green only if this process is currently executing
-                if (proc_id == executing_process) {
+                bool executing = executing_at(proc_id, memory_animation_frame);
+                if (executing) {
                     attron(COLOR_PAIR(GREEN));  // Green - executing
                 } else {
                     attron(COLOR_PAIR(YELLOW));  // Yellow - occupied but not executing
                 }
                 mvprintw(pos_y, pos_x, "[%d]", proc_id);
 
-                if (proc_id == executing_process) {
+                if (executing) {
                     attroff(COLOR_PAIR(GREEN));
                 } else {
                     attroff(COLOR_PAIR(YELLOW));
@@ -399,61 +521,43 @@ void draw_memory_visualization(int start_y, int start_x) {
         }
     }
 
-    // Disk visualization - show processes NOT in RAM at this frame
+    // Disk visualization - show pages NOT in RAM at this frame
     int disk_y = ram_y + 7;
     attron(A_BOLD);
     mvprintw(disk_y, x, "DISK:");
     attroff(A_BOLD);
 
-    // Build set of processes in RAM at this frame
-    bool process_in_ram[MAX_PROCESSES] = {false};
-    if (use_history) {
-        for (int f = 0; f < TOTAL_RAM_FRAMES; f++) {
-            int proc_id = ram_history[memory_animation_frame][f].process_id;
-            if (proc_id > 0 && proc_id <= MAX_PROCESSES) {
-                // Find process index by id
-                for (int p = 0; p < num_processes; p++) {
-                    if (processes[p].id == proc_id) {
-                        process_in_ram[p] = true;
-                        break;
-                    }
-                }
-            }
-        }
-    } else {
-        for (int f = 0; f < TOTAL_RAM_FRAMES; f++) {
-            int proc_id = ram_frames[f].process_id;
-            if (proc_id > 0 && proc_id <= MAX_PROCESSES) {
-                for (int p = 0; p < num_processes; p++) {
-                    if (processes[p].id == proc_id) {
-                        process_in_ram[p] = true;
-                        break;
-                    }
-                }
-            }
+    // Count the pages of each process in RAM at this frame
+    int *pages_in_ram = calloc(sim.num_processes > 0 ? sim.num_processes : 1, sizeof(int));
+    if (pages_in_ram == NULL) return;
+    for (int f = 0; f < shown_frames; f++) {
+        // Find process index by id
+        int p = history != NULL ? process_index_by_id(&sim, history[f].process_id)
+                                : sim.ram_frames[f].process_index;
+        if (p >= 0 && p < sim.num_processes) {
+            pages_in_ram[p]++;
         }
     }
 
-    // Disk Grid - show processes not in RAM
+    // Disk Grid - show pages not in RAM
     int disk_grid_y = disk_y + 1;
     int disk_grid_x = x + 2;
     int disk_items_shown = 0;
 
-    // Show each process that's in DISK (not in RAM)
-    for (int i = 0; i < num_processes; i++) {
+    // One square per page of each process that's in DISK (not in RAM)
+    for (int i = 0; i < sim.num_processes; i++) {
         // Check if process has arrived at this frame
-        bool has_arrived = memory_animation_frame >= processes[i].arrival_time;
+        bool has_arrived = memory_animation_frame >= sim.processes[i].arrival_time;
 
-        if (has_arrived && !process_in_ram[i] && processes[i].num_pages > 0) {
-            // Show process pages in disk
-            for (int p = 0; p < processes[i].num_pages && disk_items_shown < 50; p++) {
+        if (has_arrived) {
+            for (int p = pages_in_ram[i]; p < sim.processes[i].num_pages && disk_items_shown < 50; p++) {
                 int row = disk_items_shown / 10;
                 int col = disk_items_shown % 10;
                 int pos_y = disk_grid_y + row;
                 int pos_x = disk_grid_x + col * 5;
 
                 attron(COLOR_PAIR(RED));  // Red for disk
-                mvprintw(pos_y, pos_x, "[%d]", processes[i].id);
+                mvprintw(pos_y, pos_x, "[%d]", sim.processes[i].id);
                 attroff(COLOR_PAIR(RED));
 
                 disk_items_shown++;
@@ -479,13 +583,98 @@ void draw_memory_visualization(int start_y, int start_x) {
     mvprintw(pf_y, x, "Page Faults by Process:");
     attroff(A_BOLD);
 
-    for (int i = 0; i < num_processes; i++) {
-        mvprintw(pf_y + 1 + i, x + 2, "P%d: %d faults",
-            processes[i].id, processes[i].page_faults);
+    for (int i = 0; i < sim.num_processes; i++) {
+        mvprintw(pf_y + 1 + i, x + 2, "P%d: %d faults | %d/%d pages in RAM (%s)",
+            sim.processes[i].id, sim.processes[i].page_faults, pages_in_ram[i],
+            sim.processes[i].num_pages, access_pattern_names[sim.processes[i].access_pattern]);
     }
+    free(pages_in_ram);
 
     // Memory policy info
-    int policy_y = pf_y + num_processes + 2;
-    mvprintw(policy_y, x, "Policy: %s",
-        replacement_policy == POLICY_FIFO ? "FIFO" : "LRU");
+    int policy_y = pf_y + sim.num_processes + 2;
+    mvprintw(policy_y, x, "Policy: %s", replacement_policy_names[sim.replacement_policy]);
+    if (sim.fault_time > 0 && sim.replacement_policy != POLICY_OPT) {
+        printw("  |  Swap: %s, %d ticks per read", disk_schedule_names[sim.disk_schedule], sim.fault_time);
+    }
+}
+
+// Column of the comparison table where algorithm a is best
+static bool is_best(const SummaryStats results[NUM_ALGORITHMS], int a, int column) {
+    for (int b = 0; b < NUM_ALGORITHMS; b++) {
+        const SummaryStats *x = &results[a];
+        const SummaryStats *y = &results[b];
+        switch (column) {
+            case 0: if (y->avg_wait < x->avg_wait) return false; break;
+            case 1: if (y->avg_turnaround < x->avg_turnaround) return false; break;
+            case 2: if (y->throughput > x->throughput) return false; break;
+            case 3: if (y->idle_percentage < x->idle_percentage) return false; break;
+            case 4: if (y->context_switches < x->context_switches) return false; break;
+        }
+    }
+    return true;
+}
+
+// Run all algorithms on the current workload at once and show their
+// summaries side by side until a key is pressed
+void show_comparison_screen() {
+    SummaryStats results[NUM_ALGORITHMS];
+    struct timespec started, finished;
+
+    clear();
+    mvaddstr(2, 2, "Running all algorithms...");
+    refresh();
+
+    clock_gettime(CLOCK_MONOTONIC, &started);
+    int workers = compare_algorithms(&sim, results);
+    clock_gettime(CLOCK_MONOTONIC, &finished);
+    double elapsed_ms = (finished.tv_sec - started.tv_sec) * 1000.0 +
+                        (finished.tv_nsec - started.tv_nsec) / 1e6;
+
+    clear();
+    attron(A_BOLD | COLOR_PAIR(WHITE));
+    mvaddstr(1, 2, "ALGORITHM COMPARISON");
+    attroff(A_BOLD | COLOR_PAIR(WHITE));
+    mvprintw(3, 2, "Processes: %d | Quantum: %d | Overhead: %d | Total Time: %d | Memory: %s",
+             sim.num_processes, sim.quantum, sim.overhead_time, sim.total_time,
+             sim.memory_enabled ? replacement_policy_names[sim.replacement_policy] : "OFF");
+
+    const char *headers[] = {"Avg Wait", "Avg Turnaround", "Throughput", "Idle %", "Ctx Switches"};
+    int name_w = 14;
+    int col_w = 16;
+    int header_y = 5;
+
+    attron(A_BOLD);
+    mvprintw(header_y, 2, "%-*s", name_w, "Algorithm");
+    for (int c = 0; c < 5; c++) {
+        mvprintw(header_y, 2 + name_w + c * col_w, "%-*s", col_w, headers[c]);
+    }
+    attroff(A_BOLD);
+    mvhline(header_y + 1, 2, ACS_HLINE, name_w + 5 * col_w);
+
+    for (int a = 0; a < NUM_ALGORITHMS; a++) {
+        int row = header_y + 2 + a;
+        const SummaryStats *s = &results[a];
+        char cells[5][32];
+        snprintf(cells[0], sizeof(cells[0]), "%.2f", s->avg_wait);
+        snprintf(cells[1], sizeof(cells[1]), "%.2f", s->avg_turnaround);
+        snprintf(cells[2], sizeof(cells[2]), "%.4f", s->throughput);
+        snprintf(cells[3], sizeof(cells[3]), "%.2f%%", s->idle_percentage);
+        snprintf(cells[4], sizeof(cells[4]), "%d", s->context_switches);
+
+        mvprintw(row, 2, "%-*s", name_w, algorithm_names[a]);
+        for (int c = 0; c < 5; c++) {
+            // Best value of each column in green
+            bool best = is_best(results, a, c);
+            if (best) attron(COLOR_PAIR(GREEN));
+            mvprintw(row, 2 + name_w + c * col_w, "%-*s", col_w - 2, cells[c]);
+            if (best) attroff(COLOR_PAIR(GREEN));
+        }
+    }
+
+    int footer_y = header_y + 3 + NUM_ALGORITHMS;
+    mvprintw(footer_y, 2, "Computed in %.1f ms on %d threads", elapsed_ms, workers);
+    mvaddstr(footer_y + 2, 2, "Press any key to return");
+    refresh();
+
+    getch();
 }
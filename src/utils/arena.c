@@ -0,0 +1,75 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "../../include/arena.h"
+
+#define ARENA_ALIGN 16
+#define ARENA_MIN_BLOCK (64 * 1024)
+
+static size_t align_up(size_t size) {
+    return (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+}
+
+static size_t header_size() {
+    return align_up(sizeof(ArenaBlock));
+}
+
+static ArenaBlock *new_block(size_t capacity, ArenaBlock *next) {
+    ArenaBlock *block = malloc(header_size() + capacity);
+    if (block == NULL) {
+        fprintf(stderr, "Error: Failed to allocate arena block of %zu bytes\n", capacity);
+        exit(1);
+    }
+    block->next = next;
+    block->used = 0;
+    block->capacity = capacity;
+    return block;
+}
+
+void arena_init(Arena *arena) {
+    arena->head = NULL;
+    arena->total_used = 0;
+}
+
+void *arena_alloc(Arena *arena, size_t size) {
+    size = align_up(size > 0 ? size : 1);
+
+    ArenaBlock *block = arena->head;
+    if (block == NULL || block->capacity - block->used < size) {
+        // Grow geometrically so the number of blocks stays logarithmic
+        size_t capacity = block ? block->capacity * 2 : ARENA_MIN_BLOCK;
+        if (capacity < size) capacity = size;
+        block = new_block(capacity, arena->head);
+        arena->head = block;
+    }
+
+    void *ptr = (char *)block + header_size() + block->used;
+    block->used += size;
+    arena->total_used += size;
+    return ptr;
+}
+
+// Forget every allocation but keep the memory: the blocks are merged into a
+// single block big enough for everything handed out before the reset
+void arena_reset(Arena *arena) {
+    if (arena->head == NULL) return;
+
+    if (arena->head->next != NULL) {
+        size_t capacity = arena->total_used;
+        arena_release(arena);
+        arena->head = new_block(capacity, NULL);
+    }
+    arena->head->used = 0;
+    arena->total_used = 0;
+}
+
+// Free every block at once
+void arena_release(Arena *arena) {
+    ArenaBlock *block = arena->head;
+    while (block != NULL) {
+        ArenaBlock *next = block->next;
+        free(block);
+        block = next;
+    }
+    arena->head = NULL;
+    arena->total_used = 0;
+}
@@ -0,0 +1,96 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "../../include/event_queue.h"
+
+static bool event_before(const Event *a, const Event *b) {
+    if (a->time != b->time) return a->time < b->time;
+    return a->seq < b->seq;
+}
+
+static void sift_up(EventQueue *queue, int pos) {
+    Event ev = queue->heap[pos];
+    while (pos > 0) {
+        int parent = (pos - 1) / 2;
+        if (!event_before(&ev, &queue->heap[parent])) break;
+        queue->heap[pos] = queue->heap[parent];
+        pos = parent;
+    }
+    queue->heap[pos] = ev;
+}
+
+static void sift_down(EventQueue *queue, int pos) {
+    Event ev = queue->heap[pos];
+    for (;;) {
+        int child = 2 * pos + 1;
+        if (child >= queue->size) break;
+        if (child + 1 < queue->size && event_before(&queue->heap[child + 1], &queue->heap[child])) {
+            child++;
+        }
+        if (!event_before(&queue->heap[child], &ev)) break;
+        queue->heap[pos] = queue->heap[child];
+        pos = child;
+    }
+    queue->heap[pos] = ev;
+}
+
+void event_queue_init(EventQueue *queue, int capacity) {
+    if (capacity < 16) capacity = 16;
+    queue->heap = malloc(capacity * sizeof(Event));
+    if (queue->heap == NULL) {
+        fprintf(stderr, "Error: Failed to allocate event queue\n");
+        exit(1);
+    }
+    queue->size = 0;
+    queue->capacity = capacity;
+    queue->next_seq = 0;
+}
+
+void event_queue_free(EventQueue *queue) {
+    free(queue->heap);
+    queue->heap = NULL;
+    queue->size = 0;
+    queue->capacity = 0;
+}
+
+void event_queue_push(EventQueue *queue, int time, EventType type, int process, int generation) {
+    if (queue->size == queue->capacity) {
+        int new_capacity = queue->capacity * 2;
+        Event *grown = realloc(queue->heap, new_capacity * sizeof(Event));
+        if (grown == NULL) {
+            fprintf(stderr, "Error: Failed to grow event queue\n");
+            exit(1);
+        }
+        queue->heap = grown;
+        queue->capacity = new_capacity;
+    }
+
+    Event *ev = &queue->heap[queue->size];
+    ev->time = time;
+    ev->type = type;
+    ev->process = process;
+    ev->generation = generation;
+    ev->seq = queue->next_seq++;
+    sift_up(queue, queue->size++);
+}
+
+bool event_queue_empty(const EventQueue *queue) {
+    return queue->size == 0;
+}
+
+// Time of the earliest pending event (-1 if the queue is empty)
+int event_queue_next_time(const EventQueue *queue) {
+    return queue->size > 0 ? queue->heap[0].time : -1;
+}
+
+// Pop the earliest event only if it fires at the given tick
+bool event_queue_pop_at(EventQueue *queue, int time, Event *out) {
+    if (queue->size == 0 || queue->heap[0].time != time) {
+        return false;
+    }
+    *out = queue->heap[0];
+    queue->heap[0] = queue->heap[--queue->size];
+    if (queue->size > 0) {
+        sift_down(queue, 0);
+    }
+    return true;
+}
@@ -0,0 +1,161 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../../include/memory_history.h"
+
+// Shortest change log between keyframes, so tiny RAMs are not copied every tick
+#define MIN_KEYFRAME_INTERVAL 256
+
+void memory_history_init(MemoryHistory *history) {
+    memset(history, 0, sizeof(*history));
+    history->cursor_time = -1;
+}
+
+static void free_keyframes(MemoryHistory *history) {
+    for (int k = 0; k < history->num_keyframes; k++) {
+        free(history->keyframes[k].frames);
+    }
+    history->num_keyframes = 0;
+}
+
+void memory_history_free(MemoryHistory *history) {
+    free_keyframes(history);
+    free(history->keyframes);
+    free(history->changes);
+    free(history->cursor);
+    memory_history_init(history);
+}
+
+static void push_keyframe(MemoryHistory *history, int time_unit, FrameSnapshot *frames) {
+    if (history->num_keyframes == history->keyframes_capacity) {
+        int new_capacity = history->keyframes_capacity > 0 ? history->keyframes_capacity * 2 : 8;
+        MemoryKeyframe *grown = realloc(history->keyframes, new_capacity * sizeof(MemoryKeyframe));
+        if (grown == NULL) {
+            fprintf(stderr, "Error: Failed to grow memory history keyframes\n");
+            exit(1);
+        }
+        history->keyframes = grown;
+        history->keyframes_capacity = new_capacity;
+    }
+    MemoryKeyframe *keyframe = &history->keyframes[history->num_keyframes++];
+    keyframe->time = time_unit;
+    keyframe->first_change = history->num_changes;
+    keyframe->frames = frames;
+}
+
+void memory_history_reset(MemoryHistory *history, int num_frames) {
+    free_keyframes(history);
+    history->num_changes = 0;
+    history->time = 0;
+    history->end_time = 0;
+    if (num_frames != history->num_frames) {
+        free(history->cursor);
+        history->cursor = NULL;
+        history->num_frames = num_frames;
+    }
+    history->cursor_time = -1;
+
+    // The RAM starts empty; a NULL keyframe stands for all frames free
+    push_keyframe(history, 0, NULL);
+}
+
+// Overwrite out with the contents of a keyframe
+static void load_keyframe(const MemoryHistory *history, const MemoryKeyframe *keyframe, FrameSnapshot *out) {
+    if (keyframe->frames != NULL) {
+        memcpy(out, keyframe->frames, history->num_frames * sizeof(FrameSnapshot));
+        return;
+    }
+    for (int f = 0; f < history->num_frames; f++) {
+        out[f].process_id = -1;
+        out[f].page_number = -1;
+    }
+}
+
+static FrameSnapshot *alloc_frames(const MemoryHistory *history) {
+    FrameSnapshot *frames = malloc(history->num_frames * sizeof(FrameSnapshot));
+    if (frames == NULL) {
+        fprintf(stderr, "Error: Failed to allocate memory history keyframe\n");
+        exit(1);
+    }
+    return frames;
+}
+
+void memory_history_advance(MemoryHistory *history, int time_unit) {
+    if (time_unit <= history->time) return;
+
+    // Enough changes since the last keyframe: fold them into a new one, so
+    // the keyframes never take more memory than the log itself
+    const MemoryKeyframe *last = &history->keyframes[history->num_keyframes - 1];
+    size_t interval = history->num_frames > MIN_KEYFRAME_INTERVAL ? history->num_frames : MIN_KEYFRAME_INTERVAL;
+    if (history->num_changes - last->first_change >= interval) {
+        FrameSnapshot *frames = alloc_frames(history);
+        load_keyframe(history, last, frames);
+        for (size_t c = last->first_change; c < history->num_changes; c++) {
+            frames[history->changes[c].frame] = history->changes[c].value;
+        }
+        push_keyframe(history, time_unit, frames);
+    }
+    history->time = time_unit;
+}
+
+void memory_history_record(MemoryHistory *history, int frame, int process_id, int page_number) {
+    if (history->num_changes == history->changes_capacity) {
+        size_t new_capacity = history->changes_capacity > 0 ? history->changes_capacity * 2 : 64;
+        FrameChange *grown = realloc(history->changes, new_capacity * sizeof(FrameChange));
+        if (grown == NULL) {
+            fprintf(stderr, "Error: Failed to grow memory history to %zu changes\n", new_capacity);
+            exit(1);
+        }
+        history->changes = grown;
+        history->changes_capacity = new_capacity;
+    }
+    FrameChange *change = &history->changes[history->num_changes++];
+    change->time = history->time;
+    change->frame = frame;
+    change->value.process_id = process_id;
+    change->value.page_number = page_number;
+
+    if (history->cursor_time >= history->time) history->cursor_time = -1;
+}
+
+void memory_history_finish(MemoryHistory *history, int end_time) {
+    history->end_time = end_time;
+}
+
+const FrameSnapshot *memory_history_at(MemoryHistory *history, int time_unit) {
+    if (history->num_keyframes == 0 || history->num_frames <= 0 ||
+        time_unit < 0 || time_unit >= history->end_time) {
+        return NULL;
+    }
+    if (history->cursor == NULL) {
+        history->cursor = alloc_frames(history);
+    }
+
+    // Last keyframe at or before the tick
+    int lo = 0;
+    int hi = history->num_keyframes - 1;
+    while (lo < hi) {
+        int mid = (lo + hi + 1) / 2;
+        if (history->keyframes[mid].time <= time_unit) {
+            lo = mid;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    const MemoryKeyframe *keyframe = &history->keyframes[lo];
+
+    // Replay from the cursor when it is already past the keyframe
+    bool forward = history->cursor_time >= 0 && history->cursor_time <= time_unit &&
+                   history->cursor_next >= keyframe->first_change;
+    if (!forward) {
+        load_keyframe(history, keyframe, history->cursor);
+        history->cursor_next = keyframe->first_change;
+    }
+    while (history->cursor_next < history->num_changes &&
+           history->changes[history->cursor_next].time <= time_unit) {
+        const FrameChange *change = &history->changes[history->cursor_next++];
+        history->cursor[change->frame] = change->value;
+    }
+    history->cursor_time = time_unit;
+    return history->cursor;
+}
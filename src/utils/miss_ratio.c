@@ -0,0 +1,231 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../../include/miss_ratio.h"
+
+void miss_ratio_init(MissRatioCurve *mrc, double sample_rate) {
+    memset(mrc, 0, sizeof(*mrc));
+    mrc->sample_rate = sample_rate;
+    mrc->sample_threshold = (unsigned long long)(sample_rate * 4294967296.0);
+    mrc->root = -1;
+}
+
+void miss_ratio_free(MissRatioCurve *mrc) {
+    free(mrc->page_node);
+    free(mrc->nodes);
+    free(mrc->histogram);
+    miss_ratio_init(mrc, mrc->sample_rate);
+}
+
+void miss_ratio_reset(MissRatioCurve *mrc, int num_pages) {
+    if (num_pages > mrc->num_pages) {
+        free(mrc->page_node);
+        mrc->page_node = malloc((size_t)num_pages * sizeof(int));
+        if (mrc->page_node == NULL) {
+            fprintf(stderr, "Error: Failed to allocate miss-ratio curve for %d pages\n", num_pages);
+            exit(1);
+        }
+    }
+    mrc->num_pages = num_pages;
+    for (int p = 0; p < num_pages; p++) {
+        mrc->page_node[p] = -1;
+    }
+    mrc->num_nodes = 0;
+    mrc->root = -1;
+    mrc->time = 0;
+    mrc->references = 0;
+    mrc->cold_misses = 0;
+    mrc->max_distance = 0;
+    if (mrc->histogram != NULL) {
+        memset(mrc->histogram, 0, mrc->histogram_capacity * sizeof(long long));
+    }
+}
+
+// Spatial hash of a page (murmur3 finalizer), so a page is either always or
+// never tracked
+static unsigned int page_hash(unsigned int x) {
+    x ^= x >> 16;
+    x *= 0x85ebca6bu;
+    x ^= x >> 13;
+    x *= 0xc2b2ae35u;
+    x ^= x >> 16;
+    return x;
+}
+
+static int node_size(const MissRatioCurve *mrc, int t) {
+    return t == -1 ? 0 : mrc->nodes[t].size;
+}
+
+static void update_size(MissRatioCurve *mrc, int t) {
+    mrc->nodes[t].size = 1 + node_size(mrc, mrc->nodes[t].left) + node_size(mrc, mrc->nodes[t].right);
+}
+
+// Join two treaps, every key of a below every key of b
+static int merge(MissRatioCurve *mrc, int a, int b) {
+    if (a == -1) return b;
+    if (b == -1) return a;
+    if (mrc->nodes[a].priority > mrc->nodes[b].priority) {
+        int right = merge(mrc, mrc->nodes[a].right, b);
+        mrc->nodes[a].right = right;
+        mrc->nodes[right].parent = a;
+        update_size(mrc, a);
+        return a;
+    }
+    int left = merge(mrc, a, mrc->nodes[b].left);
+    mrc->nodes[b].left = left;
+    mrc->nodes[left].parent = b;
+    update_size(mrc, b);
+    return b;
+}
+
+// Nodes with a larger key than node, counted on the way up to the root
+static int count_above(const MissRatioCurve *mrc, int node) {
+    int count = node_size(mrc, mrc->nodes[node].right);
+    for (int x = node, p = mrc->nodes[node].parent; p != -1; x = p, p = mrc->nodes[p].parent) {
+        if (mrc->nodes[p].left == x) count += 1 + node_size(mrc, mrc->nodes[p].right);
+    }
+    return count;
+}
+
+static void remove_node(MissRatioCurve *mrc, int node) {
+    int parent = mrc->nodes[node].parent;
+    int children = merge(mrc, mrc->nodes[node].left, mrc->nodes[node].right);
+    if (children != -1) mrc->nodes[children].parent = parent;
+    if (parent == -1) {
+        mrc->root = children;
+        return;
+    }
+    if (mrc->nodes[parent].left == node) {
+        mrc->nodes[parent].left = children;
+    } else {
+        mrc->nodes[parent].right = children;
+    }
+    for (int p = parent; p != -1; p = mrc->nodes[p].parent) {
+        mrc->nodes[p].size--;
+    }
+}
+
+// Insert a node whose key is above every other: it lands on the right spine,
+// below the nodes of higher priority, and takes the rest of the spine as its
+// left subtree
+static void push_newest(MissRatioCurve *mrc, int node) {
+    int parent = -1;
+    int x = mrc->root;
+    while (x != -1 && mrc->nodes[x].priority > mrc->nodes[node].priority) {
+        mrc->nodes[x].size++;
+        parent = x;
+        x = mrc->nodes[x].right;
+    }
+    mrc->nodes[node].left = x;
+    mrc->nodes[node].right = -1;
+    mrc->nodes[node].parent = parent;
+    mrc->nodes[node].size = 1 + node_size(mrc, x);
+    if (x != -1) mrc->nodes[x].parent = node;
+    if (parent == -1) {
+        mrc->root = node;
+    } else {
+        mrc->nodes[parent].right = node;
+    }
+}
+
+static int new_node(MissRatioCurve *mrc) {
+    if (mrc->num_nodes == mrc->nodes_capacity) {
+        int new_capacity = mrc->nodes_capacity > 0 ? mrc->nodes_capacity * 2 : 1024;
+        StackNode *grown = realloc(mrc->nodes, (size_t)new_capacity * sizeof(StackNode));
+        if (grown == NULL) {
+            fprintf(stderr, "Error: Failed to grow miss-ratio curve to %d pages\n", new_capacity);
+            exit(1);
+        }
+        mrc->nodes = grown;
+        mrc->nodes_capacity = new_capacity;
+    }
+    int n = mrc->num_nodes++;
+    mrc->nodes[n].priority = page_hash((unsigned int)n ^ 0x9e3779b9u);
+    return n;
+}
+
+static void count_distance(MissRatioCurve *mrc, int distance) {
+    if (distance >= mrc->histogram_capacity) {
+        int new_capacity = mrc->histogram_capacity > 0 ? mrc->histogram_capacity : 1024;
+        while (new_capacity <= distance) new_capacity *= 2;
+        long long *grown = realloc(mrc->histogram, (size_t)new_capacity * sizeof(long long));
+        if (grown == NULL) {
+            fprintf(stderr, "Error: Failed to grow miss-ratio histogram to %d entries\n", new_capacity);
+            exit(1);
+        }
+        memset(grown + mrc->histogram_capacity, 0,
+               (size_t)(new_capacity - mrc->histogram_capacity) * sizeof(long long));
+        mrc->histogram = grown;
+        mrc->histogram_capacity = new_capacity;
+    }
+    mrc->histogram[distance]++;
+    if (distance > mrc->max_distance) mrc->max_distance = distance;
+}
+
+void miss_ratio_reference(MissRatioCurve *mrc, int page) {
+    if (page < 0 || page >= mrc->num_pages) return;
+    mrc->references++;
+    if (page_hash((unsigned int)page) >= mrc->sample_threshold) return;
+
+    int node = mrc->page_node[page];
+    if (node == -1) {
+        node = new_node(mrc);
+        mrc->page_node[page] = node;
+        mrc->cold_misses++;
+    } else {
+        // The pages above it in the stack are the ones referenced since
+        count_distance(mrc, count_above(mrc, node) + 1);
+        remove_node(mrc, node);
+    }
+
+    // Back on top of the stack, as the newest key
+    mrc->nodes[node].key = ++mrc->time;
+    push_newest(mrc, node);
+}
+
+// Tracked references that miss with a RAM of the given frames: a sampled
+// distance d stands for d / sample_rate pages
+static long long sampled_misses(const MissRatioCurve *mrc, int frames, int *first_hit_distance) {
+    int limit = (int)floor(frames * mrc->sample_rate);
+    long long misses = mrc->cold_misses;
+    for (int d = limit + 1; d <= mrc->max_distance; d++) {
+        misses += mrc->histogram[d];
+    }
+    if (first_hit_distance != NULL) *first_hit_distance = limit;
+    return misses;
+}
+
+// Scale tracked misses to the whole stream. Dividing by the expected number
+// of tracked references rather than the actual one is the SHARDS adjustment
+// for pages whose sampled share is off.
+static long long scaled_misses(const MissRatioCurve *mrc, long long misses) {
+    double estimate = misses / mrc->sample_rate;
+    if (estimate > mrc->references) return mrc->references;
+    return (long long)llround(estimate);
+}
+
+long long miss_ratio_misses(const MissRatioCurve *mrc, int frames) {
+    return scaled_misses(mrc, sampled_misses(mrc, frames, NULL));
+}
+
+void miss_ratio_write_csv(const MissRatioCurve *mrc, FILE *out) {
+    fprintf(out, "frames,misses,miss_ratio\n");
+    if (mrc->references == 0) return;
+
+    int last_frames = (int)ceil(mrc->max_distance / mrc->sample_rate);
+    if (last_frames < 1) last_frames = 1;
+
+    // Walk the frame counts up, dropping each distance once it starts to hit
+    int limit;
+    long long misses = sampled_misses(mrc, 1, &limit);
+    for (int frames = 1; frames <= last_frames; frames++) {
+        int new_limit = (int)floor(frames * mrc->sample_rate);
+        for (int d = limit + 1; d <= new_limit && d <= mrc->max_distance; d++) {
+            misses -= mrc->histogram[d];
+        }
+        if (new_limit > limit) limit = new_limit;
+
+        long long total = scaled_misses(mrc, misses);
+        fprintf(out, "%d,%lld,%.6f\n", frames, total, (double)total / mrc->references);
+    }
+}
@@ -0,0 +1,128 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "../../include/process_table.h"
+#include "../../include/arena.h"
+#include "../../include/timeline.h"
+
+static void reserve(SimContext *ctx, int capacity) {
+    if (capacity <= ctx->process_capacity) return;
+
+    int new_capacity = ctx->process_capacity > 0 ? ctx->process_capacity * 2 : 8;
+    if (new_capacity < capacity) new_capacity = capacity;
+
+    Process *grown = realloc(ctx->processes, new_capacity * sizeof(Process));
+    if (grown == NULL) {
+        fprintf(stderr, "Error: Failed to grow process table to %d entries\n", new_capacity);
+        exit(1);
+    }
+    ctx->processes = grown;
+    ctx->process_capacity = new_capacity;
+}
+
+// Append a process with default parameters and return it
+Process *process_table_add(SimContext *ctx) {
+    reserve(ctx, ctx->num_processes + 1);
+
+    int new_idx = ctx->num_processes;
+    Process *p = &ctx->processes[new_idx];
+    p->id = new_idx + 1;
+    p->arrival_time = 0;
+    p->execution_time = 1;
+    p->remaining_time = 1;
+    p->deadline = 10;
+    p->priority = 1;
+    p->final_status = PS_PENDING;
+    timeline_init(&p->timeline, &ctx->timeline_arena);
+    p->vruntime = 0;
+    p->overhead = false;
+    p->num_pages = 3; // Default to 3 pages
+    p->access_pattern = ctx->access_pattern;
+    p->pages = NULL;  // laid out by init_memory_system
+    p->first_page = 0;
+    p->page_faults = 0;
+    p->resume_reference = false;
+    p->next_page_to_access = 0;
+    p->exec_units_since_page_access = 0;
+    p->access_seed = 1;
+    p->last_page = -1;
+    p->readahead_next = 0;
+    p->readahead_size = 0;
+    p->readahead_marker = -1;
+    p->pages_prefetched = 0;
+    p->prefetch_hits = 0;
+    p->tlb_hits = 0;
+    p->tlb_misses = 0;
+    p->resident = (FrameList){-1, -1, 0};
+    p->references = 0;
+    p->ws_head = -1;
+    p->ws_tail = -1;
+    p->ws_size = 0;
+    p->frame_limit = 0;
+    p->last_fault_reference = 0;
+    p->demand = 0;
+    p->reserved = 0;
+    p->state = NOT_ARRIVED;
+    p->state_since = 0;
+    p->state_fault = false;
+    p->burst_start = -1;
+    p->cpu = 0;
+    p->burst_generation = 0;
+    p->first_exec = -1;
+    p->last_exec_end = -1;
+    p->wait_ticks = 0;
+    p->fault_wait_ticks = 0;
+
+    for (int m = 0; m < MI_COUNT; m++) {
+        p->metrics[m] = 0;
+    }
+
+    ctx->num_processes++;
+    return p;
+}
+
+// Remove a process and renumber the ones after it
+void process_table_remove(SimContext *ctx, int index) {
+    if (index < 0 || index >= ctx->num_processes) return;
+
+    // Shift remaining processes left
+    for (int i = index; i < ctx->num_processes - 1; i++) {
+        ctx->processes[i] = ctx->processes[i + 1];
+        ctx->processes[i].id = i + 1;
+    }
+    ctx->num_processes--;
+}
+
+void process_table_clear(SimContext *ctx) {
+    ctx->num_processes = 0;
+}
+
+// Give every process an empty timeline backed by a freshly reset arena
+void process_table_alloc_timelines(SimContext *ctx) {
+    arena_reset(&ctx->timeline_arena);
+
+    for (int i = 0; i < ctx->num_processes; i++) {
+        timeline_init(&ctx->processes[i].timeline, &ctx->timeline_arena);
+        ctx->processes[i].remaining_time = ctx->processes[i].execution_time;
+    }
+}
+
+// Release the table and all per-run buffers at once
+void process_table_free(SimContext *ctx) {
+    arena_release(&ctx->timeline_arena);
+    free(ctx->processes);
+    ctx->processes = NULL;
+    ctx->process_capacity = 0;
+    ctx->num_processes = 0;
+}
+
+// Index of the process with the given id (-1 if there is none)
+int process_index_by_id(const SimContext *ctx, int id) {
+    // Ids are normally index + 1, so try that slot first
+    if (id > 0 && id <= ctx->num_processes && ctx->processes[id - 1].id == id) {
+        return id - 1;
+    }
+    for (int i = 0; i < ctx->num_processes; i++) {
+        if (ctx->processes[i].id == id) return i;
+    }
+    return -1;
+}
@@ -0,0 +1,112 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "../../include/ready_heap.h"
+
+static void place(ReadyHeap *rh, int pos, int process) {
+    rh->heap[pos] = process;
+    rh->position[process] = pos;
+}
+
+static void sift_up(ReadyHeap *rh, int pos) {
+    int process = rh->heap[pos];
+    while (pos > 0) {
+        int parent = (pos - 1) / 2;
+        if (!rh->before(rh->context, process, rh->heap[parent])) break;
+        place(rh, pos, rh->heap[parent]);
+        pos = parent;
+    }
+    place(rh, pos, process);
+}
+
+static void sift_down(ReadyHeap *rh, int pos) {
+    int process = rh->heap[pos];
+    for (;;) {
+        int child = 2 * pos + 1;
+        if (child >= rh->size) break;
+        if (child + 1 < rh->size && rh->before(rh->context, rh->heap[child + 1], rh->heap[child])) {
+            child++;
+        }
+        if (!rh->before(rh->context, rh->heap[child], process)) break;
+        place(rh, pos, rh->heap[child]);
+        pos = child;
+    }
+    place(rh, pos, process);
+}
+
+void ready_heap_init(ReadyHeap *rh, int capacity, ReadyHeapBefore before, const void *context) {
+    if (capacity < 1) capacity = 1;
+    rh->heap = malloc(capacity * sizeof(int));
+    rh->position = malloc(capacity * sizeof(int));
+    if (rh->heap == NULL || rh->position == NULL) {
+        fprintf(stderr, "Error: Failed to allocate ready queue\n");
+        exit(1);
+    }
+    for (int i = 0; i < capacity; i++) {
+        rh->position[i] = -1;
+    }
+    rh->size = 0;
+    rh->capacity = capacity;
+    rh->before = before;
+    rh->context = context;
+}
+
+void ready_heap_free(ReadyHeap *rh) {
+    free(rh->heap);
+    free(rh->position);
+    rh->heap = NULL;
+    rh->position = NULL;
+    rh->size = 0;
+    rh->capacity = 0;
+}
+
+void ready_heap_push(ReadyHeap *rh, int process) {
+    if (process < 0 || process >= rh->capacity || rh->position[process] != -1) {
+        return;
+    }
+    place(rh, rh->size++, process);
+    sift_up(rh, rh->size - 1);
+}
+
+// Best process in the heap (-1 if empty)
+int ready_heap_peek(const ReadyHeap *rh) {
+    return rh->size > 0 ? rh->heap[0] : -1;
+}
+
+int ready_heap_pop(ReadyHeap *rh) {
+    if (rh->size == 0) return -1;
+    int top = rh->heap[0];
+    ready_heap_remove(rh, top);
+    return top;
+}
+
+void ready_heap_remove(ReadyHeap *rh, int process) {
+    if (!ready_heap_contains(rh, process)) return;
+
+    int pos = rh->position[process];
+    int last = rh->heap[--rh->size];
+    rh->position[process] = -1;
+    if (pos == rh->size) return;
+
+    place(rh, pos, last);
+    sift_up(rh, pos);
+    sift_down(rh, rh->position[last]);
+}
+
+// Restore heap order after the key of a queued process changed (either way)
+void ready_heap_update(ReadyHeap *rh, int process) {
+    if (!ready_heap_contains(rh, process)) return;
+    int pos = rh->position[process];
+    sift_up(rh, pos);
+    sift_down(rh, rh->position[process]);
+}
+
+bool ready_heap_contains(const ReadyHeap *rh, int process) {
+    return process >= 0 && process < rh->capacity && rh->position[process] != -1;
+}
+
+// Best process other than the top one (-1 if there is none)
+int ready_heap_runner_up(const ReadyHeap *rh) {
+    if (rh->size < 2) return -1;
+    if (rh->size == 2) return rh->heap[1];
+    return rh->before(rh->context, rh->heap[2], rh->heap[1]) ? rh->heap[2] : rh->heap[1];
+}
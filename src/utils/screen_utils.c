@@ -8,7 +8,7 @@ void update_screen_size() {
 }
 
 bool is_screen_too_small() {
-    return (screen_width < 125 || screen_height < 45 || TOTAL_TIME < 15);
+    return (screen_width < 125 || screen_height < 45 || sim.total_time < 15);
 }
 
 void show_screen_size_error() {
@@ -0,0 +1,143 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "../../include/sim_context.h"
+#include "../../include/process_table.h"
+#include "../../include/memory.h"
+#include "../../include/memory_history.h"
+#include "../../include/miss_ratio.h"
+#include "../../include/trace.h"
+
+void sim_context_init(SimContext *ctx) {
+    ctx->processes = NULL;
+    ctx->num_processes = 0;
+    ctx->process_capacity = 0;
+    arena_init(&ctx->timeline_arena);
+
+    ctx->total_time = 100;
+    ctx->algorithm = 0;
+    ctx->quantum = 2;
+    ctx->overhead_time = 1;
+    ctx->num_cpus = 1;
+    ctx->migration_cost = 1;
+    ctx->migrations = 0;
+    ctx->dispatches = 0;
+    ctx->keep_timelines = true;
+    for (int c = 0; c < MAX_CPUS; c++) ctx->cpu_stats[c] = (CpuStats){0, 0, -1};
+    ctx->exec_end = 0;
+    ctx->switch_periods = 0;
+    ctx->late_switches = NULL;
+    ctx->num_late_switches = 0;
+    ctx->late_switches_capacity = 0;
+
+    ctx->memory_enabled = false;
+    ctx->replacement_policy = POLICY_FIFO;
+    ctx->num_frames = DEFAULT_RAM_FRAMES;
+    ctx->frame_size_kb = DEFAULT_FRAME_SIZE_KB;
+    ctx->current_time_global = 0;
+    ctx->max_pages_per_process = DEFAULT_MAX_PAGES_PER_PROCESS;
+    ctx->access_pattern = ACCESS_SEQUENTIAL;
+    ctx->pages = NULL;
+    ctx->num_pages = 0;
+    ctx->pages_capacity = 0;
+    ctx->running = NULL;
+    ctx->num_running = 0;
+    ctx->referenced_until = 0;
+    ctx->fault_time = 0;
+    ctx->disk_schedule = DISK_FCFS;
+    ctx->swap = (SwapDevice){0};
+    ctx->readahead_pages = 0;
+    ctx->tlb_entries = 0;
+    ctx->tlb_ways = DEFAULT_TLB_WAYS;
+    ctx->tlb_flush = false;
+    ctx->tlb = (Tlb){0};
+    ctx->frame_allocation = ALLOCATION_GLOBAL;
+    ctx->ws_window = DEFAULT_WS_WINDOW;
+    ctx->pff_low = DEFAULT_PFF_LOW;
+    ctx->pff_high = DEFAULT_PFF_HIGH;
+    ctx->memory_demand = 0;
+    ctx->swapped_out = NULL;
+    ctx->swapped_head = 0;
+    ctx->num_swapped_out = 0;
+    ctx->swap_outs = 0;
+    ctx->ram_frames = NULL;
+    ctx->frames_capacity = 0;
+    ctx->replacement = (ReplacementState){0};
+    reset_ram_frames(ctx);
+    ctx->keep_memory_history = false;
+    memory_history_init(&ctx->memory_history);
+    ctx->keep_page_events = true;
+    ctx->page_events = NULL;
+    ctx->num_page_events = 0;
+    ctx->page_events_capacity = 0;
+    ctx->keep_miss_ratio_curve = false;
+    miss_ratio_init(&ctx->miss_ratio_curve, 1.0);
+    trace_init(&ctx->trace);
+
+    ctx->metrics_computed = false;
+    ctx->summary_stats = (SummaryStats){0};
+}
+
+void sim_context_free(SimContext *ctx) {
+    process_table_free(ctx);
+    free_memory_system(ctx);
+    trace_free(&ctx->trace);
+    free(ctx->late_switches);
+    ctx->late_switches = NULL;
+    ctx->num_late_switches = 0;
+    ctx->late_switches_capacity = 0;
+}
+
+void sim_context_copy_workload(SimContext *dst, const SimContext *src) {
+    dst->total_time = src->total_time;
+    dst->algorithm = src->algorithm;
+    dst->quantum = src->quantum;
+    dst->overhead_time = src->overhead_time;
+    dst->num_cpus = src->num_cpus;
+    dst->migration_cost = src->migration_cost;
+    dst->memory_enabled = src->memory_enabled;
+    dst->replacement_policy = src->replacement_policy;
+    dst->num_frames = src->num_frames;
+    dst->frame_size_kb = src->frame_size_kb;
+    dst->max_pages_per_process = src->max_pages_per_process;
+    dst->access_pattern = src->access_pattern;
+    dst->fault_time = src->fault_time;
+    dst->disk_schedule = src->disk_schedule;
+    dst->readahead_pages = src->readahead_pages;
+    dst->tlb_entries = src->tlb_entries;
+    dst->tlb_ways = src->tlb_ways;
+    dst->tlb_flush = src->tlb_flush;
+    dst->frame_allocation = src->frame_allocation;
+    dst->ws_window = src->ws_window;
+    dst->pff_low = src->pff_low;
+    dst->pff_high = src->pff_high;
+
+    process_table_clear(dst);
+    for (int i = 0; i < src->num_processes; i++) {
+        Process *p = process_table_add(dst);
+        const Process *from = &src->processes[i];
+        p->id = from->id;
+        p->arrival_time = from->arrival_time;
+        p->execution_time = from->execution_time;
+        p->deadline = from->deadline;
+        p->priority = from->priority;
+        p->num_pages = from->num_pages;
+        p->access_pattern = from->access_pattern;
+    }
+    process_table_alloc_timelines(dst);
+}
+
+SimContext *sim_context_create() {
+    SimContext *ctx = malloc(sizeof(SimContext));
+    if (ctx == NULL) {
+        fprintf(stderr, "Error: Failed to allocate simulation context\n");
+        exit(1);
+    }
+    sim_context_init(ctx);
+    return ctx;
+}
+
+void sim_context_destroy(SimContext *ctx) {
+    if (ctx == NULL) return;
+    sim_context_free(ctx);
+    free(ctx);
+}
@@ -0,0 +1,211 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "../../include/thread_pool.h"
+
+typedef struct {
+    ThreadPool *pool;
+    int index;
+} WorkerArgs;
+
+static void queue_init(WorkerQueue *queue) {
+    queue->capacity = 16;
+    queue->jobs = malloc(queue->capacity * sizeof(ThreadPoolJob));
+    if (queue->jobs == NULL) {
+        fprintf(stderr, "Error: Failed to allocate worker queue\n");
+        exit(1);
+    }
+    queue->head = 0;
+    queue->count = 0;
+    pthread_mutex_init(&queue->lock, NULL);
+}
+
+static void queue_push(WorkerQueue *queue, ThreadPoolJob job) {
+    pthread_mutex_lock(&queue->lock);
+    if (queue->count == queue->capacity) {
+        // Unroll the circular buffer into one twice as large
+        int new_capacity = queue->capacity * 2;
+        ThreadPoolJob *grown = malloc(new_capacity * sizeof(ThreadPoolJob));
+        if (grown == NULL) {
+            fprintf(stderr, "Error: Failed to grow worker queue\n");
+            exit(1);
+        }
+        for (int i = 0; i < queue->count; i++) {
+            grown[i] = queue->jobs[(queue->head + i) % queue->capacity];
+        }
+        free(queue->jobs);
+        queue->jobs = grown;
+        queue->head = 0;
+        queue->capacity = new_capacity;
+    }
+    queue->jobs[(queue->head + queue->count) % queue->capacity] = job;
+    queue->count++;
+    pthread_mutex_unlock(&queue->lock);
+}
+
+// Owner side: newest job first, it is the most likely to be cache-warm
+static bool queue_pop_tail(WorkerQueue *queue, ThreadPoolJob *out) {
+    bool found = false;
+    pthread_mutex_lock(&queue->lock);
+    if (queue->count > 0) {
+        queue->count--;
+        *out = queue->jobs[(queue->head + queue->count) % queue->capacity];
+        found = true;
+    }
+    pthread_mutex_unlock(&queue->lock);
+    return found;
+}
+
+// Thief side: oldest job, away from the owner's end
+static bool queue_steal_head(WorkerQueue *queue, ThreadPoolJob *out) {
+    bool found = false;
+    pthread_mutex_lock(&queue->lock);
+    if (queue->count > 0) {
+        *out = queue->jobs[queue->head];
+        queue->head = (queue->head + 1) % queue->capacity;
+        queue->count--;
+        found = true;
+    }
+    pthread_mutex_unlock(&queue->lock);
+    return found;
+}
+
+static bool take_job(ThreadPool *pool, int self, ThreadPoolJob *out) {
+    bool found = queue_pop_tail(&pool->queues[self], out);
+    for (int k = 1; !found && k < pool->num_threads; k++) {
+        found = queue_steal_head(&pool->queues[(self + k) % pool->num_threads], out);
+    }
+    if (found) {
+        pthread_mutex_lock(&pool->lock);
+        pool->queued--;
+        pthread_mutex_unlock(&pool->lock);
+    }
+    return found;
+}
+
+static void *worker_main(void *data) {
+    WorkerArgs *args = data;
+    ThreadPool *pool = args->pool;
+    int self = args->index;
+    free(args);
+
+    for (;;) {
+        ThreadPoolJob job;
+        if (take_job(pool, self, &job)) {
+            job.task(job.arg);
+
+            pthread_mutex_lock(&pool->lock);
+            if (--pool->pending == 0) {
+                pthread_cond_broadcast(&pool->all_done);
+            }
+            pthread_mutex_unlock(&pool->lock);
+            continue;
+        }
+
+        // Every queue looked empty: sleep until a submission or shutdown
+        pthread_mutex_lock(&pool->lock);
+        while (pool->queued == 0 && !pool->shutting_down) {
+            pthread_cond_wait(&pool->work_available, &pool->lock);
+        }
+        bool done = pool->queued == 0 && pool->shutting_down;
+        pthread_mutex_unlock(&pool->lock);
+        if (done) break;
+    }
+    return NULL;
+}
+
+ThreadPool *thread_pool_create(int num_threads) {
+    if (num_threads < 1) num_threads = 1;
+
+    ThreadPool *pool = malloc(sizeof(ThreadPool));
+    if (pool == NULL) {
+        fprintf(stderr, "Error: Failed to allocate thread pool\n");
+        exit(1);
+    }
+    pool->threads = malloc(num_threads * sizeof(pthread_t));
+    pool->queues = malloc(num_threads * sizeof(WorkerQueue));
+    if (pool->threads == NULL || pool->queues == NULL) {
+        fprintf(stderr, "Error: Failed to allocate thread pool\n");
+        exit(1);
+    }
+    for (int i = 0; i < num_threads; i++) {
+        queue_init(&pool->queues[i]);
+    }
+    pool->num_threads = num_threads;
+    pool->next_queue = 0;
+    pool->queued = 0;
+    pool->pending = 0;
+    pool->shutting_down = false;
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->work_available, NULL);
+    pthread_cond_init(&pool->all_done, NULL);
+
+    for (int i = 0; i < num_threads; i++) {
+        WorkerArgs *args = malloc(sizeof(WorkerArgs));
+        if (args == NULL) {
+            fprintf(stderr, "Error: Failed to allocate thread pool\n");
+            exit(1);
+        }
+        args->pool = pool;
+        args->index = i;
+        if (pthread_create(&pool->threads[i], NULL, worker_main, args) != 0) {
+            fprintf(stderr, "Error: Failed to start worker thread\n");
+            exit(1);
+        }
+    }
+    return pool;
+}
+
+void thread_pool_submit(ThreadPool *pool, ThreadPoolTask task, void *arg) {
+    ThreadPoolJob job = {task, arg};
+
+    // Counters go up before the job is visible so pending never drops to
+    // zero early and queued never under-counts
+    pthread_mutex_lock(&pool->lock);
+    int target = pool->next_queue;
+    pool->next_queue = (pool->next_queue + 1) % pool->num_threads;
+    pool->pending++;
+    pool->queued++;
+    queue_push(&pool->queues[target], job);
+    pthread_cond_signal(&pool->work_available);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+// Block until every submitted job has finished
+void thread_pool_wait(ThreadPool *pool) {
+    pthread_mutex_lock(&pool->lock);
+    while (pool->pending > 0) {
+        pthread_cond_wait(&pool->all_done, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+// Finish the queued jobs, then stop and free the workers
+void thread_pool_destroy(ThreadPool *pool) {
+    if (pool == NULL) return;
+
+    pthread_mutex_lock(&pool->lock);
+    pool->shutting_down = true;
+    pthread_cond_broadcast(&pool->work_available);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (int i = 0; i < pool->num_threads; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+    for (int i = 0; i < pool->num_threads; i++) {
+        pthread_mutex_destroy(&pool->queues[i].lock);
+        free(pool->queues[i].jobs);
+    }
+
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->work_available);
+    pthread_cond_destroy(&pool->all_done);
+    free(pool->threads);
+    free(pool->queues);
+    free(pool);
+}
+
+int thread_pool_default_size() {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    return cpus > 0 ? (int)cpus : 1;
+}
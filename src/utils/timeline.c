@@ -0,0 +1,78 @@
+#include <string.h>
+#include "../../include/timeline.h"
+
+void timeline_init(Timeline *tl, Arena *arena) {
+    tl->runs = NULL;
+    tl->count = 0;
+    tl->capacity = 0;
+    tl->arena = arena;
+}
+
+// Drop all runs but keep the buffer for the next simulation
+void timeline_reset(Timeline *tl) {
+    tl->count = 0;
+}
+
+void timeline_append(Timeline *tl, int start, int length, ProcessState state, int cpu, bool page_fault) {
+    if (length <= 0) return;
+
+    // Extend the last run when the state continues on the same CPU without a new fault
+    if (tl->count > 0 && !page_fault) {
+        TimelineRun *last = &tl->runs[tl->count - 1];
+        if (last->state == state && last->cpu == cpu && last->start + last->length == start) {
+            last->length += length;
+            return;
+        }
+    }
+
+    if (tl->count == tl->capacity) {
+        // The old buffer stays in the arena until it is reset
+        int new_capacity = tl->capacity > 0 ? tl->capacity * 2 : 8;
+        TimelineRun *grown = arena_alloc(tl->arena, new_capacity * sizeof(TimelineRun));
+        if (tl->count > 0) {
+            memcpy(grown, tl->runs, tl->count * sizeof(TimelineRun));
+        }
+        tl->runs = grown;
+        tl->capacity = new_capacity;
+    }
+
+    TimelineRun *run = &tl->runs[tl->count++];
+    run->start = start;
+    run->length = length;
+    run->state = state;
+    run->page_fault = page_fault;
+    run->cpu = (short)cpu;
+}
+
+// Index of the run covering tick t (-1 if no run covers it)
+int timeline_find_run(const Timeline *tl, int t) {
+    int lo = 0;
+    int hi = tl->count - 1;
+    int found = -1;
+
+    // Last run starting at or before t
+    while (lo <= hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (tl->runs[mid].start <= t) {
+            found = mid;
+            lo = mid + 1;
+        } else {
+            hi = mid - 1;
+        }
+    }
+
+    if (found >= 0 && t < tl->runs[found].start + tl->runs[found].length) {
+        return found;
+    }
+    return -1;
+}
+
+ProcessState timeline_state_at(const Timeline *tl, int t) {
+    int r = timeline_find_run(tl, t);
+    return r >= 0 ? tl->runs[r].state : NOT_ARRIVED;
+}
+
+bool timeline_fault_at(const Timeline *tl, int t) {
+    int r = timeline_find_run(tl, t);
+    return r >= 0 && tl->runs[r].page_fault && tl->runs[r].start == t;
+}
@@ -0,0 +1,218 @@
+#include <stdlib.h>
+#include <time.h>
+#include "../../include/trace.h"
+
+// Timelines of the exported trace. On both, CPU c is track c + 1.
+#define SIM_PID 1
+#define WALL_PID 2
+#define PHASE_TID 0
+#define MEMORY_TID (MAX_CPUS + 1)
+
+static const char *phase_names[NUM_TRACE_PHASES] = {
+    "plan OPT", "schedule", "metrics", "replay page events"
+};
+
+static long long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+void trace_init(TraceBuffer *trace) {
+    trace->events = NULL;
+    trace->capacity = 0;
+    trace->count = 0;
+    trace->start_ns = 0;
+    trace->phase = TRACE_PHASE_SCHEDULE;
+}
+
+void trace_enable(TraceBuffer *trace, int capacity) {
+    int size = 1;
+    while (size < capacity) size *= 2;
+    free(trace->events);
+    trace->events = malloc((size_t)size * sizeof(TraceEvent));
+    if (trace->events == NULL) {
+        fprintf(stderr, "Error: Failed to allocate trace of %d events\n", size);
+        exit(1);
+    }
+    trace->capacity = size;
+    trace_reset(trace);
+}
+
+void trace_free(TraceBuffer *trace) {
+    free(trace->events);
+    trace_init(trace);
+}
+
+void trace_reset(TraceBuffer *trace) {
+    trace->count = 0;
+    trace->start_ns = now_ns();
+    trace->phase = TRACE_PHASE_SCHEDULE;
+}
+
+void trace_record(TraceBuffer *trace, TraceEventType type, int sim_time, int process, int cpu, int arg) {
+    if (type == TRACE_PHASE_BEGIN) trace->phase = (TracePhase)arg;
+
+    // Overwrite the oldest event once the ring is full
+    TraceEvent *ev = &trace->events[trace->count & (trace->capacity - 1)];
+    trace->count++;
+    ev->wall_ns = now_ns() - trace->start_ns;
+    ev->sim_time = sim_time;
+    ev->process = process;
+    ev->arg = arg;
+    ev->cpu = (short)cpu;
+    ev->type = (unsigned char)type;
+    ev->phase = (unsigned char)trace->phase;
+}
+
+long long trace_dropped(const TraceBuffer *trace) {
+    return trace->count > trace->capacity ? trace->count - trace->capacity : 0;
+}
+
+// ---------------------------------------------------------------------------
+// Chrome trace-event export
+// ---------------------------------------------------------------------------
+
+// Burst or context switch of a process, from the event that opened it
+typedef struct {
+    bool open;
+    int sim_start;
+    long long wall_start;
+    int cpu;
+} OpenSlice;
+
+typedef struct {
+    FILE *out;
+    bool first;
+} TraceWriter;
+
+static void begin_event(TraceWriter *w, const char *ph, int pid, int tid) {
+    fprintf(w->out, "%s\n{\"ph\":\"%s\",\"pid\":%d,\"tid\":%d", w->first ? "" : ",", ph, pid, tid);
+    w->first = false;
+}
+
+// Metadata: kind is process_name (a timeline) or thread_name (a track)
+static void write_name(TraceWriter *w, const char *kind, int pid, int tid, const char *name) {
+    begin_event(w, "M", pid, tid);
+    fprintf(w->out, ",\"name\":\"%s\",\"args\":{\"name\":\"%s\"}}", kind, name);
+}
+
+// Timestamps in microseconds
+static void write_slice(TraceWriter *w, int pid, int tid, const char *prefix, int id, double ts, double dur) {
+    begin_event(w, "X", pid, tid);
+    fprintf(w->out, ",\"name\":\"%sP%d\",\"ts\":%.3f,\"dur\":%.3f}", prefix, id, ts, dur);
+}
+
+static void write_instant(TraceWriter *w, int pid, int tid, const char *prefix, int id, double ts, int page) {
+    begin_event(w, "i", pid, tid);
+    fprintf(w->out, ",\"s\":\"t\",\"name\":\"%sP%d\",\"ts\":%.3f", prefix, id, ts);
+    if (page >= 0) fprintf(w->out, ",\"args\":{\"page\":%d}", page);
+    fputc('}', w->out);
+}
+
+static int cpu_track(int cpu) {
+    return cpu >= 0 ? cpu + 1 : MEMORY_TID;
+}
+
+// Close slice with the event ev, on both timelines; the simulated one only
+// shows the run the schedule comes from
+static void close_slice(TraceWriter *w, OpenSlice *slice, const TraceEvent *ev, const char *prefix, int id) {
+    if (!slice->open) return;
+    slice->open = false;
+    if (ev->phase == TRACE_PHASE_SCHEDULE) {
+        write_slice(w, SIM_PID, cpu_track(slice->cpu), prefix, id, slice->sim_start, ev->sim_time - slice->sim_start);
+    }
+    write_slice(w, WALL_PID, cpu_track(slice->cpu), prefix, id,
+                slice->wall_start / 1000.0, (ev->wall_ns - slice->wall_start) / 1000.0);
+}
+
+static void open_slice(OpenSlice *slice, const TraceEvent *ev) {
+    slice->open = true;
+    slice->sim_start = ev->sim_time;
+    slice->wall_start = ev->wall_ns;
+    slice->cpu = ev->cpu;
+}
+
+static void write_instants(TraceWriter *w, const TraceEvent *ev, int tid, const char *prefix, int id, int page) {
+    if (ev->phase == TRACE_PHASE_SCHEDULE) write_instant(w, SIM_PID, tid, prefix, id, ev->sim_time, page);
+    write_instant(w, WALL_PID, tid, prefix, id, ev->wall_ns / 1000.0, page);
+}
+
+void trace_write_chrome(const TraceBuffer *trace, const SimContext *ctx, FILE *out) {
+    int n = ctx->num_processes > 0 ? ctx->num_processes : 1;
+    OpenSlice *bursts = calloc((size_t)n, sizeof(OpenSlice));
+    OpenSlice *switches = calloc((size_t)n, sizeof(OpenSlice));
+    if (bursts == NULL || switches == NULL) {
+        fprintf(stderr, "Error: Failed to allocate trace export for %d processes\n", n);
+        exit(1);
+    }
+    OpenSlice phases[NUM_TRACE_PHASES] = {{0}};
+
+    TraceWriter w = {out, true};
+    fprintf(out, "{\"displayTimeUnit\":\"ns\",\"otherData\":{\"events\":%lld,\"dropped\":%lld},\n"
+                 "\"traceEvents\":[", trace->count, trace_dropped(trace));
+    write_name(&w, "process_name", SIM_PID, 0, "Simulated time (1 tick = 1 us)");
+    write_name(&w, "process_name", WALL_PID, 0, "Simulator (wall clock)");
+    write_name(&w, "thread_name", WALL_PID, PHASE_TID, "Phases");
+    for (int pid = SIM_PID; pid <= WALL_PID; pid++) {
+        for (int c = 0; c < ctx->num_cpus; c++) {
+            char name[16];
+            snprintf(name, sizeof(name), "CPU %d", c);
+            write_name(&w, "thread_name", pid, cpu_track(c), name);
+        }
+        write_name(&w, "thread_name", pid, MEMORY_TID, "Memory");
+    }
+
+    for (long long k = trace_dropped(trace); k < trace->count; k++) {
+        const TraceEvent *ev = &trace->events[k & (trace->capacity - 1)];
+        if (ev->type == TRACE_PHASE_BEGIN || ev->type == TRACE_PHASE_END) {
+            OpenSlice *phase = &phases[ev->arg];
+            if (ev->type == TRACE_PHASE_BEGIN) {
+                open_slice(phase, ev);
+            } else if (phase->open) {
+                phase->open = false;
+                begin_event(&w, "X", WALL_PID, PHASE_TID);
+                fprintf(out, ",\"name\":\"%s\",\"ts\":%.3f,\"dur\":%.3f}", phase_names[ev->arg],
+                        phase->wall_start / 1000.0, (ev->wall_ns - phase->wall_start) / 1000.0);
+            }
+            continue;
+        }
+        if (ev->process < 0 || ev->process >= ctx->num_processes) continue;
+
+        int i = ev->process;
+        int id = ctx->processes[i].id;
+        switch (ev->type) {
+            case TRACE_PICK:
+                open_slice(&bursts[i], ev);
+                break;
+            case TRACE_PREEMPT:
+            case TRACE_COMPLETE:
+                close_slice(&w, &bursts[i], ev, "", id);
+                break;
+            case TRACE_OVERHEAD_START:
+                open_slice(&switches[i], ev);
+                break;
+            case TRACE_OVERHEAD_END:
+                close_slice(&w, &switches[i], ev, "switch ", id);
+                break;
+            case TRACE_FAULT:
+                write_instants(&w, ev, cpu_track(ev->cpu), "fault ", id, ev->arg);
+                break;
+            case TRACE_EVICT:
+                write_instants(&w, ev, MEMORY_TID, "evict ", id, ev->arg);
+                break;
+            case TRACE_SWAP_OUT:
+                write_instants(&w, ev, MEMORY_TID, "swap out ", id, -1);
+                break;
+            case TRACE_SWAP_IN:
+                write_instants(&w, ev, MEMORY_TID, "swap in ", id, -1);
+                break;
+            default:
+                break;
+        }
+    }
+    fprintf(out, "\n]}\n");
+
+    free(bursts);
+    free(switches);
+}
@@ -0,0 +1,448 @@
+#include <ctype.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "../../include/trace_import.h"
+#include "../../include/process_table.h"
+
+#define TRACE_MAX_LINE 4096
+#define TRACE_WINDOW_SIZE (16L * 1024 * 1024)  // bytes of the file mapped at a time
+#define TRACE_MAX_TICKS 1000000000LL           // same bound as workload files
+#define TRACE_NICE0_PRIORITY 5
+#define TRACE_DEFAULT_PRIO 120                 // kernel priority of a nice 0 task
+
+// What the importer knows about one traced task
+typedef struct {
+    int pid;                  // 0 marks an empty slot
+    int prio;                 // kernel priority, 120 + nice for normal tasks
+    bool in_burst;            // runnable or running since burst_arrival
+    bool on_cpu;
+    long long burst_arrival;  // ns
+    long long on_cpu_since;   // ns
+    long long runtime;        // ns spent on a CPU during the current burst
+} TraceTask;
+
+typedef struct {
+    SimContext *ctx;
+    const TraceImportOptions *options;
+    TraceTask *tasks;         // open addressing hash table keyed by pid
+    int task_capacity;        // power of two
+    int task_count;
+    bool started;
+    long long first_ns;       // timestamp of the first event, tick 0
+    long long last_ns;
+    bool full;                // max_processes reached
+    bool failed;
+    char *err;
+    size_t err_size;
+} TraceParser;
+
+// Line being assembled, possibly across two mapped windows
+typedef struct {
+    char text[TRACE_MAX_LINE];
+    size_t length;
+} LineBuffer;
+
+void trace_import_defaults(TraceImportOptions *options) {
+    options->tick_ns = 1000000;
+    options->max_processes = 0;
+}
+
+static unsigned task_slot(int pid, int capacity) {
+    return ((unsigned)pid * 2654435761u) & (unsigned)(capacity - 1);
+}
+
+static void tasks_grow(TraceParser *parser) {
+    int new_capacity = parser->task_capacity > 0 ? parser->task_capacity * 2 : 1024;
+    TraceTask *grown = calloc(new_capacity, sizeof(TraceTask));
+    if (grown == NULL) {
+        fprintf(stderr, "Error: Failed to grow trace task table to %d entries\n", new_capacity);
+        exit(1);
+    }
+    for (int i = 0; i < parser->task_capacity; i++) {
+        if (parser->tasks[i].pid == 0) continue;
+        unsigned slot = task_slot(parser->tasks[i].pid, new_capacity);
+        while (grown[slot].pid != 0) slot = (slot + 1) & (new_capacity - 1);
+        grown[slot] = parser->tasks[i];
+    }
+    free(parser->tasks);
+    parser->tasks = grown;
+    parser->task_capacity = new_capacity;
+}
+
+// Task with the given pid, created on first sight
+static TraceTask *find_task(TraceParser *parser, int pid) {
+    if (2 * (parser->task_count + 1) > parser->task_capacity) {
+        tasks_grow(parser);
+    }
+    unsigned slot = task_slot(pid, parser->task_capacity);
+    while (parser->tasks[slot].pid != 0 && parser->tasks[slot].pid != pid) {
+        slot = (slot + 1) & (parser->task_capacity - 1);
+    }
+    TraceTask *task = &parser->tasks[slot];
+    if (task->pid == 0) {
+        task->pid = pid;
+        task->prio = TRACE_DEFAULT_PRIO;
+        parser->task_count++;
+    }
+    return task;
+}
+
+// A nice step changes the CFS share by 1.25x, the same as one priority
+// step here. Real-time tasks get the highest priority.
+static int prio_to_priority(int prio) {
+    if (prio < 100) return 1;
+    int priority = prio - TRACE_DEFAULT_PRIO + TRACE_NICE0_PRIORITY;
+    if (priority < 1) priority = 1;
+    if (priority > 10) priority = 10;
+    return priority;
+}
+
+// The burst of task ends at end_ns: add it to the process table
+static void emit_burst(TraceParser *parser, TraceTask *task, long long end_ns) {
+    task->in_burst = false;
+    if (task->runtime <= 0 || parser->full) return;
+
+    long long tick = parser->options->tick_ns;
+    long long arrival = (task->burst_arrival - parser->first_ns) / tick;
+    long long execution = (task->runtime + tick / 2) / tick;
+    long long turnaround = (end_ns - task->burst_arrival + tick / 2) / tick;
+    if (execution < 1) execution = 1;
+    if (turnaround < execution) turnaround = execution;
+    if (arrival > TRACE_MAX_TICKS || turnaround > TRACE_MAX_TICKS) {
+        snprintf(parser->err, parser->err_size,
+                 "trace spans more than %lld ticks, use a longer tick", TRACE_MAX_TICKS);
+        parser->failed = true;
+        return;
+    }
+
+    Process *p = process_table_add(parser->ctx);
+    p->arrival_time = (int)arrival;
+    p->execution_time = (int)execution;
+    p->remaining_time = p->execution_time;
+    p->deadline = (int)turnaround;
+    p->priority = prio_to_priority(task->prio);
+
+    if (parser->options->max_processes > 0 &&
+        parser->ctx->num_processes >= parser->options->max_processes) {
+        parser->full = true;
+    }
+}
+
+static void on_switch(TraceParser *parser, long long ns, int prev_pid, int prev_prio, bool prev_runnable,
+                      int next_pid, int next_prio) {
+    // pid 0 is the idle task
+    if (prev_pid > 0) {
+        TraceTask *prev = find_task(parser, prev_pid);
+        prev->prio = prev_prio;
+        if (prev->on_cpu) {
+            prev->runtime += ns - prev->on_cpu_since;
+            prev->on_cpu = false;
+        }
+        // Preempted tasks stay runnable and keep their burst
+        if (!prev_runnable && prev->in_burst) {
+            emit_burst(parser, prev, ns);
+        }
+    }
+    if (next_pid > 0) {
+        TraceTask *next = find_task(parser, next_pid);
+        next->prio = next_prio;
+        // Runnable before the trace started (or its wakeup was lost)
+        if (!next->in_burst) {
+            next->in_burst = true;
+            next->burst_arrival = ns;
+            next->runtime = 0;
+        }
+        next->on_cpu = true;
+        next->on_cpu_since = ns;
+    }
+}
+
+static void on_wakeup(TraceParser *parser, long long ns, int pid, int prio) {
+    if (pid <= 0) return;
+    TraceTask *task = find_task(parser, pid);
+    task->prio = prio;
+    if (!task->in_burst) {
+        task->in_burst = true;
+        task->burst_arrival = ns;
+        task->runtime = 0;
+    }
+}
+
+// Parse "SECONDS.FRACTION:" ending at end (the event name) into nanoseconds
+static bool parse_timestamp(const char *line, const char *end, long long *ns) {
+    while (end > line && end[-1] == ' ') end--;
+    if (end == line || end[-1] != ':') return false;
+    end--;
+    const char *start = end;
+    while (start > line && (isdigit((unsigned char)start[-1]) || start[-1] == '.')) start--;
+
+    long long seconds = 0;
+    long long fraction = 0;
+    int fraction_digits = 0;
+    bool in_fraction = false;
+    for (const char *p = start; p < end; p++) {
+        if (*p == '.') {
+            if (in_fraction) return false;
+            in_fraction = true;
+        } else if (in_fraction) {
+            if (fraction_digits < 9) {
+                fraction = fraction * 10 + (*p - '0');
+                fraction_digits++;
+            }
+        } else {
+            seconds = seconds * 10 + (*p - '0');
+            if (seconds > 1000000000LL) return false;
+        }
+    }
+    if (start == end) return false;
+    while (fraction_digits < 9) {
+        fraction *= 10;
+        fraction_digits++;
+    }
+    *ns = seconds * 1000000000LL + fraction;
+    return true;
+}
+
+// Value of "key=" in args, where key starts a word (NULL if missing)
+static const char *find_field(const char *args, const char *key) {
+    size_t length = strlen(key);
+    for (const char *p = strstr(args, key); p != NULL; p = strstr(p + 1, key)) {
+        if ((p == args || p[-1] == ' ') && p[length] == '=') return p + length + 1;
+    }
+    return NULL;
+}
+
+static int field_or(const char *args, const char *key, int fallback) {
+    const char *value = find_field(args, key);
+    return value != NULL ? (int)strtol(value, NULL, 10) : fallback;
+}
+
+// Older "comm:pid [prio]" form inside [begin, end). The last " [" closes
+// the task name, which may itself contain spaces and colons.
+static bool parse_compact_task(const char *begin, const char *end, int *pid, int *prio, const char **after) {
+    const char *bracket = NULL;
+    for (const char *p = begin; p + 1 < end; p++) {
+        if (p[0] == ' ' && p[1] == '[') bracket = p;
+    }
+    if (bracket == NULL) return false;
+
+    const char *digits = bracket;
+    while (digits > begin && isdigit((unsigned char)digits[-1])) digits--;
+    if (digits == bracket || digits == begin || digits[-1] != ':') return false;
+
+    *pid = (int)strtol(digits, NULL, 10);
+    *prio = (int)strtol(bracket + 2, NULL, 10);
+    const char *close = memchr(bracket, ']', end - bracket);
+    *after = close != NULL ? close + 1 : end;
+    return true;
+}
+
+static bool parse_switch(const char *args, int *prev_pid, int *prev_prio, bool *prev_runnable,
+                         int *next_pid, int *next_prio) {
+    // prev_comm=a prev_pid=1 prev_prio=120 prev_state=S ==> next_comm=b next_pid=2 next_prio=120
+    const char *next = find_field(args, "next_pid");
+    if (next != NULL) {
+        const char *prev = find_field(args, "prev_pid");
+        const char *state = find_field(args, "prev_state");
+        if (prev == NULL || state == NULL) return false;
+        *prev_pid = (int)strtol(prev, NULL, 10);
+        *next_pid = (int)strtol(next, NULL, 10);
+        *prev_prio = field_or(args, "prev_prio", TRACE_DEFAULT_PRIO);
+        *next_prio = field_or(args, "next_prio", TRACE_DEFAULT_PRIO);
+        *prev_runnable = state[0] == 'R';
+        return true;
+    }
+
+    // a:1 [120] S ==> b:2 [120]
+    const char *arrow = strstr(args, " ==> ");
+    const char *after;
+    if (arrow == NULL || !parse_compact_task(args, arrow, prev_pid, prev_prio, &after)) return false;
+    while (*after == ' ') after++;
+    *prev_runnable = *after == 'R';
+    return parse_compact_task(arrow + 5, arrow + strlen(arrow), next_pid, next_prio, &after);
+}
+
+static bool parse_wakeup(const char *args, int *pid, int *prio) {
+    // comm=a pid=1 prio=120 target_cpu=002
+    const char *value = find_field(args, "pid");
+    if (value != NULL) {
+        *pid = (int)strtol(value, NULL, 10);
+        *prio = field_or(args, "prio", TRACE_DEFAULT_PRIO);
+        return true;
+    }
+    // a:1 [120] success=1 CPU:002
+    const char *after;
+    return parse_compact_task(args, args + strlen(args), pid, prio, &after);
+}
+
+static void parse_line(TraceParser *parser, const char *line) {
+    static const char *names[] = {"sched_switch:", "sched_wakeup:", "sched_wakeup_new:"};
+    const char *event = NULL;
+    int type = 0;
+    for (; type < 3; type++) {
+        event = strstr(line, names[type]);
+        if (event != NULL) break;
+    }
+    if (event == NULL) return;
+
+    // perf prefixes the event with its subsystem
+    const char *name = event;
+    if (name - line >= 6 && memcmp(name - 6, "sched:", 6) == 0) name -= 6;
+
+    long long ns;
+    if (!parse_timestamp(line, name, &ns)) return;
+    if (!parser->started) {
+        parser->started = true;
+        parser->first_ns = ns;
+        parser->last_ns = ns;
+    }
+    if (ns < parser->last_ns) ns = parser->last_ns;  // keep time monotonic
+    parser->last_ns = ns;
+
+    const char *args = event + strlen(names[type]);
+    if (type == 0) {
+        int prev_pid, prev_prio, next_pid, next_prio;
+        bool prev_runnable;
+        if (parse_switch(args, &prev_pid, &prev_prio, &prev_runnable, &next_pid, &next_prio)) {
+            on_switch(parser, ns, prev_pid, prev_prio, prev_runnable, next_pid, next_prio);
+        }
+    } else {
+        int pid, prio;
+        if (parse_wakeup(args, &pid, &prio)) {
+            on_wakeup(parser, ns, pid, prio);
+        }
+    }
+}
+
+static void line_append(LineBuffer *buffer, const char *data, size_t length) {
+    size_t room = sizeof(buffer->text) - 1 - buffer->length;
+    if (length > room) length = room;  // overlong lines are truncated
+    memcpy(buffer->text + buffer->length, data, length);
+    buffer->length += length;
+    buffer->text[buffer->length] = '\0';
+}
+
+// Parse every complete line of data; an unterminated tail stays in buffer
+// until the rest of it arrives
+static void feed(TraceParser *parser, LineBuffer *buffer, const char *data, size_t size) {
+    const char *end = data + size;
+    while (data < end && !parser->full && !parser->failed) {
+        const char *newline = memchr(data, '\n', end - data);
+        line_append(buffer, data, (newline != NULL ? newline : end) - data);
+        if (newline == NULL) break;
+
+        parse_line(parser, buffer->text);
+        buffer->length = 0;
+        buffer->text[0] = '\0';
+        data = newline + 1;
+    }
+}
+
+// Map the file one window at a time so only that window is resident
+static bool read_mapped(TraceParser *parser, LineBuffer *buffer, int fd, off_t size) {
+    for (off_t offset = 0; offset < size && !parser->full && !parser->failed; offset += TRACE_WINDOW_SIZE) {
+        size_t length = size - offset < TRACE_WINDOW_SIZE ? (size_t)(size - offset) : TRACE_WINDOW_SIZE;
+        void *window = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, offset);
+        if (window == MAP_FAILED) return false;
+        feed(parser, buffer, window, length);
+        munmap(window, length);
+    }
+    return true;
+}
+
+// Pipes and other streams that cannot be mapped
+static bool read_stream(TraceParser *parser, LineBuffer *buffer, FILE *in) {
+    char chunk[65536];
+    size_t count;
+    while (!parser->full && !parser->failed && (count = fread(chunk, 1, sizeof(chunk), in)) > 0) {
+        feed(parser, buffer, chunk, count);
+    }
+    return !ferror(in);
+}
+
+// Arrival order, then the order bursts ended in
+static int compare_arrival(const void *a, const void *b) {
+    const Process *pa = a;
+    const Process *pb = b;
+    if (pa->arrival_time != pb->arrival_time) return pa->arrival_time < pb->arrival_time ? -1 : 1;
+    return (pa->id > pb->id) - (pa->id < pb->id);
+}
+
+int load_sched_trace(SimContext *ctx, FILE *in, const TraceImportOptions *options, char *err, size_t err_size) {
+    TraceParser parser;
+    memset(&parser, 0, sizeof(parser));
+    parser.ctx = ctx;
+    parser.options = options;
+    parser.err = err;
+    parser.err_size = err_size;
+
+    LineBuffer *buffer = malloc(sizeof(LineBuffer));
+    if (buffer == NULL) {
+        fprintf(stderr, "Error: Failed to allocate trace line buffer\n");
+        exit(1);
+    }
+    buffer->length = 0;
+    buffer->text[0] = '\0';
+
+    process_table_clear(ctx);
+
+    struct stat info;
+    int fd = fileno(in);
+    bool ok;
+    if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+        ok = read_mapped(&parser, buffer, fd, info.st_size);
+    } else {
+        ok = read_stream(&parser, buffer, in);
+    }
+    if (ok && buffer->length > 0 && !parser.full && !parser.failed) {
+        parse_line(&parser, buffer->text);  // last line without a newline
+    }
+    if (!ok && !parser.failed) {
+        snprintf(err, err_size, "read error: %s", strerror(errno));
+        parser.failed = true;
+    }
+
+    // Tasks still runnable when the trace ends
+    for (int i = 0; i < parser.task_capacity && !parser.full && !parser.failed; i++) {
+        TraceTask *task = &parser.tasks[i];
+        if (task->pid == 0 || !task->in_burst) continue;
+        if (task->on_cpu) {
+            task->runtime += parser.last_ns - task->on_cpu_since;
+        }
+        emit_burst(&parser, task, parser.last_ns);
+    }
+
+    free(buffer);
+    free(parser.tasks);
+    if (parser.failed) return -1;
+    if (ctx->num_processes == 0) {
+        snprintf(err, err_size, "no sched_switch or sched_wakeup bursts found");
+        return -1;
+    }
+
+    qsort(ctx->processes, ctx->num_processes, sizeof(Process), compare_arrival);
+    for (int i = 0; i < ctx->num_processes; i++) {
+        ctx->processes[i].id = i + 1;
+    }
+    return ctx->num_processes;
+}
+
+int load_sched_trace_file(SimContext *ctx, const char *path, const TraceImportOptions *options,
+                          char *err, size_t err_size) {
+    if (strcmp(path, "-") == 0) {
+        return load_sched_trace(ctx, stdin, options, err, err_size);
+    }
+
+    FILE *in = fopen(path, "r");
+    if (in == NULL) {
+        snprintf(err, err_size, "%s: %s", path, strerror(errno));
+        return -1;
+    }
+    int loaded = load_sched_trace(ctx, in, options, err, err_size);
+    fclose(in);
+    return loaded;
+}
@@ -0,0 +1,319 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "../../include/vruntime_tree.h"
+
+// Whether process a comes before process b
+static bool before(const VruntimeTree *tree, int a, int b) {
+    if (tree->node[a].key != tree->node[b].key) return tree->node[a].key < tree->node[b].key;
+    return a > b;
+}
+
+static void rotate_left(VruntimeTree *tree, int x) {
+    int y = tree->node[x].right;
+    tree->node[x].right = tree->node[y].left;
+    if (tree->node[y].left != tree->nil) tree->node[tree->node[y].left].parent = x;
+    tree->node[y].parent = tree->node[x].parent;
+    if (tree->node[x].parent == tree->nil) {
+        tree->root = y;
+    } else if (x == tree->node[tree->node[x].parent].left) {
+        tree->node[tree->node[x].parent].left = y;
+    } else {
+        tree->node[tree->node[x].parent].right = y;
+    }
+    tree->node[y].left = x;
+    tree->node[x].parent = y;
+}
+
+static void rotate_right(VruntimeTree *tree, int x) {
+    int y = tree->node[x].left;
+    tree->node[x].left = tree->node[y].right;
+    if (tree->node[y].right != tree->nil) tree->node[tree->node[y].right].parent = x;
+    tree->node[y].parent = tree->node[x].parent;
+    if (tree->node[x].parent == tree->nil) {
+        tree->root = y;
+    } else if (x == tree->node[tree->node[x].parent].right) {
+        tree->node[tree->node[x].parent].right = y;
+    } else {
+        tree->node[tree->node[x].parent].left = y;
+    }
+    tree->node[y].right = x;
+    tree->node[x].parent = y;
+}
+
+static int minimum(const VruntimeTree *tree, int x) {
+    while (tree->node[x].left != tree->nil) x = tree->node[x].left;
+    return x;
+}
+
+// Put subtree v where subtree u was
+static void transplant(VruntimeTree *tree, int u, int v) {
+    if (tree->node[u].parent == tree->nil) {
+        tree->root = v;
+    } else if (u == tree->node[tree->node[u].parent].left) {
+        tree->node[tree->node[u].parent].left = v;
+    } else {
+        tree->node[tree->node[u].parent].right = v;
+    }
+    tree->node[v].parent = tree->node[u].parent;
+}
+
+static void insert_fixup(VruntimeTree *tree, int z) {
+    while (tree->node[tree->node[z].parent].red) {
+        int p = tree->node[z].parent;
+        int g = tree->node[p].parent;
+        if (p == tree->node[g].left) {
+            int uncle = tree->node[g].right;
+            if (tree->node[uncle].red) {
+                tree->node[p].red = false;
+                tree->node[uncle].red = false;
+                tree->node[g].red = true;
+                z = g;
+            } else {
+                if (z == tree->node[p].right) {
+                    z = p;
+                    rotate_left(tree, z);
+                    p = tree->node[z].parent;
+                }
+                tree->node[p].red = false;
+                tree->node[g].red = true;
+                rotate_right(tree, g);
+            }
+        } else {
+            int uncle = tree->node[g].left;
+            if (tree->node[uncle].red) {
+                tree->node[p].red = false;
+                tree->node[uncle].red = false;
+                tree->node[g].red = true;
+                z = g;
+            } else {
+                if (z == tree->node[p].left) {
+                    z = p;
+                    rotate_right(tree, z);
+                    p = tree->node[z].parent;
+                }
+                tree->node[p].red = false;
+                tree->node[g].red = true;
+                rotate_left(tree, g);
+            }
+        }
+    }
+    tree->node[tree->root].red = false;
+}
+
+static void remove_fixup(VruntimeTree *tree, int x) {
+    while (x != tree->root && !tree->node[x].red) {
+        int p = tree->node[x].parent;
+        if (x == tree->node[p].left) {
+            int w = tree->node[p].right;
+            if (tree->node[w].red) {
+                tree->node[w].red = false;
+                tree->node[p].red = true;
+                rotate_left(tree, p);
+                w = tree->node[p].right;
+            }
+            if (!tree->node[tree->node[w].left].red && !tree->node[tree->node[w].right].red) {
+                tree->node[w].red = true;
+                x = p;
+            } else {
+                if (!tree->node[tree->node[w].right].red) {
+                    tree->node[tree->node[w].left].red = false;
+                    tree->node[w].red = true;
+                    rotate_right(tree, w);
+                    w = tree->node[p].right;
+                }
+                tree->node[w].red = tree->node[p].red;
+                tree->node[p].red = false;
+                tree->node[tree->node[w].right].red = false;
+                rotate_left(tree, p);
+                x = tree->root;
+            }
+        } else {
+            int w = tree->node[p].left;
+            if (tree->node[w].red) {
+                tree->node[w].red = false;
+                tree->node[p].red = true;
+                rotate_right(tree, p);
+                w = tree->node[p].left;
+            }
+            if (!tree->node[tree->node[w].right].red && !tree->node[tree->node[w].left].red) {
+                tree->node[w].red = true;
+                x = p;
+            } else {
+                if (!tree->node[tree->node[w].left].red) {
+                    tree->node[tree->node[w].right].red = false;
+                    tree->node[w].red = true;
+                    rotate_left(tree, w);
+                    w = tree->node[p].left;
+                }
+                tree->node[w].red = tree->node[p].red;
+                tree->node[p].red = false;
+                tree->node[tree->node[w].left].red = false;
+                rotate_right(tree, p);
+                x = tree->root;
+            }
+        }
+    }
+    tree->node[x].red = false;
+}
+
+void vruntime_tree_init(VruntimeTree *tree, int capacity) {
+    if (capacity < 1) capacity = 1;
+    // One extra slot for the sentinel
+    tree->node = calloc(capacity + 1, sizeof(VruntimeNode));
+    if (tree->node == NULL) {
+        fprintf(stderr, "Error: Failed to allocate vruntime tree\n");
+        exit(1);
+    }
+    tree->nil = capacity;
+    tree->node[tree->nil].left = tree->node[tree->nil].right = tree->node[tree->nil].parent = tree->nil;
+    tree->root = tree->nil;
+    tree->leftmost = -1;
+    tree->size = 0;
+    tree->capacity = capacity;
+}
+
+void vruntime_tree_free(VruntimeTree *tree) {
+    free(tree->node);
+    tree->node = NULL;
+    tree->size = 0;
+    tree->capacity = 0;
+}
+
+void vruntime_tree_insert(VruntimeTree *tree, int process, long long key) {
+    if (process < 0 || process >= tree->capacity || tree->node[process].queued) {
+        return;
+    }
+    tree->node[process].key = key;
+    tree->node[process].queued = true;
+
+    // Preempted processes land close to the leftmost node, so the descent
+    // starts at the lowest node of the left spine whose parent comes after
+    // the new one; every node skipped above it would send the descent left
+    int x = tree->root;
+    if (tree->leftmost != -1) {
+        x = tree->leftmost;
+        while (x != tree->root && !before(tree, process, tree->node[x].parent)) {
+            x = tree->node[x].parent;
+        }
+    }
+    int y = tree->nil;
+    bool leftmost = true;
+    while (x != tree->nil) {
+        y = x;
+        if (before(tree, process, x)) {
+            x = tree->node[x].left;
+        } else {
+            x = tree->node[x].right;
+            leftmost = false;
+        }
+    }
+
+    tree->node[process].parent = y;
+    if (y == tree->nil) {
+        tree->root = process;
+    } else if (before(tree, process, y)) {
+        tree->node[y].left = process;
+    } else {
+        tree->node[y].right = process;
+    }
+    tree->node[process].left = tree->nil;
+    tree->node[process].right = tree->nil;
+    tree->node[process].red = true;
+    if (leftmost) tree->leftmost = process;
+    tree->size++;
+
+    insert_fixup(tree, process);
+}
+
+void vruntime_tree_remove(VruntimeTree *tree, int process) {
+    if (!vruntime_tree_contains(tree, process)) return;
+    int z = process;
+    if (tree->leftmost == z) {
+        tree->leftmost = vruntime_tree_next(tree, z);
+    }
+
+    int y = z;
+    bool y_was_red = tree->node[y].red;
+    int x;
+    if (tree->node[z].left == tree->nil) {
+        x = tree->node[z].right;
+        transplant(tree, z, tree->node[z].right);
+    } else if (tree->node[z].right == tree->nil) {
+        x = tree->node[z].left;
+        transplant(tree, z, tree->node[z].left);
+    } else {
+        y = minimum(tree, tree->node[z].right);
+        y_was_red = tree->node[y].red;
+        x = tree->node[y].right;
+        if (tree->node[y].parent == z) {
+            tree->node[x].parent = y;
+        } else {
+            transplant(tree, y, tree->node[y].right);
+            tree->node[y].right = tree->node[z].right;
+            tree->node[tree->node[y].right].parent = y;
+        }
+        transplant(tree, z, y);
+        tree->node[y].left = tree->node[z].left;
+        tree->node[tree->node[y].left].parent = y;
+        tree->node[y].red = tree->node[z].red;
+    }
+    if (!y_was_red) {
+        remove_fixup(tree, x);
+    }
+
+    tree->node[z].queued = false;
+    tree->size--;
+}
+
+bool vruntime_tree_contains(const VruntimeTree *tree, int process) {
+    return process >= 0 && process < tree->capacity && tree->node[process].queued;
+}
+
+// Process with the lowest key (-1 if empty)
+int vruntime_tree_first(const VruntimeTree *tree) {
+    return tree->leftmost;
+}
+
+// Process right after the given one in key order (-1 if it is the last)
+int vruntime_tree_next(const VruntimeTree *tree, int process) {
+    int x = process;
+    if (tree->node[x].right != tree->nil) {
+        return minimum(tree, tree->node[x].right);
+    }
+    int y = tree->node[x].parent;
+    while (y != tree->nil && x == tree->node[y].right) {
+        x = y;
+        y = tree->node[y].parent;
+    }
+    return y == tree->nil ? -1 : y;
+}
+
+// First process with a key of at least key (-1 if none)
+int vruntime_tree_ceiling(const VruntimeTree *tree, long long key) {
+    int found = -1;
+    int x = tree->root;
+    while (x != tree->nil) {
+        if (tree->node[x].key >= key) {
+            found = x;
+            x = tree->node[x].left;
+        } else {
+            x = tree->node[x].right;
+        }
+    }
+    return found;
+}
+
+// Last process with a key of at most key (-1 if none)
+int vruntime_tree_floor(const VruntimeTree *tree, long long key) {
+    int found = -1;
+    int x = tree->root;
+    while (x != tree->nil) {
+        if (tree->node[x].key <= key) {
+            found = x;
+            x = tree->node[x].right;
+        } else {
+            x = tree->node[x].left;
+        }
+    }
+    return found;
+}
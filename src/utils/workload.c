@@ -0,0 +1,118 @@
+#include <ctype.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include "../../include/workload.h"
+#include "../../include/process_table.h"
+
+#define WORKLOAD_FIELDS 5
+
+// Parse up to max_fields integers from line, then at most one word, left in
+// word (empty if none); returns how many integers were read or -1
+static int parse_fields(const char *line, long *fields, int max_fields, char *word, size_t word_size) {
+    int count = 0;
+    const char *cursor = line;
+    word[0] = '\0';
+
+    for (;;) {
+        while (isspace((unsigned char)*cursor) || *cursor == ',') cursor++;
+        if (*cursor == '\0' || *cursor == '#') break;
+        if (isalpha((unsigned char)*cursor)) {
+            if (word[0] != '\0') return -1;
+            size_t length = 0;
+            while (isalpha((unsigned char)*cursor)) {
+                if (length + 1 == word_size) return -1;
+                word[length++] = *cursor++;
+            }
+            word[length] = '\0';
+            continue;
+        }
+        if (count == max_fields || word[0] != '\0') return -1;
+
+        char *endptr;
+        errno = 0;
+        long value = strtol(cursor, &endptr, 10);
+        if (endptr == cursor || errno == ERANGE) return -1;
+        fields[count++] = value;
+        cursor = endptr;
+    }
+    return count;
+}
+
+int parse_access_pattern(const char *name) {
+    for (int a = 0; a < NUM_ACCESS_PATTERNS; a++) {
+        if (strcasecmp(name, access_pattern_keys[a]) == 0) return a;
+    }
+    return -1;
+}
+
+int load_workload(SimContext *ctx, FILE *in, char *err, size_t err_size) {
+    char line[512];
+    int line_number = 0;
+    int loaded = 0;
+
+    process_table_clear(ctx);
+
+    while (fgets(line, sizeof(line), in) != NULL) {
+        line_number++;
+
+        long f[WORKLOAD_FIELDS];
+        char word[16];
+        int count = parse_fields(line, f, WORKLOAD_FIELDS, word, sizeof(word));
+        if (count == 0 && word[0] == '\0') continue;  // blank or comment
+
+        if (count < 4 || (word[0] != '\0' && count < WORKLOAD_FIELDS)) {
+            snprintf(err, err_size, "line %d: expected 'arrival execution deadline priority [pages [pattern]]'",
+                     line_number);
+            return -1;
+        }
+        int pattern = word[0] != '\0' ? parse_access_pattern(word) : (int)ctx->access_pattern;
+        if (pattern < 0) {
+            snprintf(err, err_size, "line %d: unknown access pattern '%s' (seq, stride, random, zipf, phases)",
+                     line_number, word);
+            return -1;
+        }
+        // Without a page count, 3 pages or the largest allowed if smaller
+        long pages = count == WORKLOAD_FIELDS ? f[4]
+                     : 3 < ctx->max_pages_per_process ? 3 : ctx->max_pages_per_process;
+        if (f[0] < 0 || f[0] > 1000000000L || f[1] < 1 || f[1] > 1000000000L ||
+            f[2] < 1 || f[2] > 1000000000L || f[3] < 1 || f[3] > 10 ||
+            pages < 1 || pages > ctx->max_pages_per_process) {
+            snprintf(err, err_size, "line %d: value out of range (arrival >= 0, execution >= 1, "
+                     "deadline >= 1, priority 1-10, pages 1-%d)", line_number, ctx->max_pages_per_process);
+            return -1;
+        }
+
+        Process *p = process_table_add(ctx);
+        p->arrival_time = (int)f[0];
+        p->execution_time = (int)f[1];
+        p->remaining_time = p->execution_time;
+        p->deadline = (int)f[2];
+        p->priority = (int)f[3];
+        p->num_pages = (int)pages;
+        p->access_pattern = (AccessPattern)pattern;
+        loaded++;
+    }
+
+    if (ferror(in)) {
+        snprintf(err, err_size, "read error: %s", strerror(errno));
+        return -1;
+    }
+    return loaded;
+}
+
+int load_workload_file(SimContext *ctx, const char *path, char *err, size_t err_size) {
+    if (strcmp(path, "-") == 0) {
+        return load_workload(ctx, stdin, err, err_size);
+    }
+
+    FILE *in = fopen(path, "r");
+    if (in == NULL) {
+        snprintf(err, err_size, "%s: %s", path, strerror(errno));
+        return -1;
+    }
+    int loaded = load_workload(ctx, in, err, err_size);
+    fclose(in);
+    return loaded;
+}